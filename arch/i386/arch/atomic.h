@@ -0,0 +1,58 @@
+/*! Atomic operations (on single processor only 'lock' prefix is not required,
+ *  but instructions must be indivisible: read-modify-write in one instruction)
+ */
+
+#pragma once
+
+#include <arch/types.h>
+
+/*!
+ * Atomically compare '*p' with 'old' and if equal set it to 'new'
+ * \param p	Address of variable
+ * \param old	Expected value
+ * \param new	New value
+ * \return Value '*p' had before operation (operation succeeded if == 'old')
+ */
+static inline int arch_atomic_cmpxchg ( volatile int *p, int old, int new )
+{
+	int prev;
+
+	asm volatile ( "lock cmpxchgl %2, %1"
+		       : "=a" (prev), "+m" (*p)
+		       : "r" (new), "0" (old)
+		       : "memory" );
+
+	return prev;
+}
+
+/*!
+ * Atomically set '*p' to 'val'
+ * \param p	Address of variable
+ * \param val	New value
+ * \return Previous value of '*p'
+ */
+static inline int arch_atomic_xchg ( volatile int *p, int val )
+{
+	asm volatile ( "xchgl %0, %1"
+		       : "+r" (val), "+m" (*p)
+		       :
+		       : "memory" );
+
+	return val;
+}
+
+/*!
+ * Atomically add 'val' to '*p'
+ * \param p	Address of variable
+ * \param val	Value to add (might be negative)
+ * \return Previous value of '*p'
+ */
+static inline int arch_atomic_add ( volatile int *p, int val )
+{
+	asm volatile ( "lock xaddl %0, %1"
+		       : "+r" (val), "+m" (*p)
+		       :
+		       : "memory" );
+
+	return val;
+}
@@ -35,6 +35,8 @@ void arch_create_thread_context ( context_t *context,
 		void (func) (void *), void *param, void (*thread_exit)(),
 		void *stack, size_t stack_size, void *proc )
 {
+	int segm;
+
 	/* thread stack */
 	context->context.esp = stack + stack_size;
 	/* put starting thread function parameter on stack */
@@ -44,12 +46,13 @@ void arch_create_thread_context ( context_t *context,
 
 	/* interrupt frame */
 	context->context.eflags = INIT_EFLAGS;
-	context->context.cs = GDT_DESCRIPTOR ( SEGM_T_CODE, GDT, PRIV_USER );
+	segm = k_process_segments ( proc );
+	context->context.cs = GDT_DESCRIPTOR ( segm, GDT, PRIV_USER );
 	context->context.eip = (uint32) func;
 
 	context->context.ss = context->context.ds = context->context.es =
-	context->context.fs = context->context.gs = context->context.ss =
-		GDT_DESCRIPTOR ( SEGM_T_DATA, GDT, PRIV_USER );
+	context->context.fs = context->context.gs =
+		GDT_DESCRIPTOR ( segm + 1, GDT, PRIV_USER );
 
 	/* rest of context is not relevant for new thread */
 #ifdef DEBUG
@@ -70,7 +73,9 @@ inline void arch_select_thread ( context_t *context )
 	arch_thr_context = (void *) &context->context;
 	arch_tss_update(((void *) &context->context) + sizeof (arch_context_t));
 
-	/* update segment descriptors */
-	arch_update_user_segments ( k_process_start_adr ( context->proc ),
-				    k_process_size ( context->proc ) );
+	/* process with own descriptors doesn't require update */
+	if ( k_process_segments ( context->proc ) == SEGM_T_CODE )
+		arch_update_user_segments ( SEGM_T_CODE,
+					    k_process_start_adr ( context->proc ),
+					    k_process_size ( context->proc ) );
 }
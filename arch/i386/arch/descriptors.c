@@ -7,7 +7,7 @@
 #include <kernel/errno.h>
 
 /*! memory for GDT - Global Descriptor Table */
-static GDT_t gdt[] =
+static GDT_t gdt[GDT_ENTRIES] =
 {
 	GDT_0,
 	GDT_K_CODE, GDT_K_DATA,
@@ -21,6 +21,13 @@ static IDT_t idt[INTERRUPTS];
 /*! memory for TSS */
 static tss_t tss;
 
+/*! process segment currently described with shared user descriptors */
+static void *user_segm_start;
+static size_t user_segm_size = 0;
+
+/*! pairs of user descriptors given to processes */
+static int user_segm_used[USER_SEGMENTS];
+
 
 /*! Set up context (normal and interrupt=kernel) */
 void arch_descriptors_init ()
@@ -36,7 +43,7 @@ static void GDT_init ()
 
 	/* initial update of segment descriptors */
 	arch_update_kernel_segments ( NULL, (size_t) 0xffffffff );
-	arch_update_user_segments ( NULL, (size_t) 0xffffffff );
+	arch_update_user_segments ( SEGM_T_CODE, NULL, (size_t) 0xffffffff );
 
 	arch_upd_segm_descr ( SEGM_TSS, &tss, sizeof(tss_t) - 1, PRIV_KERNEL );
 
@@ -107,11 +114,63 @@ void arch_update_kernel_segments ( void *kernel, size_t kernel_size )
 	arch_upd_segm_descr ( SEGM_K_DATA, kernel, kernel_size, PRIV_KERNEL );
 }
 
-/*! Update user segment descriptors in GDT */
-void arch_update_user_segments ( void *user, size_t user_size )
+/*!
+ * Get pair of user segment descriptors for process (code, data after it)
+ * - threads of process with own pair use its selectors, so switch between
+ *   processes doesn't touch GDT; when all pairs are used, process gets shared
+ *   pair (SEGM_T_CODE), which is updated on switch (see arch_select_thread)
+ * \return index of code descriptor
+ */
+int arch_user_segments_alloc ( void *user, size_t user_size )
 {
-	arch_upd_segm_descr ( SEGM_T_CODE, user, user_size, PRIV_USER );
-	arch_upd_segm_descr ( SEGM_T_DATA, user, user_size, PRIV_USER );
+	GDT_t code = GDT_T_CODE, data = GDT_T_DATA;
+	int i, id;
+
+	for ( i = 0; i < USER_SEGMENTS && user_segm_used[i]; i++ )
+		;
+	if ( i == USER_SEGMENTS )
+		return SEGM_T_CODE;
+
+	user_segm_used[i] = 1;
+	id = SEGM_TSS + 1 + 2 * i;
+	gdt[id] = code;
+	gdt[id + 1] = data;
+	arch_update_user_segments ( id, user, user_size );
+
+	return id;
+}
+
+/*! Release pair of user segment descriptors (process is removed) */
+void arch_user_segments_free ( int code_id )
+{
+	if ( code_id == SEGM_T_CODE )
+		return;
+
+	ASSERT ( code_id > SEGM_TSS && code_id < GDT_ENTRIES );
+
+	user_segm_used[ ( code_id - SEGM_TSS - 1 ) / 2 ] = 0;
+	gdt[code_id].P = gdt[code_id + 1].P = 0;
+}
+
+/*!
+ * Update pair of user segment descriptors in GDT
+ * - shared descriptors are changed only if segment is different from current
+ *   one, so switching between threads of same process (or returning to same
+ *   thread) does not touch GDT
+ */
+void arch_update_user_segments ( int code_id, void *user, size_t user_size )
+{
+	if ( code_id == SEGM_T_CODE )
+	{
+		if ( user == user_segm_start && user_size == user_segm_size )
+			return;
+
+		user_segm_start = user;
+		user_segm_size = user_size;
+	}
+
+	arch_upd_segm_descr ( code_id, user, user_size, PRIV_USER );
+	arch_upd_segm_descr ( code_id + 1, user, user_size, PRIV_USER );
 }
 
 /*! Update segment descriptor with starting address, size and privilege level */
@@ -121,7 +180,7 @@ static void arch_upd_segm_descr ( int id, void *start_addr, size_t size,
 	uint32 addr = (uint32) start_addr;
 	uint32 gsize = size;
 
-	ASSERT ( id > 0 && id <= 5 );
+	ASSERT ( id > 0 && id < GDT_ENTRIES );
 
 	gdt[id].base_addr0 =  addr & 0x0000ffff;
 	gdt[id].base_addr1 = (addr & 0x00ff0000) >> 16;
@@ -9,6 +9,11 @@
 #define SEGM_T_DATA	4
 #define SEGM_TSS	5
 
+/* processes with own pair of user descriptors (after TSS; others share
+ * SEGM_T_CODE/SEGM_T_DATA, which are updated on switch when needed) */
+#define USER_SEGMENTS	32
+#define GDT_ENTRIES	( SEGM_TSS + 1 + 2 * USER_SEGMENTS )
+
 #define PRIV_KERNEL	0
 #define PRIV_USER	3
 
@@ -25,7 +30,9 @@
 void arch_descriptors_init ();
 void arch_tss_update ( void *context );
 void arch_update_kernel_segments ( void *kernel, size_t kernel_size );
-void arch_update_user_segments ( void *user, size_t user_size );
+int arch_user_segments_alloc ( void *user, size_t user_size );
+void arch_user_segments_free ( int code_id );
+void arch_update_user_segments ( int code_id, void *user, size_t user_size );
 
 #endif
 
@@ -7,16 +7,48 @@
 #include <lib/types.h>
 #include <lib/string.h>
 
+/*
+ * Characters are written to shadow copy of screen (in RAM). Changed lines are
+ * copied to video memory (and cursor is moved) only when operation completes
+ * (vga_text_flush). Scrolling is done by moving display start address (CRTC)
+ * through whole video memory window; screen is copied to window start only
+ * when window end is reached.
+ */
+
 #define VIDEO		0x000B8000 /* video memory address */
+#define VIDEO_SIZE	0x00008000 /* video memory window size (32 KB) */
 #define COLS		80 /* number of characters in a column */
 #define ROWS		25 /* number of characters in a row */
+#define VIDEO_ROWS	( VIDEO_SIZE / ( COLS * 2 ) ) /* rows in window */
+
+#define CRTC_ADDR	0x3D4
+#define CRTC_DATA	0x3D5
+#define CRTC_START_HI	12
+#define CRTC_START_LO	13
+#define CRTC_CURSOR_HI	14
+#define CRTC_CURSOR_LO	15
 
 /*! cursor position */
 static int xpos = 0;
 static int ypos = 0;
 
 /*! starting address of video memory */
-volatile static unsigned char *video = (void *) VIDEO;
+volatile static uint16 *video = (void *) VIDEO;
+
+/*! shadow copy of screen; rows are in circular buffer, 'first' is top row */
+static uint16 shadow[ COLS * ROWS ];
+static int first = 0;
+
+/*! rows changed since last flush (bit per screen row) */
+static uint32 dirty = 0;
+#define ALL_DIRTY	( ( 1 << ROWS ) - 1 )
+
+/*! row in video memory window where screen starts */
+static int top = 0;
+
+/*! values last written to CRTC registers (-1 => unknown) */
+static int hw_start = -1;
+static int hw_cursor = -1;
 
 /*! font color */
 static int color[3] = {
@@ -25,11 +57,12 @@ static int color[3] = {
 	2  /* 'program' font - green */
 };
 
+#define SHADOW(X, Y)	shadow [ ( ( first + (Y) ) % ROWS ) * COLS + (X) ]
+
 #define PUT_CHAR(CHAR, ATTR)						\
 do {									\
-	video [ (xpos + ypos * COLS) * 2 ]	= CHAR & 0x00FF;	\
-	video [ (xpos + ypos * COLS) * 2 + 1 ]	= color[ATTR];		\
-	retval++;							\
+	SHADOW ( xpos, ypos ) = ( (CHAR) & 0x00FF ) | ( color[ATTR] << 8 );\
+	dirty |= 1 << ypos;						\
 } while (0)
 
 
@@ -37,12 +70,15 @@ static int vga_text_init ();
 static int vga_text_clear ();
 static int vga_text_gotoxy ( int x, int y );
 static int vga_text_print ( void *data );
+static void vga_text_scroll ( int attr );
+static void vga_text_flush ();
 
 /*! Init console */
 static int vga_text_init ( void *x )
 {
-	video = (unsigned char *) VIDEO;
+	video = (uint16 *) VIDEO;
 	xpos = ypos = 0;
+	hw_start = hw_cursor = -1;
 
 	return vga_text_clear ();
 }
@@ -53,10 +89,11 @@ static int vga_text_clear ()
 	int i;
 
 	for ( i = 0; i < COLS * ROWS; i++ )
-	{
-		video [2*i] = 0;
-		video [2*i+1] = color[2]; /* 'program' style */
-	}
+		shadow [i] = color[2] << 8; /* 'program' style */
+
+	first = 0;
+	top = 0;
+	dirty = ALL_DIRTY;
 
 	return vga_text_gotoxy ( 0, 0 );
 }
@@ -68,16 +105,10 @@ static int vga_text_clear ()
  */
 static int vga_text_gotoxy ( int x, int y )
 {
-	unsigned short int t;
-
 	xpos = x;
 	ypos = y;
-	t = ypos * 80 + xpos;
 
-	outb ( 0x3D4, 14 );
-	outb ( 0x3D5, t >> 8 );
-	outb ( 0x3D4, 15 );
-	outb ( 0x3D5, t & 0xFF );
+	vga_text_flush ();
 
 	return 0;
 }
@@ -85,10 +116,11 @@ static int vga_text_gotoxy ( int x, int y )
 /*!
  * Print text string on console, starting at current cursor position
  * \param data String to print
+ * \return 0 (whole string is always printed, see device_t.send)
  */
 static int vga_text_print ( void *data )
 {
-	int i, c, retval=0, j=0;
+	int c, j=0;
 	struct _param_ {
 		int attr;
 		char text[1];
@@ -125,26 +157,77 @@ static int vga_text_print ( void *data )
 		{
 			xpos = 0;
 			if ( ypos < ROWS - 1 )
-			{
 				ypos++;
-			}
-			else {
-				/*scroll one line: move bottom ROWS-1 rows up*/
-				for ( i = 0; i < COLS * 2 * (ROWS-1); i++ )
-					video [i] = video [ i + COLS * 2 ];
-
-				for ( i=COLS*2*(ROWS-1); i<COLS*2*ROWS; i+=2)
-				{
-					video [i] = ' ';
-					video [i+1] = color [param->attr];
-				}
-			}
+			else
+				vga_text_scroll ( param->attr );
 		}
 	}
 
-	retval += vga_text_gotoxy ( xpos, ypos );
+	vga_text_flush ();
 
-	return retval;
+	return 0;
+}
+
+/*! Scroll one line: in shadow only move 'first', on screen move 'top' */
+static void vga_text_scroll ( int attr )
+{
+	int x;
+
+	first = ( first + 1 ) % ROWS;
+
+	for ( x = 0; x < COLS; x++ )
+		SHADOW ( x, ROWS - 1 ) = ' ' | ( color[attr] << 8 );
+
+	/* rows moved up by one; new bottom row must be written */
+	dirty = ( dirty >> 1 ) | ( 1 << ( ROWS - 1 ) );
+
+	if ( ++top > VIDEO_ROWS - ROWS )
+	{
+		/* end of window reached: continue from its start */
+		top = 0;
+		dirty = ALL_DIRTY;
+	}
+}
+
+/*! Copy changed rows to video memory, update display start and cursor */
+static void vga_text_flush ()
+{
+	int x, y, t;
+	uint16 *src;
+	volatile uint16 *dst;
+
+	for ( y = 0; dirty && y < ROWS; y++ )
+	{
+		if ( !( dirty & ( 1 << y ) ) )
+			continue;
+
+		src = &SHADOW ( 0, y );
+		dst = &video [ ( top + y ) * COLS ];
+		for ( x = 0; x < COLS; x++ )
+			dst[x] = src[x];
+
+		dirty &= ~( 1 << y );
+	}
+
+	t = top * COLS;
+	if ( t != hw_start )
+	{
+		outb ( CRTC_ADDR, CRTC_START_HI );
+		outb ( CRTC_DATA, t >> 8 );
+		outb ( CRTC_ADDR, CRTC_START_LO );
+		outb ( CRTC_DATA, t & 0xFF );
+		hw_start = t;
+	}
+
+	t = ( top + ypos ) * COLS + xpos;
+	if ( t != hw_cursor )
+	{
+		outb ( CRTC_ADDR, CRTC_CURSOR_HI );
+		outb ( CRTC_DATA, t >> 8 );
+		outb ( CRTC_ADDR, CRTC_CURSOR_LO );
+		outb ( CRTC_DATA, t & 0xFF );
+		hw_cursor = t;
+	}
 }
 
 /*! Device wrapper for console */
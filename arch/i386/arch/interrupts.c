@@ -8,6 +8,7 @@
 #include <kernel/errno.h>
 #include <lib/list.h>
 #include <kernel/memory.h>
+#include <kernel/trace.h>
 
 /*! Interrupt controller device */
 extern arch_ic_t IC_DEV;
@@ -66,7 +67,7 @@ void arch_register_interrupt_handler ( unsigned int inum, void *handler,
 	}
 	else {
 		LOG ( ERROR, "Interrupt %d can't be used!\n", inum );
-		halt ();
+		PANIC_HALT ();
 	}
 }
 
@@ -102,6 +103,9 @@ void arch_interrupt_handler ( int irq_num )
 	prev_mode = new_mode;
 	new_mode = KERNEL_MODE;
 
+	if ( irq_num != SOFTWARE_INTERRUPT ) /* syscalls are traced in kernel */
+		TRACE_EVENT ( TRACE_IRQ, irq_num );
+
 	if ( irq_num < INTERRUPTS && (ih = list_get (&ihandlers[irq_num], FIRST)) )
 	{
 		/* Call registered handlers */
@@ -120,17 +124,59 @@ void arch_interrupt_handler ( int irq_num )
 	{
 		LOG ( ERROR, "Unregistered interrupt: %d - %s!\n",
 		      irq_num, icdev->int_descr ( irq_num ) );
-		halt ();
+		PANIC_HALT ();
 	}
 	else {
 		LOG ( ERROR, "Unregistered interrupt: %d !\n", irq_num );
-		halt ();
+		PANIC_HALT ();
 	}
 
 	prev_mode = new_mode;
 	new_mode = USER_MODE;
 }
 
+#ifdef PAGING
+/*!
+ * Page fault while in kernel (first access to process page through address
+ * from k_u2k_adr); handled on current stack, returns to interrupted kernel
+ * code (called from interrupts.S)
+ */
+void arch_kernel_page_fault ( int irq_num )
+{
+	struct ihndlr *ih;
+	int mode = prev_mode;
+
+	prev_mode = KERNEL_MODE;
+
+	ih = list_get ( &ihandlers[irq_num], FIRST );
+	if ( !ih )
+	{
+		LOG ( ERROR, "Page fault in kernel!\n" );
+		PANIC_HALT ();
+	}
+
+	while ( ih )
+	{
+		ih->ihandler ( irq_num, ih->device );
+		ih = list_get_next ( &ih->list );
+	}
+
+	prev_mode = mode;
+}
+
+/*!
+ * Page fault in kernel couldn't be resolved (kernel already changed active
+ * thread): abandon interrupted kernel code and its stack, return to thread
+ */
+void arch_kernel_fault_abort ()
+{
+	prev_mode = KERNEL_MODE;
+	new_mode = USER_MODE;
+
+	arch_return_to_thread ();
+}
+#endif
+
 int arch_new_mode ()
 {
 	return new_mode;
@@ -30,6 +30,11 @@ extern void (*arch_irq_disable) ( unsigned int irq );
 int arch_new_mode ();
 int arch_prev_mode ();
 
+#ifdef PAGING
+void arch_kernel_page_fault ( int irq_num );
+void arch_kernel_fault_abort ();
+#endif
+
 #endif /* ASM_FILE */
 
 /* Programmable Interrupt controllers (currently implemented only one, i8259) */
@@ -41,6 +46,7 @@ int arch_prev_mode ();
 
 #define INT_STF			12	/* Stack Fault */
 #define INT_GPF			13	/* General Protection Fault */
+#define INT_PF			14	/* Page Fault */
 
 #define SOFTWARE_INTERRUPT	SOFT_IRQ
 #define INTERRUPTS		NUM_IRQS
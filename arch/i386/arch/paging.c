@@ -0,0 +1,137 @@
+/*! Paging - single page directory for whole system */
+
+#ifdef PAGING
+
+#define _ARCH_PAGING_C_
+#include "paging.h"
+
+#include <kernel/memory.h>
+#include <kernel/errno.h>
+#include <lib/string.h>
+
+/* page directory and page table entries */
+#define PG_PRESENT	( 1 << 0 )
+#define PG_WRITE	( 1 << 1 )
+#define PG_USER		( 1 << 2 ) /* protection is still with segmentation */
+#define PG_FLAGS	( PG_PRESENT | PG_WRITE | PG_USER )
+#define PG_ADDR_MASK	0xfffff000
+
+#define PDE_INDEX(ADR)	( ( (uint32) (ADR) ) >> 22 )
+#define PTE_INDEX(ADR)	( ( ( (uint32) (ADR) ) >> 12 ) & 0x3ff )
+
+#define CR0_PG		0x80000000
+
+/*! page directory (for whole system) */
+static uint32 page_dir[PAGE_TABLES] __attribute__ (( aligned ( PAGE_SIZE ) ));
+
+/*! Identity map first 'identity_size' bytes and enable paging */
+void arch_paging_init ( size_t identity_size )
+{
+	uint32 adr, *table = NULL;
+
+	memset ( page_dir, 0, sizeof (page_dir) );
+
+	for ( adr = 0; adr < identity_size; adr += PAGE_SIZE )
+	{
+		if ( !( adr % PAGE_TABLE_SPAN ) )
+		{
+			table = k_frame_alloc ();
+			ASSERT ( table );
+			memset ( table, 0, PAGE_SIZE );
+			page_dir[ PDE_INDEX ( adr ) ] = (uint32) table | PG_FLAGS;
+		}
+
+		table[ PTE_INDEX ( adr ) ] = adr | PG_FLAGS;
+	}
+
+	asm volatile (	"movl	%0, %%cr3	\n\t"
+			"movl	%%cr0, %%eax	\n\t"
+			"orl	%1, %%eax	\n\t"
+			"movl	%%eax, %%cr0	\n\t"
+			"jmp	1f		\n"
+		"1:				\n\t"
+			:: "r" (page_dir), "i" (CR0_PG) : "eax", "memory" );
+}
+
+/*! Set page table for address range (of PAGE_TABLE_SPAN) containing 'adr' */
+void arch_page_table_set ( void *adr, void *table )
+{
+	if ( table )
+		page_dir[ PDE_INDEX ( adr ) ] = (uint32) table | PG_FLAGS;
+	else
+		page_dir[ PDE_INDEX ( adr ) ] = 0;
+}
+
+/*! Get page table for address range containing 'adr' (NULL if not set) */
+void *arch_page_table_get ( void *adr )
+{
+	uint32 pde = page_dir[ PDE_INDEX ( adr ) ];
+
+	if ( !( pde & PG_PRESENT ) )
+		return NULL;
+
+	return (void *) ( pde & PG_ADDR_MASK );
+}
+
+/*! Map page containing 'adr' to 'frame' (page table must be set) */
+void arch_page_map ( void *adr, void *frame )
+{
+	uint32 *table = arch_page_table_get ( adr );
+
+	ASSERT ( table );
+
+	table[ PTE_INDEX ( adr ) ] = (uint32) frame | PG_FLAGS;
+
+	asm volatile ( "invlpg (%0)\n\t" :: "r" (adr) : "memory" );
+}
+
+/*! Remove mapping for page containing 'adr'; return its frame (or NULL) */
+void *arch_page_unmap ( void *adr )
+{
+	uint32 *table = arch_page_table_get ( adr );
+	void *frame = arch_page_get ( adr );
+
+	if ( frame )
+	{
+		table[ PTE_INDEX ( adr ) ] = 0;
+		asm volatile ( "invlpg (%0)\n\t" :: "r" (adr) : "memory" );
+	}
+
+	return frame;
+}
+
+/*! Get frame where page containing 'adr' is mapped (NULL if not mapped) */
+void *arch_page_get ( void *adr )
+{
+	uint32 *table = arch_page_table_get ( adr );
+	uint32 pte;
+
+	if ( !table )
+		return NULL;
+
+	pte = table[ PTE_INDEX ( adr ) ];
+	if ( !( pte & PG_PRESENT ) )
+		return NULL;
+
+	return (void *) ( pte & PG_ADDR_MASK );
+}
+
+/*! Address that caused last page fault */
+void *arch_page_fault_address ()
+{
+	void *adr;
+
+	asm volatile ( "movl %%cr2, %0\n\t" : "=r" (adr) );
+
+	return adr;
+}
+
+/*! Invalidate all TLB entries */
+void arch_tlb_flush ()
+{
+	asm volatile (	"movl	%%cr3, %%eax	\n\t"
+			"movl	%%eax, %%cr3	\n\t"
+			::: "eax", "memory" );
+}
+
+#endif /* PAGING */
@@ -0,0 +1,26 @@
+/*! Paging - single page directory for whole system
+ *
+ * Enabled with PAGING in OPTIONALS (Makefile). Physical memory is identity
+ * mapped (kernel works as without paging); processes get their own page
+ * tables mapped above physical memory, and their pages are added on demand.
+ */
+
+#pragma once
+
+#include <lib/types.h>
+
+#define PAGE_SIZE		4096
+#define PAGE_TABLE_SPAN		( PAGE_SIZE * 1024 ) /* covered by one table */
+#define PAGE_TABLES		1024 /* in page directory */
+
+void arch_paging_init ( size_t identity_size );
+
+void arch_page_table_set ( void *adr, void *table );
+void *arch_page_table_get ( void *adr );
+
+void arch_page_map ( void *adr, void *frame );
+void *arch_page_unmap ( void *adr );
+void *arch_page_get ( void *adr );
+
+void *arch_page_fault_address ();
+void arch_tlb_flush ();
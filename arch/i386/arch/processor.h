@@ -9,6 +9,15 @@
 
 #define suspend()		asm volatile ( "hlt \n\t" );
 
+/* QEMU's "isa-debug-exit" device (-device isa-debug-exit,iobase=0xf4):
+   emulator exits with status (S << 1) | 1; without the device nothing happens */
+#define QEMU_EXIT_PORT		0xf4
+#define qemu_exit(S)	\
+	asm volatile ( "outb %b0, %w1" : : "a" (S), "d" (QEMU_EXIT_PORT) )
+
 #define raise_interrupt(p)	asm volatile ("int %0\n\t" :: "i" (p):"memory")
 
 #define memory_barrier()	asm ("" : : : "memory")
+
+/* read time stamp counter into 64-bit variable 'T' */
+#define read_tsc(T)		asm volatile ( "rdtsc\n\t" : "=A" (T) )
@@ -3,6 +3,7 @@
 #include "time.h"
 
 #include <lib/types.h>
+#include <lib/bits.h>
 
 extern arch_timer_t TIMER;
 static arch_timer_t *timer = &TIMER;
@@ -18,6 +19,12 @@ static void (*alarm_handler) (); /* kernel function - call when alarm given by
 
 static void arch_timer_handler (); /* whenever timer expires call this */
 
+static uint32 cycles_khz; /* time stamp counter frequency [kHz] */
+
+#define CALIBRATION_NS	10000000 /* measure cycles in 10 ms */
+
+static void arch_cycles_calibrate ();
+
 void arch_enable_timer_interrupt ()	{ timer->enable_interrupt ();	}
 void arch_disable_timer_interrupt ()	{ timer->disable_interrupt ();	}
 
@@ -41,9 +48,61 @@ void arch_timer_init ()
 	if ( timer->min_interval.sec % 2 )
 		threshold.nsec += 1000000000L / 2; /* + half second */
 
+	arch_cycles_calibrate ();
+
 	return;
 }
 
+/*!
+ * Count processor cycles in short interval measured with timer (timer was
+ * just loaded with max_interval, which must be longer than that interval)
+ */
+static void arch_cycles_calibrate ()
+{
+	time_t start, now;
+	uint64 c0, c1;
+	uint32 elapsed;
+
+	arch_get_time ( &start );
+	read_tsc ( c0 );
+	do {
+		arch_get_time ( &now );
+		time_sub ( &now, &start );
+		elapsed = now.sec * 1000000000 + now.nsec;
+	}
+	while ( !now.sec && elapsed < CALIBRATION_NS );
+	read_tsc ( c1 );
+
+	cycles_khz = mul_div_32 ( (uint32) ( c1 - c0 ), 1000000, elapsed );
+}
+
+/*!
+ * Convert processor cycles (interval measured with 'arch_get_cycles') to time
+ * (intervals up to about 49 days)
+ */
+void arch_cycles_to_time ( uint64 cycles, time_t *time )
+{
+	uint32 hi, lo, ms, rem;
+
+	if ( !cycles_khz )
+	{
+		time->sec = time->nsec = 0;
+		return;
+	}
+
+	/* ms = cycles / cycles_khz (64/32 division, in two steps) */
+	hi = cycles >> 32;
+	lo = cycles & 0xffffffff;
+	if ( hi >= cycles_khz )
+		hi %= cycles_khz; /* overflow: result is modulo 2^32 ms */
+	asm ("divl %2":"=a" (ms), "=d" (rem):"rm" (cycles_khz), "0" (lo),
+	     "1" (hi) );
+
+	time->sec = ms / 1000;
+	time->nsec = ( ms % 1000 ) * 1000000 +
+		     mul_div_32 ( rem, 1000000, cycles_khz );
+}
+
 /*!
  * Set next timer activation
  * \param time Time of next activation
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <lib/types.h>
+#include <arch/processor.h>
 
 /*! (arch) timer interface */
 typedef struct _arch_timer_t_
@@ -27,3 +28,15 @@ void arch_get_min_interval ( time_t *time );
 
 void arch_enable_timer_interrupt ();
 void arch_disable_timer_interrupt ();
+
+/*! Fast clock for measuring intervals (processor cycles, time stamp counter) */
+static inline uint64 arch_get_cycles ()
+{
+	uint64 cycles;
+
+	read_tsc ( cycles );
+
+	return cycles;
+}
+
+void arch_cycles_to_time ( uint64 cycles, time_t *time );
@@ -0,0 +1,188 @@
+#!/bin/sh
+# Benchmark runner: for each scenario build system with benchmark program as
+# initial program, run it in QEMU without display, collect results from COM1
+# output and compare them with stored baselines (bench/baseline/<scenario>)
+#
+# Usage: bench/run.sh [-u] [-t threshold] [scenario ...] [-- make_args]
+#	-u		save results as new baselines (no comparison)
+#	-t threshold	allowed regression in percent (default 10)
+#	scenario	names from bench/scenarios (all if none given)
+#	make_args	passed to make (e.g. CFLAGS_K="..." CFLAGS_U="...")
+#
+# Environment: QEMU (qemu-system-i386), QEMU_FLAGS (-m 32), MKISOFS (mkisofs)
+#
+# Exit status is 0 only if all scenarios finished, have baseline and no result
+# is worse than its baseline by more than threshold (or missing).
+#
+# Baselines are recorded once on reference machine (with QEMU and MKISOFS):
+#	bench/run.sh -u
+# and committed (bench/baseline/*); without them every scenario fails.
+
+QEMU=${QEMU:-qemu-system-i386}
+QEMU_FLAGS=${QEMU_FLAGS:--m 32}
+MKISOFS=${MKISOFS:-mkisofs}
+
+THRESHOLD=10
+UPDATE=0
+
+usage ()
+{
+	sed -n '6,10p' "$0" | sed 's/^# \{0,1\}//'
+	exit 2
+}
+
+while getopts "ut:" opt; do
+	case $opt in
+	u) UPDATE=1 ;;
+	t) THRESHOLD=$OPTARG ;;
+	*) usage ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+# scenario names (without spaces); rest of arguments are for make
+SCENARIOS=
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+	SCENARIOS="$SCENARIOS $1"
+	shift
+done
+[ $# -gt 0 ] && shift
+
+cd "$(dirname "$0")/.." || exit 2
+
+BENCH=bench
+failed=0
+
+# print results from COM1 log as lines "name value better"
+parse ()
+{
+	tr -d '\r' < "$1" | awk -v nf="$2" -v keys="$3" -v val="$4" \
+				-v better="$5" '
+	BEGIN { nk = split ( keys, k, "," ) }
+	/^#/ { next }
+	NF == nf && $val ~ /^[0-9]+(\.[0-9]+)?$/ {
+		key = $(k[1])
+		for ( i = 2; i <= nk; i++ )
+			key = key "_" $(k[i])
+		b = better
+		if ( better ~ /^[0-9]+$/ )
+			b = $(better) ~ /\// ? "higher" : "lower"
+		print key, $val, b
+	}'
+}
+
+# compare results with baseline; return 1 on regression or missing result
+compare ()
+{
+	awk -v threshold="$THRESHOLD" '
+	NR == FNR {
+		if ( $0 !~ /^#/ ) { base[$1] = $2; dir[$1] = $3 }
+		next
+	}
+	{
+		seen[$1] = 1
+		if ( !( $1 in base ) ) {
+			printf ( "  %-32s %10s %10s  new\n", $1, "-", $2 )
+			next
+		}
+		diff = base[$1] ? ( $2 - base[$1] ) * 100 / base[$1] : 0
+		worse = dir[$1] == "higher" ? -diff : diff
+		state = worse > threshold ? "REGRESSION" : \
+			( worse < -threshold ? "improved" : "ok" )
+		if ( state == "REGRESSION" )
+			bad = 1
+		printf ( "  %-32s %10s %10s %+7.1f%%  %s\n", $1, base[$1], $2,
+			 diff, state )
+	}
+	END {
+		for ( key in base )
+			if ( !( key in seen ) ) {
+				printf ( "  %-32s %10s %10s  MISSING\n", key,
+					 base[key], "-" )
+				bad = 1
+			}
+		exit bad
+	}' "$1" "$2"
+}
+
+run_scenario ()
+{
+	name=$1 prog=$2 fields=$3 key=$4 value=$5 better=$6 timeout=$7
+	shift 7
+	dir=$BENCH/build/$name
+	log=$dir/com1.log
+	result=$dir/result
+	baseline=$BENCH/baseline/$name
+
+	echo "== $name ($prog)"
+
+	# always clean build (make does not track changed flags or options)
+	rm -rf "$dir"
+	mkdir -p "$dir"
+	if ! make BUILDDIR="$dir" PROGRAMS="$prog" K_INIT_PROG="$prog" \
+		  OPTIONALS="MESSAGES QEMU_EXIT" MKISOFS="$MKISOFS" "$@" \
+		  < /dev/null > "$dir/build.log" 2>&1; then
+		echo "  build failed (see $dir/build.log)"
+		return 1
+	fi
+
+	# kernel exits emulator through isa-debug-exit (status (0 << 1) | 1)
+	# $QEMU_FLAGS is intentionally unquoted (list of arguments)
+	timeout "$timeout" "$QEMU" $QEMU_FLAGS -cdrom "$dir"/*.iso \
+		-display none -serial file:"$log" -no-reboot \
+		-device isa-debug-exit,iobase=0xf4 < /dev/null > "$dir/qemu.log" 2>&1
+	status=$?
+	if [ $status -ne 1 ]; then
+		[ $status -eq 124 ] && echo "  timeout after $timeout s" ||
+			echo "  emulator failed (status $status)"
+		return 1
+	fi
+
+	if grep -q "ERROR\|BUG\|PANIC" "$log"; then
+		grep "ERROR\|BUG\|PANIC" "$log" | sed 's/^/  /'
+		return 1
+	fi
+
+	parse "$log" "$fields" "$key" "$value" "$better" > "$result"
+	if [ ! -s "$result" ]; then
+		echo "  no results in $log"
+		return 1
+	fi
+
+	if [ $UPDATE -eq 1 ]; then
+		mkdir -p "$BENCH/baseline"
+		{
+			echo "# $name: result value better ($QEMU $QEMU_FLAGS)"
+			cat "$result"
+		} > "$baseline"
+		sed 's/^/  /' "$result"
+		echo "  saved as baseline"
+		return 0
+	fi
+
+	if [ ! -f "$baseline" ]; then
+		sed 's/^/  /' "$result"
+		echo "  no baseline (record it with -u on reference machine)"
+		return 1
+	fi
+
+	printf "  %-32s %10s %10s\n" result baseline current
+	compare "$baseline" "$result"
+}
+
+while read -r name prog fields key value better timeout; do
+	case $name in
+	""|\#*) continue ;;
+	esac
+
+	case " $SCENARIOS " in
+	"  "|*" $name "*) ;;
+	*) continue ;;
+	esac
+
+	run_scenario "$name" "$prog" "$fields" "$key" "$value" "$better" \
+		     "$timeout" "$@" || failed=1
+done < "$BENCH/scenarios"
+
+[ $failed -eq 0 ] && echo "PASSED" || echo "FAILED"
+exit $failed
@@ -30,6 +30,8 @@ struct _device_t_
 	/* device interface */
 	int (*init) ( uint flags, void *params, device_t *dev );
 	int (*destroy) ( uint flags, void *params, device_t *dev );
+	/* send returns number of bytes not accepted (0 when all are accepted;
+	   for PRINTSTRING 'size' includes string terminator), -1 on error */
 	int (*send) ( void *data, size_t size, uint flags, device_t *dev );
 	int (*recv) ( void *data, size_t size, uint flags, device_t *dev );
 
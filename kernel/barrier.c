@@ -0,0 +1,107 @@
+/*! Barrier (thread synchronization point) */
+#define _KERNEL_
+
+#define _BARRIER_C_
+#include "barrier.h"
+
+#include <kernel/thread.h>
+#include <kernel/memory.h>
+#include <kernel/kprint.h>
+#include <kernel/errno.h>
+#include <lib/types.h>
+
+/*!
+ * Initialize new barrier
+ * \param barrier Barrier descriptor (user level descriptor)
+ * \param count Number of threads that must call barrier_wait to pass barrier
+ */
+int sys__barrier_init ( void *p )
+{
+	/* parameters on thread stack */
+	barrier_t *barrier;
+	uint count;
+	/* local variables */
+	kbarrier_t *kbarrier;
+
+	barrier = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
+	ASSERT_ERRNO_AND_EXIT ( barrier, E_INVALID_HANDLE );
+	p += sizeof (void *);
+	count = *( (uint *) p );
+	ASSERT_ERRNO_AND_EXIT ( count > 0, E_INVALID_ARGUMENT );
+
+	kbarrier = kmalloc ( sizeof (kbarrier_t) );
+	ASSERT_ERRNO_AND_EXIT ( kbarrier, E_NO_MEMORY );
+
+	kbarrier->count = count;
+	kbarrier->waiting = 0;
+	kthreadq_init ( &kbarrier->queue );
+
+	barrier->id = k_handle_new ( kbarrier, HANDLE_BARRIER );
+	if ( !barrier->id )
+	{
+		kfree ( kbarrier );
+		EXIT ( E_NO_MEMORY );
+	}
+
+	EXIT ( SUCCESS );
+}
+
+/*! Destroy barrier (and unblock all threads blocked on it) */
+int sys__barrier_destroy ( void *p )
+{
+	/* parameters on thread stack */
+	barrier_t *barrier;
+	/* local variables */
+	kbarrier_t *kbarrier;
+
+	barrier = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
+	ASSERT_ERRNO_AND_EXIT ( barrier, E_INVALID_HANDLE );
+
+	kbarrier = k_handle_get ( barrier->id, HANDLE_BARRIER );
+	ASSERT_ERRNO_AND_EXIT ( kbarrier, E_INVALID_HANDLE );
+
+	if ( kthreadq_release_all ( &kbarrier->queue ) )
+		kthreads_schedule ();
+
+	k_handle_free ( barrier->id );
+	kfree ( kbarrier );
+	barrier->id = 0;
+
+	EXIT ( SUCCESS );
+}
+
+/*!
+ * Block on barrier until 'count' threads arrive
+ * \return BARRIER_SERIAL_THREAD for last arrived thread, 0 for others
+ */
+int sys__barrier_wait ( void *p )
+{
+	/* parameters on thread stack */
+	barrier_t *barrier;
+	/* local variables */
+	kbarrier_t *kbarrier;
+
+	barrier = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
+	ASSERT_ERRNO_AND_EXIT ( barrier, E_INVALID_HANDLE );
+
+	kbarrier = k_handle_get ( barrier->id, HANDLE_BARRIER );
+	ASSERT_ERRNO_AND_EXIT ( kbarrier, E_INVALID_HANDLE );
+
+	SET_ERRNO ( SUCCESS );
+
+	if ( kbarrier->waiting + 1 < kbarrier->count )
+	{
+		kbarrier->waiting++;
+		kthread_enqueue ( NULL, &kbarrier->queue );
+		kthreads_schedule ();
+
+		RETURN ( SUCCESS );
+	}
+
+	/* last thread arrived - release all (barrier is then reused) */
+	kbarrier->waiting = 0;
+	if ( kthreadq_release_all ( &kbarrier->queue ) )
+		kthreads_schedule ();
+
+	return BARRIER_SERIAL_THREAD;
+}
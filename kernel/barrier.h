@@ -0,0 +1,20 @@
+/*! Barrier (thread synchronization point) */
+
+#pragma once
+
+#include <lib/types.h>
+#include <kernel/thread.h>
+
+/*! barrier descriptor */
+typedef struct _kbarrier_t_
+{
+	uint count;		/* number of threads barrier waits for */
+	uint waiting;		/* number of threads currently blocked */
+
+	kthread_q queue;	/* queue for blocked threads */
+}
+kbarrier_t;
+
+int sys__barrier_init ( void *p );
+int sys__barrier_destroy ( void *p );
+int sys__barrier_wait ( void *p );
@@ -25,13 +25,19 @@ int k_devices_init ()
 	for ( iter = 0; dev[iter] != NULL; iter++ )
 	{
 		kdev = k_device_add ( dev[iter] );
-		k_device_init ( kdev, 0, NULL, NULL );
+		if ( kdev )
+			k_device_init ( kdev, 0, NULL, NULL );
+		else
+			kprint ( "Device %s not added!\n", dev[iter]->dev_name );
 	}
 
 	return 0;
 }
 
-/*! Add new device to system */
+/*!
+ * Add new device to system
+ * \return Device descriptor, NULL if there is no free handle for it
+ */
 kdevice_t *k_device_add ( device_t *dev )
 {
 	kdevice_t *kdev;
@@ -43,6 +49,12 @@ kdevice_t *k_device_add ( device_t *dev )
 
 	kdev->dev = *dev;
 	kdev->open = 0;
+	kdev->handle = k_handle_new ( kdev, HANDLE_DEVICE );
+	if ( !kdev->handle )
+	{
+		kfree ( kdev );
+		return NULL;
+	}
 
 	list_append ( &devices, kdev, &kdev->list );
 
@@ -63,7 +75,7 @@ int k_device_init ( kdevice_t *kdev, int flags, void *params, void *callback )
 		kdev->dev.params = params;
 
 	kdev->locked = FALSE;
-	kthreadq_init ( &kdev->thrq );
+	kthreadq_init_ordered ( &kdev->thrq, THRQ_PRIO );
 
 	if ( kdev->dev.init )
 		retval = kdev->dev.init ( flags, params, &kdev->dev );
@@ -106,6 +118,8 @@ int k_device_remove ( kdevice_t *kdev )
 	(void) list_remove ( &devices, 0, &kdev->list );
 #endif
 
+	k_handle_free ( kdev->handle );
+	kthreadq_destroy ( &kdev->thrq );
 	kfree ( kdev );
 
 	return 0;
@@ -222,7 +236,8 @@ int sys__device_send ( void *p )
 	flags = *( (int *) p );
 	p += sizeof (int);
 
-	dev = *( (void **) p );
+	dev = k_handle_get ( PTR2HANDLE ( *( (void **) p ) ), HANDLE_DEVICE );
+	ASSERT_ERRNO_AND_EXIT ( dev, E_INVALID_HANDLE );
 
 	return k_device_send ( data, size, flags, dev );
 }
@@ -243,7 +258,8 @@ int sys__device_recv ( void *p )
 	flags = *( (int *) p );
 	p += sizeof (int);
 
-	dev = *( (void **) p );
+	dev = k_handle_get ( PTR2HANDLE ( *( (void **) p ) ), HANDLE_DEVICE );
+	ASSERT_ERRNO_AND_EXIT ( dev, E_INVALID_HANDLE );
 
 	return k_device_recv ( data, size, flags, dev );
 }
@@ -252,22 +268,25 @@ int sys__device_open ( void *p )
 {
 	char *dev_name;
 	void **dev;
+	kdevice_t *kdev;
 
 	dev_name = U2K_GET_ADR ( *( (char **) p ), kthread_get_process (NULL) );
 	p += sizeof (char *);
 
 	dev = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
 
-	*dev = k_device_open ( dev_name );
+	kdev = k_device_open ( dev_name );
+	*dev = kdev ? HANDLE2PTR ( kdev->handle ) : NULL;
 
-	return *dev == NULL;
+	return kdev == NULL;
 }
 
 int sys__device_close ( void *p )
 {
 	kdevice_t *kdev;
 
-	kdev = *( (void **) p );
+	kdev = k_handle_get ( PTR2HANDLE ( *( (void **) p ) ), HANDLE_DEVICE );
+	ASSERT_ERRNO_AND_EXIT ( kdev, E_INVALID_HANDLE );
 
 	k_device_close ( kdev );
 
@@ -279,9 +298,12 @@ int sys__device_lock ( void *p )
 	kdevice_t *dev;
 	int wait;
 
-	dev = *( (void **) p ); p += sizeof (void *);
+	dev = k_handle_get ( PTR2HANDLE ( *( (void **) p ) ), HANDLE_DEVICE );
+	p += sizeof (void *);
 	wait = *( (int *) p );
 
+	ASSERT_ERRNO_AND_EXIT ( dev, E_INVALID_HANDLE );
+
 	return k_device_lock ( dev, wait );
 }
 
@@ -289,7 +311,8 @@ int sys__device_unlock ( void *p )
 {
 	kdevice_t *dev;
 
-	dev = *( (void **) p );
+	dev = k_handle_get ( PTR2HANDLE ( *( (void **) p ) ), HANDLE_DEVICE );
+	ASSERT_ERRNO_AND_EXIT ( dev, E_INVALID_HANDLE );
 
 	return k_device_unlock ( dev );
 }
@@ -298,34 +321,38 @@ int sys__set_default_stdin ( void *p )
 {
 	char *dev_name;
 	void **dev;
+	kdevice_t *kdev;
 
 	dev_name = U2K_GET_ADR ( *( (char **) p ), kthread_get_process (NULL) );
 	p += sizeof (char *);
 
 	dev = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
 
-	*dev = k_device_open ( dev_name );
+	kdev = k_device_open ( dev_name );
+	*dev = kdev ? HANDLE2PTR ( kdev->handle ) : NULL;
 
-	if ( *dev )
-		u_stdin = *dev;
+	if ( kdev )
+		u_stdin = kdev;
 
-	return *dev == NULL;
+	return kdev == NULL;
 }
 
 int sys__set_default_stdout ( void *p )
 {
 	char *dev_name;
 	void **dev;
+	kdevice_t *kdev;
 
 	dev_name = U2K_GET_ADR ( *( (char **) p ), kthread_get_process (NULL) );
 	p += sizeof (char *);
 
 	dev = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
 
-	*dev = k_device_open ( dev_name );
+	kdev = k_device_open ( dev_name );
+	*dev = kdev ? HANDLE2PTR ( kdev->handle ) : NULL;
 
-	if ( *dev )
-		u_stdout = *dev;
+	if ( kdev )
+		u_stdout = kdev;
 
-	return *dev == NULL;
+	return kdev == NULL;
 }
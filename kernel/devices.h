@@ -14,6 +14,8 @@ typedef struct _kdevice_t_
 
 	int open;
 
+	uint handle; /* given to threads in place of pointer */
+
 	/* locking device */
 	int locked; /* is locked */
 	kthread_q thrq; /* locked threads wait in queue */
@@ -23,15 +23,18 @@
 #ifdef DEBUG
 
 /*! Debugging outputs (includes files and line numbers!) */
-#define LOG(LEVEL, format, ...)	\
-kprint ( "[" #LEVEL ":%s:%d]" format "\n", __FILE__, __LINE__, ##__VA_ARGS__)
+#define LOG(LEVEL, format, ...)						\
+do if ( KLOG_##LEVEL <= k_log_level )					\
+	kprint ( "[" #LEVEL ":%s:%d]" format "\n", __FILE__, __LINE__,	\
+		 ##__VA_ARGS__ );					\
+while (0)
 
 /*! Critical error - print it and stop */
 #define ASSERT(expr)						\
 do if ( !( expr ) )						\
 {								\
 	kprint ( "[BUG:%s:%d]\n", __FILE__, __LINE__);		\
-	halt();							\
+	PANIC_HALT ();						\
 } while(0)
 
 /* assert and return (inter kernel calls) */
@@ -0,0 +1,110 @@
+/*! Futex - wait queues identified by (process) memory address
+ *
+ * Synchronization is performed in user space with atomic operations; kernel is
+ * called only when thread must be blocked or blocked thread released.
+ * Address given from thread is relative to process start, so it is translated
+ * to kernel address which is then unique for all processes.
+ */
+#define _KERNEL_
+
+#define _FUTEX_C_
+#include "futex.h"
+
+#include <kernel/thread.h>
+#include <kernel/memory.h>
+#include <kernel/kprint.h>
+#include <kernel/errno.h>
+#include <lib/types.h>
+
+static kthread_q futex_q[FUTEX_QUEUES];
+
+#define FUTEX_HASH(ADDR)	( ( ( (aint) (ADDR) ) >> 2 ) % FUTEX_QUEUES )
+
+/*! Initialize futex queues */
+void k_futex_init ()
+{
+	int i;
+
+	for ( i = 0; i < FUTEX_QUEUES; i++ )
+		kthreadq_init_ordered ( &futex_q[i], THRQ_PRIO );
+}
+
+/*!
+ * Block calling thread on address 'addr' if it still holds value 'val'
+ * \param addr Address (user) of synchronization variable
+ * \param val Expected value (when thread decided to block)
+ * \return 0 when released by 'futex_wake', -E_RETRY if value was changed
+ */
+int sys__futex_wait ( void *p )
+{
+	/* parameters on thread stack */
+	int *addr;
+	int val;
+
+	addr = *( (void **) p );	p += sizeof (void *);
+	val = *( (int *) p );
+
+	ASSERT_ERRNO_AND_EXIT ( addr, E_INVALID_HANDLE );
+
+	addr = U2K_GET_ADR ( addr, kthread_get_process (NULL) );
+
+	/* value changed before entering kernel - do not block */
+	if ( *addr != val )
+		EXIT ( E_RETRY );
+
+	SET_ERRNO ( SUCCESS );
+
+	kthread_set_qdata ( NULL, addr );
+	kthread_enqueue ( NULL, &futex_q[ FUTEX_HASH ( addr ) ] );
+	kthreads_schedule ();
+
+	RETURN ( SUCCESS );
+}
+
+/*!
+ * Release up to 'count' threads blocked on address 'addr'
+ * \param addr Address (user) of synchronization variable
+ * \param count Maximal number of threads to release
+ * \return number of released threads
+ */
+int sys__futex_wake ( void *p )
+{
+	/* parameters on thread stack */
+	int *addr;
+	int count;
+	/* local variables */
+	kthread_q *q;
+	kthread_t *kthr, *next;
+	int released = 0;
+
+	addr = *( (void **) p );	p += sizeof (void *);
+	count = *( (int *) p );
+
+	ASSERT_ERRNO_AND_EXIT ( addr, E_INVALID_HANDLE );
+
+	addr = U2K_GET_ADR ( addr, kthread_get_process (NULL) );
+	q = &futex_q[ FUTEX_HASH ( addr ) ];
+
+	/* queue is shared - release only threads waiting on 'addr' */
+	kthr = kthreadq_get ( q );
+	while ( kthr && released < count )
+	{
+		next = kthreadq_get_next ( kthr );
+
+		if ( kthread_get_qdata ( kthr ) == addr )
+		{
+			kthreadq_remove ( q, kthr );
+			kthread_move_to_ready ( kthr, LAST );
+			released++;
+		}
+
+		kthr = next;
+	}
+
+	SET_ERRNO ( SUCCESS );
+
+	if ( released )
+		kthreads_schedule ();
+
+	return released;
+}
@@ -0,0 +1,14 @@
+/*! Futex - wait queues identified by (process) memory address */
+
+#pragma once
+
+#include <lib/types.h>
+#include <kernel/thread.h>
+
+/* number of queues; multiple addresses may share same queue */
+#define FUTEX_QUEUES	64
+
+void k_futex_init ();
+
+int sys__futex_wait ( void *p );
+int sys__futex_wake ( void *p );
@@ -7,12 +7,132 @@
 
 kdevice_t *k_stdout; /* initialized in startup.c */
 
+int k_log_level = KLOG_LEVEL;
+
+/*! Message ring buffer; 'head' and 'tail' are free running counters */
+static char kprint_buf[KPRINT_BUFSZ];
+static uint kprint_head = 0;	/* changed only by kprint_write */
+static uint kprint_tail = 0;	/* changed only by kprint_send */
+static uint kprint_lost = 0;	/* characters dropped since buffer was full */
+static int kprint_sync = FALSE;	/* send directly, without buffering */
+static int kprint_busy = FALSE;	/* console device was full on last send */
+
+static void kprint_write ( char *text );
+static int kprint_send ( int max );
+
+/*! Save text in buffer (and send it, if in synchronous mode) */
+static void kprint_write ( char *text )
+{
+	while ( *text )
+	{
+		if ( kprint_head - kprint_tail == KPRINT_BUFSZ )
+		{
+			if ( kprint_sync && k_stdout )
+			{
+				kprint_send ( KPRINT_BUFSZ );
+			}
+			else {
+				/* buffer full: drop new text, but count it */
+				kprint_lost += strlen ( text );
+				return;
+			}
+		}
+
+		kprint_buf[ kprint_head % KPRINT_BUFSZ ] = *text++;
+		kprint_head++;
+	}
+
+	if ( kprint_sync )
+		kprint_send ( KPRINT_BUFSZ );
+}
+
+/*!
+ * Send up to 'max' buffered characters to console. Only characters accepted
+ * by device are removed from buffer. If device is full, return (or, in
+ * synchronous mode, keep polling it until it accepts the rest).
+ * \returns number of characters remaining in buffer
+ */
+static int kprint_send ( int max )
+{
+	struct {
+		int attr;
+		char text[KPRINT_DRAIN_CHUNK + 1];
+	} chunk;
+	int i, rest, sent;
+
+	kprint_busy = FALSE;
+
+	if ( !k_stdout )
+		return kprint_head - kprint_tail;
+
+	chunk.attr = KERNEL_FONT;
+
+	while ( kprint_tail != kprint_head && max > 0 )
+	{
+		for ( i = 0; i < KPRINT_DRAIN_CHUNK && i < max &&
+			     kprint_tail + i != kprint_head; i++ )
+			chunk.text[i] =
+				kprint_buf[ ( kprint_tail + i ) % KPRINT_BUFSZ ];
+		chunk.text[i] = 0;
+
+		/* device returns number of bytes it didn't accept (string
+		   terminator is counted in size, but never sent) */
+		rest = k_device_send ( &chunk, i + 1, PRINTSTRING, k_stdout );
+
+		if ( rest < 0 || rest > i + 1 )
+			sent = i; /* device error: discard chunk */
+		else if ( rest > 0 )
+			sent = i + 1 - rest;
+		else
+			sent = i;
+
+		kprint_tail += sent;
+		max -= sent;
+
+		if ( sent < i && !kprint_sync )
+		{
+			kprint_busy = TRUE; /* device is full, continue later */
+			break;
+		}
+		/* in synchronous mode repeat, polling device until it is
+		   ready to accept rest of the text */
+	}
+
+	if ( kprint_lost && kprint_tail == kprint_head )
+	{
+		i = kprint_lost;
+		kprint_lost = 0;
+		kprint ( "[kprint: %d characters lost]\n", i );
+	}
+
+	return kprint_head - kprint_tail;
+}
+
+/*!
+ * Send single chunk of buffered text to console (called when system is idle)
+ * \returns number of characters remaining in buffer that could be sent
+ *          immediately (0 when buffer is empty or console device is full)
+ */
+int kprint_drain ()
+{
+	int rest = kprint_send ( KPRINT_DRAIN_CHUNK );
+
+	return kprint_busy ? 0 : rest;
+}
+
+/*! Send all buffered text and switch to synchronous mode (before halt) */
+void kprint_flush ()
+{
+	kprint_sync = TRUE;
+	kprint_send ( KPRINT_BUFSZ );
+}
+
 /*!
  * Formated output to console (lightweight version of 'printf')
  * int kprint ( char *format, ... ) - defined in lib/print.h
  */
 #define PRINT_FUNCTION_NAME	kprint
 #define PRINT_ATTRIBUT		KERNEL_FONT
-#define DEVICE_SEND(TEXT,SZ)	k_device_send(&TEXT, SZ, PRINTSTRING, k_stdout);
+#define DEVICE_SEND(TEXT,SZ)	kprint_write ( TEXT.text );
 
 #include <lib/print.h>
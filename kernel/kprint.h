@@ -2,4 +2,44 @@
 
 #pragma once
 
+#include <lib/types.h>
+#include <arch/processor.h>
+
+/*
+ * Kernel messages are stored in ring buffer and sent to console later, when
+ * system is idle (kprint_drain is called from idle thread). Buffer is flushed
+ * synchronously only before stopping the system (PANIC_HALT).
+ */
+
+/* ring buffer size (must be power of 2) */
+#define KPRINT_BUFSZ		4096
+
+/* maximal number of characters sent in single drain step */
+#define KPRINT_DRAIN_CHUNK	79
+
+/*! Message severity levels (for LOG macro) */
+#define KLOG_ERROR	1
+#define KLOG_ASSERT	1
+#define KLOG_WARNING	2
+#define KLOG_INFO	3
+#define KLOG_DEBUG	4
+
+/* messages with higher level are discarded (level can be changed at run time
+   with k_log_level variable) */
+#ifndef KLOG_LEVEL
+#define KLOG_LEVEL	KLOG_DEBUG
+#endif
+
+extern int k_log_level;
+
 int kprint ( char *format, ... );
+
+int kprint_drain ();
+void kprint_flush ();
+
+/*! Stop system, but first send all buffered kernel messages */
+#define PANIC_HALT()		\
+do {				\
+	kprint_flush ();	\
+	halt ();		\
+} while (0)
@@ -5,6 +5,10 @@
 #include <arch/multiboot.h>
 #include <arch/processor.h>
 #include <arch/interrupts.h>
+#include <arch/descriptors.h>
+#ifdef PAGING
+#include <arch/paging.h>
+#endif
 #include <kernel/kprint.h>
 #include <kernel/errno.h>
 #include <lib/string.h>
@@ -16,6 +20,15 @@ static mseg_t k_heap;	/* kernel heap: for everything else */
 
 static uint multiboot; /* save multiboot block address */
 
+#ifdef PAGING
+static mseg_t k_frames;		/* memory for process pages */
+static void *k_frames_list;	/* free frames (first word points to next) */
+static uint k_frames_free;	/* number of free frames */
+
+static char k_vspace[PAGE_TABLES];	/* used page table ranges */
+static uint k_vspace_first;	/* first range above physical memory */
+#endif
+
 /*! Dynamic memory allocator for kernel */
 MEM_ALLOC_T *k_mpool;
 
@@ -36,6 +49,9 @@ void k_memory_init ( unsigned long magic, unsigned long addr )
 	int i;
 	kprog_t *prog;
 	char *name, *pos;
+#ifdef PAGING
+	void *frame;
+#endif
 
 	/* implicitly from kernel linker script */
 	k_kernel.start = &kernel_code;
@@ -45,7 +61,7 @@ void k_memory_init ( unsigned long magic, unsigned long addr )
 	if (magic != MULTIBOOT_BOOTLOADER_MAGIC)
 	{
 		kprint ( "Boot loader is not multiboot-compliant!\n" );
-		halt();
+		PANIC_HALT ();
 	}
 
 	list_init ( &progs );
@@ -71,6 +87,27 @@ void k_memory_init ( unsigned long magic, unsigned long addr )
 	k_heap.start = (void *) max;
 	k_heap.size = ( mbi->mem_upper - 1024 ) * 1024 - max;
 
+#ifdef PAGING
+	/* take upper part of heap for process pages */
+	k_frames.size = ( k_heap.size / FRAMES_PART ) & ~( PAGE_SIZE - 1 );
+	k_heap.size -= k_frames.size;
+	k_heap.size &= ~( PAGE_SIZE - 1 );
+	k_frames.start = k_heap.start + k_heap.size;
+
+	k_frames_list = NULL;
+	k_frames_free = 0;
+	for ( frame = k_frames.start + k_frames.size - PAGE_SIZE;
+	      frame >= k_frames.start; frame -= PAGE_SIZE )
+		k_frame_free ( frame );
+
+	/* identity map physical memory; processes are mapped above it */
+	max = ( mbi->mem_upper + 1024 ) * 1024;
+	k_vspace_first = ( max + PAGE_TABLE_SPAN - 1 ) / PAGE_TABLE_SPAN;
+	memset ( k_vspace, 0, PAGE_TABLES );
+
+	arch_paging_init ( max );
+#endif
+
 	/* initialize dynamic memory allocation subsystem (needed for boot) */
 	k_mpool = k_mem_init ( k_heap.start, k_heap.size );
 
@@ -105,6 +142,224 @@ void k_memory_init ( unsigned long magic, unsigned long addr )
 	}
 }
 
+/*!
+ * Allocate memory for process
+ * - with paging only address space (and page tables) are reserved; pages are
+ *   added on first access (see k_page_fault)
+ */
+void *k_process_mem_alloc ( size_t size )
+{
+#ifndef PAGING
+	return kmalloc ( size );
+#else
+	uint first, i, n;
+	void *table;
+
+	n = ( size + PAGE_TABLE_SPAN - 1 ) / PAGE_TABLE_SPAN;
+
+	/* find 'n' consecutive unused ranges */
+	for ( first = k_vspace_first; first + n <= PAGE_TABLES; first++ )
+	{
+		for ( i = 0; i < n && !k_vspace[first + i]; i++ )
+			;
+		if ( i == n )
+			break;
+	}
+	if ( first + n > PAGE_TABLES )
+		return NULL;
+
+	for ( i = 0; i < n; i++ )
+	{
+		table = k_frame_alloc ();
+		if ( !table )
+		{
+			k_process_mem_free ( (void *) ( first * PAGE_TABLE_SPAN ),
+					     i * PAGE_TABLE_SPAN );
+			return NULL;
+		}
+		memset ( table, 0, PAGE_SIZE );
+		arch_page_table_set ( (void *) ( (first + i) * PAGE_TABLE_SPAN ),
+				      table );
+		k_vspace[first + i] = 1;
+	}
+
+	return (void *) ( first * PAGE_TABLE_SPAN );
+#endif
+}
+
+/*!
+ * Extend process memory (at its end) to 'new_size'
+ * - without paging process memory can't be extended: it can't be moved since
+ *   kernel holds addresses inside it (stacks, blocked threads data, ...)
+ * \return 0 if successful, -1 otherwise
+ */
+int k_process_mem_extend ( void *start, size_t size, size_t new_size )
+{
+#ifndef PAGING
+	return -1;
+#else
+	uint first, i, n;
+	void *table;
+
+	/* page table ranges: already used [first, i), required [first, n) */
+	first = (uint) start / PAGE_TABLE_SPAN;
+	i = first + ( size + PAGE_TABLE_SPAN - 1 ) / PAGE_TABLE_SPAN;
+	n = first + ( new_size + PAGE_TABLE_SPAN - 1 ) / PAGE_TABLE_SPAN;
+
+	if ( n > PAGE_TABLES )
+		return -1;
+
+	for ( first = i; i < n; i++ )
+		if ( k_vspace[i] )
+			return -1;
+
+	for ( i = first; i < n; i++ )
+	{
+		table = k_frame_alloc ();
+		if ( !table )
+		{
+			/* release tables added so far */
+			for ( ; i > first; i-- )
+			{
+				table = (void *) ( ( i - 1 ) * PAGE_TABLE_SPAN );
+				k_frame_free ( arch_page_table_get ( table ) );
+				arch_page_table_set ( table, NULL );
+				k_vspace[i - 1] = 0;
+			}
+			return -1;
+		}
+		memset ( table, 0, PAGE_SIZE );
+		arch_page_table_set ( (void *) ( i * PAGE_TABLE_SPAN ), table );
+		k_vspace[i] = 1;
+	}
+
+	return 0;
+#endif
+}
+
+/*! Release process memory */
+void k_process_mem_free ( void *start, size_t size )
+{
+#ifndef PAGING
+	kfree ( start );
+#else
+	void *adr, *frame, *table;
+
+	for ( adr = start; adr < start + size; adr += PAGE_SIZE )
+	{
+		frame = arch_page_unmap ( adr );
+		if ( frame )
+			k_frame_free ( frame );
+	}
+
+	for ( adr = start; adr < start + size; adr += PAGE_TABLE_SPAN )
+	{
+		table = arch_page_table_get ( adr );
+		arch_page_table_set ( adr, NULL );
+		k_frame_free ( table );
+		k_vspace[ (uint) adr / PAGE_TABLE_SPAN ] = 0;
+	}
+
+	arch_tlb_flush ();
+#endif
+}
+
+#ifdef PAGING
+/*! Get free frame (physical page) */
+void *k_frame_alloc ()
+{
+	void *frame = k_frames_list;
+
+	if ( frame )
+	{
+		k_frames_list = *( (void **) frame );
+		k_frames_free--;
+	}
+
+	return frame;
+}
+
+/*! Release frame */
+void k_frame_free ( void *frame )
+{
+	*( (void **) frame ) = k_frames_list;
+	k_frames_list = frame;
+	k_frames_free++;
+}
+
+/*!
+ * Map zeroed pages in [start, start + size) now (not on first access), for
+ * process memory written by kernel while it isn't running for that process
+ * \return 0 if successful, -1 if out of frames
+ */
+int k_process_mem_map ( void *start, size_t size )
+{
+	void *adr, *frame;
+
+	adr = (void *) ( (uint) start & ~( PAGE_SIZE - 1 ) );
+	for ( ; adr < start + size; adr += PAGE_SIZE )
+	{
+		if ( arch_page_get ( adr ) )
+			continue;
+
+		frame = k_frame_alloc ();
+		if ( !frame )
+			return -1;
+
+		memset ( frame, 0, PAGE_SIZE );
+		arch_page_map ( adr, frame );
+	}
+
+	return 0;
+}
+
+/*!
+ * Page fault: if address is in process address space add zeroed page,
+ * otherwise handle it as memory fault.
+ * When there are no free frames and fault is caused by kernel (in syscall,
+ * through address from k_u2k_adr) that can't continue, so process is
+ * terminated and syscall abandoned (changes it already made remain).
+ */
+void k_page_fault ()
+{
+	void *adr, *frame;
+	kprocess_t *proc;
+
+	adr = arch_page_fault_address ();
+
+	if ( (uint) adr / PAGE_TABLE_SPAN < k_vspace_first ||
+	     !k_vspace[ (uint) adr / PAGE_TABLE_SPAN ] || arch_page_get ( adr ) )
+	{
+		LOG ( ERROR, "Page fault at %x!\n", adr );
+		k_memory_fault ();
+		return;
+	}
+
+	frame = k_frame_alloc ();
+	if ( !frame && arch_prev_mode () == KERNEL_MODE )
+	{
+		proc = kthread_get_process ( NULL );
+		if ( proc->pi && adr >= proc->m.start &&
+		     adr < proc->m.start + proc->m.size )
+		{
+			LOG ( ERROR, "Out of memory for pages, terminating "
+				     "process!\n" );
+			kthread_kill_process ( proc, -E_NO_MEMORY );
+			arch_kernel_fault_abort (); /* doesn't return */
+		}
+	}
+	if ( !frame )
+	{
+		LOG ( ERROR, "Out of memory for pages!\n" );
+		k_memory_fault ();
+		return;
+	}
+
+	memset ( frame, 0, PAGE_SIZE );
+	arch_page_map ( (void *) ( (uint) adr & ~( PAGE_SIZE - 1 ) ), frame );
+}
+#endif /* PAGING */
+
 /*! kernel <--> user address translation (using segmentation) */
 inline void *k_u2k_adr ( void *uadr, kprocess_t *proc )
 {
@@ -122,43 +377,195 @@ inline void *k_k2u_adr ( void *kadr, kprocess_t *proc )
 	return kadr - (aint) proc->m.start;
 }
 
-/*! unique system wide id numbers */
-#define WBITS	( sizeof(word_t) * 8 )
-static word_t idmask[ MAX_RESOURCES / WBITS ] = { 0 };
-static uint last_id = 0;
+/*!
+ * Handle table: system wide handles for kernel objects given to threads
+ * (threads, semaphores, monitors, queues, alarms, devices, ...)
+ * Entry is found by index (lower bits of handle) and handle is valid only if
+ * generation (upper bits) and object type match entry. Generation is changed
+ * when entry is released, so stale handle (of deleted object) is not valid,
+ * even when entry is reused. Free entries are used in FIFO order (to reuse
+ * released entry as late as possible); table is doubled when full.
+ */
+typedef struct _khandle_t_
+{
+	void *obj;	/* object; when free: index of next free entry */
+	uint16 gen;	/* generation: 1 .. HANDLE_GEN_MASK */
+	uint16 type;	/* object type; 0 when entry is free */
+}
+khandle_t;
+
+#define HANDLE_GEN_MASK		( ( 1 << HANDLE_GEN_BITS ) - 1 )
+#define HANDLE_NONE		HANDLE_MAX	/* end of free list */
+
+static khandle_t *handles = NULL;
+static uint handles_size = 0;
+static uint free_first = HANDLE_NONE, free_last = HANDLE_NONE;
 
-/*! Allocate and return unique id for new system resource */
-uint k_new_unique_id ()
+/*! Add entries [from, to> at end of free list */
+static void k_handles_free_add ( uint from, uint to )
 {
-	uint starting = last_id;
+	uint i;
 
-	do {
-		last_id = ( last_id + 1 ) % MAX_RESOURCES;
-		if ( last_id == starting )
-		{
-			LOG ( ERROR, "Don't have free unique id!\n" );
-			halt();
-		}
-		if ( last_id == 0 ) /* don't assign 0 */
-			continue;
+	for ( i = from; i < to; i++ )
+	{
+		handles[i].obj = (void *) (aint) ( i + 1 );
+		handles[i].type = 0;
+	}
+	handles[to - 1].obj = (void *) (aint) HANDLE_NONE;
+
+	if ( free_last != HANDLE_NONE )
+		handles[free_last].obj = (void *) (aint) from;
+	else
+		free_first = from;
+	free_last = to - 1;
+}
+
+/*! Double handle table (or create initial) */
+static int k_handles_grow ()
+{
+	khandle_t *new_handles;
+	uint new_size, i;
+
+	if ( handles_size >= HANDLE_MAX )
+		return -1;
+
+	if ( handles_size )
+		new_size = handles_size * 2;
+	else
+		new_size = HANDLES_INITIAL;
+	if ( new_size > HANDLE_MAX )
+		new_size = HANDLE_MAX;
+
+	new_handles = kmalloc ( new_size * sizeof (khandle_t) );
+	if ( !new_handles )
+		return -1;
+
+	if ( handles )
+	{
+		memcpy ( new_handles, handles, handles_size * sizeof (khandle_t) );
+		kfree ( handles );
 	}
-	while ( idmask [ last_id / WBITS ] & ( 1 << ( last_id % WBITS ) ) );
+	handles = new_handles;
+
+	for ( i = handles_size; i < new_size; i++ )
+		handles[i].gen = 1;
 
-	idmask [ last_id / WBITS ] |= 1 << ( last_id % WBITS );
+	k_handles_free_add ( handles_size, new_size );
+	handles_size = new_size;
 
-	return last_id;
+	return 0;
 }
 
-/*! Release resource id */
-void k_free_unique_id ( uint id )
+/*!
+ * Create handle for kernel object
+ * \param obj Object
+ * \param type Object type (HANDLE_*)
+ * \return handle (never 0), 0 if table can't be extended
+ */
+uint k_handle_new ( void *obj, uint type )
+{
+	khandle_t *h;
+	uint i;
+
+	ASSERT ( obj && type );
+
+	if ( free_first == HANDLE_NONE && k_handles_grow () )
+	{
+		LOG ( ERROR, "Don't have free handle!\n" );
+		return 0;
+	}
+
+	i = free_first;
+	h = &handles[i];
+	free_first = (aint) h->obj;
+	if ( free_first == HANDLE_NONE )
+		free_last = HANDLE_NONE;
+
+	h->obj = obj;
+	h->type = type;
+
+	return ( h->gen << HANDLE_INDEX_BITS ) | i;
+}
+
+/*!
+ * Get object for handle
+ * \param handle Handle (given by thread: any value)
+ * \param type Expected object type
+ * \return object, NULL if handle is not valid (or not of given type)
+ */
+void *k_handle_get ( uint handle, uint type )
+{
+	khandle_t *h;
+	uint i = HANDLE_INDEX ( handle );
+
+	if ( i >= handles_size )
+		return NULL;
+
+	h = &handles[i];
+	if ( h->type != type || h->gen != handle >> HANDLE_INDEX_BITS )
+		return NULL;
+
+	return h->obj;
+}
+
+/*! Release handle (object is not changed) */
+void k_handle_free ( uint handle )
 {
-	ASSERT ( id > 0 && id < MAX_RESOURCES &&
-		 ( idmask [ id / WBITS ] & ( 1 << ( id % WBITS ) ) ) );
+	khandle_t *h;
+	uint i = HANDLE_INDEX ( handle );
+
+	ASSERT ( i < handles_size && handles[i].type &&
+		 handles[i].gen == handle >> HANDLE_INDEX_BITS );
 
-	idmask [ id / WBITS ] &= ~ ( 1 << ( id % WBITS ) );
+	h = &handles[i];
+	if ( ++h->gen > HANDLE_GEN_MASK )
+		h->gen = 1; /* generation 0 is not used: handle is never 0 */
+
+	k_handles_free_add ( i, i + 1 );
 }
 
 
+/*!
+ * Extend calling process memory (added at process end, after stack)
+ * \param size Number of bytes to add (rounded to ALIGN_TO)
+ * \param start Where to save (process relative) address of added memory
+ * \return 0 if successful, -E_NO_MEMORY if process can't be extended,
+ *         -E_INVALID_ARGUMENT if size is zero or too large
+ */
+int sys__process_extend ( void *p )
+{
+	size_t size, limit, pad;
+	void **start;
+	kprocess_t *proc = kthread_get_process ( NULL );
+
+	size = *( (size_t *) p ); p += sizeof (size_t);
+	start = *( (void ***) p );
+
+	ASSERT_ERRNO_AND_EXIT ( size > 0 && start, E_INVALID_ARGUMENT );
+	start = U2K_GET_ADR ( start, proc );
+
+	/* process must not wrap around address space, even after rounding */
+	limit = (size_t) -1 - (size_t) proc->m.start - proc->m.size;
+	pad = size % ALIGN_TO ? ALIGN_TO - size % ALIGN_TO : 0;
+	ASSERT_ERRNO_AND_EXIT ( size <= limit && pad <= limit - size,
+				E_INVALID_ARGUMENT );
+	size += pad;
+
+	if ( k_process_mem_extend ( proc->m.start, proc->m.size,
+				    proc->m.size + size ) )
+		EXIT ( E_NO_MEMORY );
+
+	*start = (void *) proc->m.size;
+
+	proc->m.size += size;
+	proc->pi->end_adr = (void *) proc->m.size;
+
+	/* new size is used after return to thread (segments are reloaded) */
+	arch_update_user_segments ( proc->segm, proc->m.start, proc->m.size );
+
+	EXIT ( SUCCESS );
+}
+
 /*! print (or return) system information (and details) */
 int sys__sysinfo ( void *p )
 {
@@ -345,6 +752,10 @@ void k_memory_info ()
 
 	kprint ( "* Kernel heap:       %x, size=%x\n",
 		  k_heap.start, k_heap.size );
+#ifdef PAGING
+	kprint ( "* Process pages:     %x, size=%x, free=%x\n",
+		  k_frames.start, k_frames.size, k_frames_free * PAGE_SIZE );
+#endif
 }
 
 void k_memory_fault ()
@@ -354,7 +765,7 @@ void k_memory_fault ()
 	if ( arch_prev_mode () == KERNEL_MODE )
 	{
 		LOG ( ERROR, "PANIC: kernel caused GPF!\n");
-		halt ();
+		PANIC_HALT ();
 	}
 	else {
 		/* terminate active thread */
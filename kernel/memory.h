@@ -50,6 +50,22 @@ mseg_t;
 void k_memory_init ( unsigned long magic, unsigned long addr );
 void k_memory_info ();
 
+/*! Process memory (with paging: address space reserved, pages on demand) */
+void *k_process_mem_alloc ( size_t size );
+int k_process_mem_extend ( void *start, size_t size, size_t new_size );
+void k_process_mem_free ( void *start, size_t size );
+
+#ifdef PAGING
+/* with paging, 1/FRAMES_PART of free memory is used for process pages */
+#define FRAMES_PART	2
+
+void *k_frame_alloc ();
+void k_frame_free ( void *frame );
+int k_process_mem_map ( void *start, size_t size );
+
+void k_page_fault (); /* page fault handler */
+#endif
+
 /*! Program, loaded as module */
 typedef struct _kprog_t_
 {
@@ -65,6 +81,17 @@ kprog_t;
 
 /*! Process ----------------------------------------------------------------- */
 
+/*! Accounting, for threads and processes (times in k_get_cycles units) */
+typedef struct _kacct_t_
+{
+	uint64 run;		/* active */
+	uint64 ready;		/* ready, but not active */
+	uint64 wait;		/* blocked */
+	uint vol_switches;	/* blocked or exited */
+	uint invol_switches;	/* preempted */
+}
+kacct_t;
+
 /*! Process (programs loaded as modules) */
 typedef struct _kprocess_t_
 {
@@ -74,9 +101,12 @@ typedef struct _kprocess_t_
 
 	prog_info_t *pi; /* process header (copy of program header) */
 	mseg_t m;
+	int segm; /* its user segment descriptors (arch_user_segments_alloc) */
 
 	int thr_count;
 
+	kacct_t acct;	/* accounting of finished threads */
+
 	list_h all;
 }
 kprocess_t;
@@ -91,6 +121,11 @@ static inline size_t k_process_size ( void *proc )
 	return ( (kprocess_t *) proc )->m.size;
 }
 
+static inline int k_process_segments ( void *proc )
+{
+	return ( (kprocess_t *) proc )->segm;
+}
+
 /* -------------------------------------------------------------------------- */
 /*! kernel <--> user address translation (with segmentation) */
 
@@ -102,9 +137,36 @@ extern inline void *k_k2u_adr ( void *kadr, kprocess_t *proc );
 
 #define K2U_GET_ADR(ADR,PROC)	k_k2u_adr (ADR, PROC)
 
-uint k_new_unique_id ();
-void k_free_unique_id ( uint id );
-
+/*! Handles: system wide identifiers for kernel objects given to threads */
+/* object types (handle is valid only for object of its type) */
+enum {
+	HANDLE_THREAD = 1,
+	HANDLE_SEM,
+	HANDLE_MONITOR,
+	HANDLE_MONITOR_Q,
+	HANDLE_RWLOCK,
+	HANDLE_BARRIER,
+	HANDLE_MSG_Q,
+	HANDLE_ALARM,
+	HANDLE_DEVICE
+};
+
+/* handle = generation << HANDLE_INDEX_BITS | index in table (never 0, and
+   always positive as int) */
+#define HANDLE_INDEX_BITS	16
+#define HANDLE_GEN_BITS		15
+#define HANDLE_MAX		( 1 << HANDLE_INDEX_BITS )	/* table size */
+#define HANDLE_INDEX(H)		( (H) & ( HANDLE_MAX - 1 ) )
+
+/* handles given to threads in place of pointers (where API has 'void *') */
+#define HANDLE2PTR(H)		( (void *) (aint) (H) )
+#define PTR2HANDLE(P)		( (uint) (aint) (P) )
+
+uint k_handle_new ( void *obj, uint type );
+void *k_handle_get ( uint handle, uint type );
+void k_handle_free ( uint handle );
+
+int sys__process_extend ( void *p );
 int sys__sysinfo ( void *p );
 int k_list_programs ( char *buffer, size_t buf_size );
 
@@ -20,6 +20,7 @@ static list_t kmsg_qs = LIST_T_NULL;
 void k_thr_msg_init ( kthrmsg_qs *thrmsg )
 {
 	list_init ( &thrmsg->msgq.msgs );
+	/* only owner thread receives from it: no need for priority order */
 	kthreadq_init ( &thrmsg->msgq.thrq );
 	thrmsg->msgq.min_prio = 0;
 
@@ -72,11 +73,17 @@ int sys__create_msg_queue ( void *p )
 	ASSERT_ERRNO_AND_EXIT ( gmsgq, E_NO_MEMORY );
 
 	list_init ( &gmsgq->mq.msgs ); /* list for messages */
-	kthreadq_init ( &gmsgq->mq.thrq ); /* list for blocked threads */
+	/* list for blocked threads (highest priority receives first) */
+	kthreadq_init_ordered ( &gmsgq->mq.thrq, THRQ_PRIO );
 
 	gmsgq->mq.min_prio = min_prio;
-	msgq->id = gmsgq->id = k_new_unique_id ();
-	msgq->handle = gmsgq;
+	msgq->id = gmsgq->id = k_handle_new ( gmsgq, HANDLE_MSG_Q );
+	if ( !gmsgq->id )
+	{
+		kthreadq_destroy ( &gmsgq->mq.thrq );
+		kfree ( gmsgq );
+		EXIT ( E_NO_MEMORY );
+	}
 
 	list_append ( &kmsg_qs, gmsgq, &gmsgq->all ); /* all msg.q. list */
 
@@ -96,19 +103,19 @@ int sys__delete_msg_queue ( void *p )
 	ASSERT_ERRNO_AND_EXIT ( msgq, E_INVALID_HANDLE );
 	msgq = U2K_GET_ADR ( msgq, kthread_get_process (NULL) );
 
-	gmsgq = msgq->handle;
-	ASSERT_ERRNO_AND_EXIT ( gmsgq->id == msgq->id, E_INVALID_HANDLE );
+	gmsgq = k_handle_get ( msgq->id, HANDLE_MSG_Q );
+	ASSERT_ERRNO_AND_EXIT ( gmsgq, E_INVALID_HANDLE );
 
 	k_msgq_clean ( &gmsgq->mq );
 
 	kthreadq_release_all ( &gmsgq->mq.thrq );
 
-	k_free_unique_id ( gmsgq->id );
+	k_handle_free ( gmsgq->id );
+	kthreadq_destroy ( &gmsgq->mq.thrq );
 
 	kfree ( gmsgq );
 
 	msgq->id = 0;
-	msgq->handle = NULL;
 
 	EXIT ( SUCCESS );
 }
@@ -153,9 +160,8 @@ int sys__msg_post ( void *p )
 	else if ( dest_type == MSG_QUEUE )
 	{
 		msgq = dest;
-		kgmsgq = msgq->handle;
-		ASSERT_ERRNO_AND_EXIT ( kgmsgq && kgmsgq->id == msgq->id,
-					E_INVALID_HANDLE );
+		kgmsgq = k_handle_get ( msgq->id, HANDLE_MSG_Q );
+		ASSERT_ERRNO_AND_EXIT ( kgmsgq, E_INVALID_HANDLE );
 		kmsgq = &kgmsgq->mq;
 	}
 	else {
@@ -205,7 +211,11 @@ int sys__msg_post ( void *p )
 			K2U_GET_ADR ( cmsg, proc ), proc->pi->exit, 0,
 			kthread_get_prio ( kthr ) + 1, NULL, 0, 1, proc
 		);
-		ASSERT_ERRNO_AND_EXIT ( new_kthr, kthread_get_errno (NULL) );
+		if ( !new_kthr )
+		{
+			kthread_delete_private_storage ( kthr, cmsg );
+			EXIT ( E_NO_MEMORY );
+		}
 
 		kthread_set_private_storage ( new_kthr, cmsg );
 
@@ -261,9 +271,8 @@ int sys__msg_recv ( void *p )
 	}
 	else { /* src_type == MSG_QUEUE */
 		msgq = src;
-		kgmsgq = msgq->handle;
-		ASSERT_ERRNO_AND_EXIT ( kgmsgq && kgmsgq->id == msgq->id,
-					E_INVALID_HANDLE );
+		kgmsgq = k_handle_get ( msgq->id, HANDLE_MSG_Q );
+		ASSERT_ERRNO_AND_EXIT ( kgmsgq, E_INVALID_HANDLE );
 		kmsgq = &kgmsgq->mq;
 	}
 
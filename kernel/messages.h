@@ -34,7 +34,7 @@ typedef struct _kgmsg_q_
 {
 	kmsg_q mq;
 
-	uint id;	/* queue unique identifier */
+	uint id;	/* queue handle */
 	list_h all;	/* all global queues are in single list */
 }
 kgmsg_q;
@@ -10,25 +10,38 @@
 #include <kernel/errno.h>
 #include <lib/types.h>
 
-/*! Initialize new monitor */
+/*!
+ * Initialize new monitor
+ * \param monitor Monitor descriptor (user level descriptor)
+ * \param flags Order of entering blocked threads (THRQ_FIFO or THRQ_PRIO)
+ */
 int sys__monitor_init ( void *p )
 {
 	/* parameters on thread stack */
 	monitor_t *monitor;
+	uint flags;
 	/* local variables */
 	kmonitor_t *kmonitor;
 
 	monitor = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
 	ASSERT_ERRNO_AND_EXIT ( monitor, E_INVALID_HANDLE );
+	p += sizeof (void *);
+	flags = *( (uint *) p );
 
 	kmonitor = kmalloc ( sizeof (kmonitor_t) );
 	ASSERT_ERRNO_AND_EXIT ( kmonitor, E_NO_MEMORY );
 
 	kmonitor->lock = FALSE;
 	kmonitor->owner = NULL;
-	kthreadq_init ( &kmonitor->queue );
+	kthreadq_init_ordered ( &kmonitor->queue, flags & THRQ_PRIO );
 
-	monitor->ptr = kmonitor;
+	monitor->id = k_handle_new ( kmonitor, HANDLE_MONITOR );
+	if ( !monitor->id )
+	{
+		kthreadq_destroy ( &kmonitor->queue );
+		kfree ( kmonitor );
+		EXIT ( E_NO_MEMORY );
+	}
 
 	EXIT ( SUCCESS );
 }
@@ -42,36 +55,52 @@ int sys__monitor_destroy ( void *p )
 	kmonitor_t *kmonitor;
 
 	monitor = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
-	ASSERT_ERRNO_AND_EXIT ( monitor && monitor->ptr, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( monitor, E_INVALID_HANDLE );
 
-	kmonitor = monitor->ptr;
+	kmonitor = k_handle_get ( monitor->id, HANDLE_MONITOR );
+	ASSERT_ERRNO_AND_EXIT ( kmonitor, E_INVALID_HANDLE );
 
 	if ( kthreadq_release_all ( &kmonitor->queue ) )
 		kthreads_schedule ();
 
+	k_handle_free ( monitor->id );
+	kthreadq_destroy ( &kmonitor->queue );
 	kfree ( kmonitor );
-	monitor->ptr = NULL;
+	monitor->id = 0;
 
 	EXIT ( SUCCESS );
 }
 
-/*! Initialize new monitor */
+/*!
+ * Initialize new monitor queue (conditional variable)
+ * \param queue Monitor queue descriptor (user level descriptor)
+ * \param flags Order of releasing blocked threads (THRQ_FIFO or THRQ_PRIO)
+ */
 int sys__monitor_queue_init ( void *p )
 {
 	/* parameters on thread stack */
 	monitor_q *queue;
+	uint flags;
 	/* local variables */
 	kmonitor_q *kqueue;
 
 	queue = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
 	ASSERT_ERRNO_AND_EXIT ( queue, E_INVALID_HANDLE );
+	p += sizeof (void *);
+	flags = *( (uint *) p );
 
 	kqueue = kmalloc ( sizeof (kmonitor_q) );
 	ASSERT_ERRNO_AND_EXIT ( kqueue, E_NO_MEMORY );
 
-	kthreadq_init ( &kqueue->queue );
+	kthreadq_init_ordered ( &kqueue->queue, flags & THRQ_PRIO );
 
-	queue->ptr = kqueue;
+	queue->id = k_handle_new ( kqueue, HANDLE_MONITOR_Q );
+	if ( !queue->id )
+	{
+		kthreadq_destroy ( &kqueue->queue );
+		kfree ( kqueue );
+		EXIT ( E_NO_MEMORY );
+	}
 
 	EXIT ( SUCCESS );
 }
@@ -85,15 +114,18 @@ int sys__monitor_queue_destroy ( void *p )
 	kmonitor_q *kqueue;
 
 	queue = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
-	ASSERT_ERRNO_AND_EXIT ( queue && queue->ptr, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( queue, E_INVALID_HANDLE );
 
-	kqueue = queue->ptr;
+	kqueue = k_handle_get ( queue->id, HANDLE_MONITOR_Q );
+	ASSERT_ERRNO_AND_EXIT ( kqueue, E_INVALID_HANDLE );
 
 	if ( kthreadq_release_all ( &kqueue->queue ) )
 		kthreads_schedule ();
 
+	k_handle_free ( queue->id );
+	kthreadq_destroy ( &kqueue->queue );
 	kfree ( kqueue );
-	queue->ptr = NULL;
+	queue->id = 0;
 
 	EXIT ( SUCCESS );
 }
@@ -107,9 +139,10 @@ int sys__monitor_lock ( void *p )
 	kmonitor_t *kmonitor;
 
 	monitor = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
-	ASSERT_ERRNO_AND_EXIT ( monitor && monitor->ptr, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( monitor, E_INVALID_HANDLE );
 
-	kmonitor = monitor->ptr;
+	kmonitor = k_handle_get ( monitor->id, HANDLE_MONITOR );
+	ASSERT_ERRNO_AND_EXIT ( kmonitor, E_INVALID_HANDLE );
 
 	SET_ERRNO ( SUCCESS );
 
@@ -135,9 +168,10 @@ int sys__monitor_unlock ( void *p )
 	kmonitor_t *kmonitor;
 
 	monitor = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
-	ASSERT_ERRNO_AND_EXIT ( monitor && monitor->ptr, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( monitor, E_INVALID_HANDLE );
 
-	kmonitor = monitor->ptr;
+	kmonitor = k_handle_get ( monitor->id, HANDLE_MONITOR );
+	ASSERT_ERRNO_AND_EXIT ( kmonitor, E_INVALID_HANDLE );
 
 	ASSERT_ERRNO_AND_EXIT ( kmonitor->owner == kthread_get_active (),
 				E_NOT_OWNER );
@@ -164,15 +198,17 @@ int sys__monitor_wait ( void *p )
 	kmonitor_q *kqueue;
 
 	monitor = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
-	ASSERT_ERRNO_AND_EXIT ( monitor && monitor->ptr, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( monitor, E_INVALID_HANDLE );
 
 	p += sizeof (void *);
 
 	queue = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
-	ASSERT_ERRNO_AND_EXIT ( queue && queue->ptr, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( queue, E_INVALID_HANDLE );
 
-	kmonitor = monitor->ptr;
-	kqueue = queue->ptr;
+	kmonitor = k_handle_get ( monitor->id, HANDLE_MONITOR );
+	ASSERT_ERRNO_AND_EXIT ( kmonitor, E_INVALID_HANDLE );
+	kqueue = k_handle_get ( queue->id, HANDLE_MONITOR_Q );
+	ASSERT_ERRNO_AND_EXIT ( kqueue, E_INVALID_HANDLE );
 
 	ASSERT_ERRNO_AND_EXIT ( kmonitor->owner == kthread_get_active (),
 				E_NOT_OWNER );
@@ -218,9 +254,10 @@ static int k_monitor_release ( void *p, int broadcast )
 	int reschedule = 0;
 
 	queue = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
-	ASSERT_ERRNO_AND_EXIT ( queue && queue->ptr, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( queue, E_INVALID_HANDLE );
 
-	kqueue = queue->ptr;
+	kqueue = k_handle_get ( queue->id, HANDLE_MONITOR_Q );
+	ASSERT_ERRNO_AND_EXIT ( kqueue, E_INVALID_HANDLE );
 
 	do {
 		kthr = kthreadq_get ( &kqueue->queue ); /* first from queue */
@@ -0,0 +1,191 @@
+/*! Reader-writer lock (writer-preferring)
+ *
+ * Multiple readers may hold lock simultaneously, writer only alone.
+ * When writer is waiting new readers are blocked (so writers will not starve).
+ * Released lock is handed over to first blocked writer, if there is one;
+ * otherwise all blocked readers are released.
+ */
+#define _KERNEL_
+
+#define _RWLOCK_C_
+#include "rwlock.h"
+
+#include <kernel/thread.h>
+#include <kernel/memory.h>
+#include <kernel/kprint.h>
+#include <kernel/errno.h>
+#include <lib/types.h>
+
+/*!
+ * Initialize new reader-writer lock
+ * \param rwlock Lock descriptor (user level descriptor)
+ * \param flags Order of releasing blocked threads (THRQ_FIFO or THRQ_PRIO)
+ */
+int sys__rwlock_init ( void *p )
+{
+	/* parameters on thread stack */
+	rwlock_t *rwlock;
+	uint flags;
+	/* local variables */
+	krwlock_t *krwlock;
+
+	rwlock = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
+	ASSERT_ERRNO_AND_EXIT ( rwlock, E_INVALID_HANDLE );
+	p += sizeof (void *);
+	flags = *( (uint *) p );
+
+	krwlock = kmalloc ( sizeof (krwlock_t) );
+	ASSERT_ERRNO_AND_EXIT ( krwlock, E_NO_MEMORY );
+
+	krwlock->readers = 0;
+	krwlock->writer = NULL;
+	kthreadq_init_ordered ( &krwlock->rd_queue, flags & THRQ_PRIO );
+	kthreadq_init_ordered ( &krwlock->wr_queue, flags & THRQ_PRIO );
+
+	rwlock->id = k_handle_new ( krwlock, HANDLE_RWLOCK );
+	if ( !rwlock->id )
+	{
+		kthreadq_destroy ( &krwlock->rd_queue );
+		kthreadq_destroy ( &krwlock->wr_queue );
+		kfree ( krwlock );
+		EXIT ( E_NO_MEMORY );
+	}
+
+	EXIT ( SUCCESS );
+}
+
+/*! Destroy reader-writer lock (and unblock all threads blocked on it) */
+int sys__rwlock_destroy ( void *p )
+{
+	/* parameters on thread stack */
+	rwlock_t *rwlock;
+	/* local variables */
+	krwlock_t *krwlock;
+	int released;
+
+	rwlock = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
+	ASSERT_ERRNO_AND_EXIT ( rwlock, E_INVALID_HANDLE );
+
+	krwlock = k_handle_get ( rwlock->id, HANDLE_RWLOCK );
+	ASSERT_ERRNO_AND_EXIT ( krwlock, E_INVALID_HANDLE );
+
+	released = kthreadq_release_all ( &krwlock->rd_queue );
+	released += kthreadq_release_all ( &krwlock->wr_queue );
+
+	k_handle_free ( rwlock->id );
+	kthreadq_destroy ( &krwlock->rd_queue );
+	kthreadq_destroy ( &krwlock->wr_queue );
+	kfree ( krwlock );
+	rwlock->id = 0;
+
+	SET_ERRNO ( SUCCESS );
+
+	if ( released )
+		kthreads_schedule ();
+
+	RETURN ( SUCCESS );
+}
+
+/*! Lock for reading (or block trying) */
+int sys__rwlock_rdlock ( void *p )
+{
+	/* parameters on thread stack */
+	rwlock_t *rwlock;
+	/* local variables */
+	krwlock_t *krwlock;
+
+	rwlock = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
+	ASSERT_ERRNO_AND_EXIT ( rwlock, E_INVALID_HANDLE );
+
+	krwlock = k_handle_get ( rwlock->id, HANDLE_RWLOCK );
+	ASSERT_ERRNO_AND_EXIT ( krwlock, E_INVALID_HANDLE );
+
+	SET_ERRNO ( SUCCESS );
+
+	if ( !krwlock->writer && !kthreadq_get ( &krwlock->wr_queue ) )
+	{
+		krwlock->readers++;
+	}
+	else {
+		kthread_enqueue ( NULL, &krwlock->rd_queue );
+		kthreads_schedule ();
+	}
+
+	RETURN ( SUCCESS );
+}
+
+/*! Lock for writing (or block trying) */
+int sys__rwlock_wrlock ( void *p )
+{
+	/* parameters on thread stack */
+	rwlock_t *rwlock;
+	/* local variables */
+	krwlock_t *krwlock;
+
+	rwlock = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
+	ASSERT_ERRNO_AND_EXIT ( rwlock, E_INVALID_HANDLE );
+
+	krwlock = k_handle_get ( rwlock->id, HANDLE_RWLOCK );
+	ASSERT_ERRNO_AND_EXIT ( krwlock, E_INVALID_HANDLE );
+
+	ASSERT_ERRNO_AND_EXIT ( krwlock->writer != kthread_get_active (),
+				E_INVALID_ARGUMENT ); /* already owner */
+
+	SET_ERRNO ( SUCCESS );
+
+	if ( !krwlock->writer && !krwlock->readers )
+	{
+		krwlock->writer = kthread_get_active ();
+	}
+	else {
+		kthread_enqueue ( NULL, &krwlock->wr_queue );
+		kthreads_schedule ();
+	}
+
+	RETURN ( SUCCESS );
+}
+
+/*! Unlock reader-writer lock (held either for reading or for writing) */
+int sys__rwlock_unlock ( void *p )
+{
+	/* parameters on thread stack */
+	rwlock_t *rwlock;
+	/* local variables */
+	krwlock_t *krwlock;
+	int released = 0;
+
+	rwlock = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
+	ASSERT_ERRNO_AND_EXIT ( rwlock, E_INVALID_HANDLE );
+
+	krwlock = k_handle_get ( rwlock->id, HANDLE_RWLOCK );
+	ASSERT_ERRNO_AND_EXIT ( krwlock, E_INVALID_HANDLE );
+
+	if ( krwlock->writer == kthread_get_active () )
+		krwlock->writer = NULL;
+	else if ( !krwlock->writer && krwlock->readers > 0 )
+		krwlock->readers--;
+	else
+		EXIT ( E_NOT_OWNER );
+
+	SET_ERRNO ( SUCCESS );
+
+	if ( !krwlock->writer && !krwlock->readers )
+	{
+		/* lock is free: hand it over to first writer or to all readers */
+		krwlock->writer = kthreadq_get ( &krwlock->wr_queue );
+
+		if ( krwlock->writer )
+		{
+			released = kthreadq_release ( &krwlock->wr_queue );
+		}
+		else {
+			released = kthreadq_release_all ( &krwlock->rd_queue );
+			krwlock->readers = released;
+		}
+	}
+
+	if ( released )
+		kthreads_schedule ();
+
+	RETURN ( SUCCESS );
+}
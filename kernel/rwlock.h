@@ -0,0 +1,25 @@
+/*! Reader-writer lock (writer-preferring) */
+
+#pragma once
+
+#include <lib/types.h>
+#include <kernel/thread.h>
+
+/*! reader-writer lock descriptor */
+typedef struct _krwlock_t_
+{
+	int readers;		/* number of threads holding lock for reading */
+
+	kthread_t *writer;	/* thread holding lock for writing (if any) */
+
+	kthread_q rd_queue;	/* queue for blocked readers */
+	kthread_q wr_queue;	/* queue for blocked writers */
+}
+krwlock_t;
+
+int sys__rwlock_init ( void *p );
+int sys__rwlock_destroy ( void *p );
+
+int sys__rwlock_rdlock ( void *p );
+int sys__rwlock_wrlock ( void *p );
+int sys__rwlock_unlock ( void *p );
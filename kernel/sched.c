@@ -6,12 +6,16 @@
 
 extern ksched_t ksched_rr;
 extern ksched_t ksched_edf;
+extern ksched_t ksched_fair;
+extern ksched_t ksched_rm;
 
 /*! Staticaly defined schedulers (could be easily extended to dynamicaly) */
 static ksched_t *ksched[] = {
 	NULL,		/* SCHED_FIFO */
 	&ksched_rr,	/* SCHED_RR */
-	&ksched_edf	/* SCHED_EDF */
+	&ksched_edf,	/* SCHED_EDF */
+	&ksched_fair,	/* SCHED_FAIR */
+	&ksched_rm	/* SCHED_RM */
 };
 
 /*! Get pointer to ksched_t parameters for requested scheduling policy */
@@ -131,6 +135,18 @@ int ksched_deactivate_thread ( kthread_t *kthread )
 	return activated;
 }
 
+/*! Thread is to be released from wait queue; can its scheduler take it? */
+int ksched_wakeup_thread ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param (kthread);
+	int sched = tsched->sched_policy;
+
+	if ( ksched[sched] && ksched[sched]->thread_wakeup )
+		return ksched[sched]->thread_wakeup ( kthread );
+
+	return 0;
+}
+
 
 /*! Interface to threads ---------------------------------------------------- */
 
@@ -148,17 +164,17 @@ int sys__set_thread_sched_params ( void *p )
 
 	thread = *( (void **) p ); p += sizeof (void *);
 	thread = U2K_GET_ADR ( thread, kthread_get_process (NULL) );
-	ASSERT_ERRNO_AND_EXIT ( thread && thread->thread, E_INVALID_HANDLE );
-	kthread = thread->thread;
-	ASSERT_ERRNO_AND_EXIT ( thread->thr_id == kthread_get_id ( kthread ),
-				E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( thread, E_INVALID_HANDLE );
+	kthread = k_handle_get ( thread->thr_id, HANDLE_THREAD );
+	ASSERT_ERRNO_AND_EXIT ( kthread, E_INVALID_HANDLE );
 
 	sched_policy = *( (int *) p ); p += sizeof (int);
 	ASSERT_ERRNO_AND_EXIT ( sched_policy > 0 && sched_policy < SCHED_NUM,
 			       E_INVALID_HANDLE );
 
 	prio = *( (int *) p ); p += sizeof (int);
-	ASSERT_ERRNO_AND_EXIT ( prio >= 0 && prio < PRIO_LEVELS,
+	/* priorities from PRIO_RM_BAND up are given only by RM scheduler */
+	ASSERT_ERRNO_AND_EXIT ( prio >= 0 && prio < PRIO_RM_BAND,
 			       E_INVALID_HANDLE );
 
 	params = *( (void **) p ); p += sizeof (void *);
@@ -192,10 +208,9 @@ int sys__get_thread_sched_params ( void *p )
 
 	thread = *( (void **) p ); p += sizeof (void *);
 	thread = U2K_GET_ADR ( thread, kthread_get_process (NULL) );
-	ASSERT_ERRNO_AND_EXIT ( thread && thread->thread, E_INVALID_HANDLE );
-	kthread = thread->thread;
-	ASSERT_ERRNO_AND_EXIT ( thread->thr_id == kthread_get_id ( kthread ),
-				E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( thread, E_INVALID_HANDLE );
+	kthread = k_handle_get ( thread->thr_id, HANDLE_THREAD );
+	ASSERT_ERRNO_AND_EXIT ( kthread, E_INVALID_HANDLE );
 
 	/* get scheduling parameters */
 	tsched = kthread_get_sched_param (kthread);
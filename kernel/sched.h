@@ -21,6 +21,8 @@ typedef struct _kthread_sched_data_t_ kthread_sched_data_t; /* included in kthre
 #include <lib/types.h>
 #include <kernel/sched_rr.h>
 #include <kernel/sched_edf.h>
+#include <kernel/sched_fair.h>
+#include <kernel/sched_rm.h>
 
 /*! Thread specific data/interface ------------------------------------------ */
 
@@ -29,6 +31,8 @@ union _kthread_sched_params_t_
 {
 	ksched_rr_thread_params rr;	/* Round Robin per thread data */
 	ksched_edf_thread_params_t edf;
+	ksched_fair_thread_params_t fair;
+	ksched_rm_thread_params_t rm;
 
 	/* add others thread scheduling parameters for other schedulers that
 	   require parameters */
@@ -61,6 +65,7 @@ int ksched_thread_remove ( kthread_t *kthread );
 
 int ksched_activate_thread ( kthread_t *kthread );
 int ksched_deactivate_thread ( kthread_t *kthread );
+int ksched_wakeup_thread ( kthread_t *kthread );
 
 
 /*! Global scheduler specific data/interface -------------------------------- */
@@ -70,6 +75,8 @@ typedef union _ksched_params_t_
 {
 	ksched_rr_t rr;	/* Round Robin global data */
 	ksched_edf_t edf;
+	ksched_fair_t fair;
+	ksched_rm_t rm;
 
 	/* add others thread scheduling parameters for other schedulers that
 	   require parameters */
@@ -97,6 +104,10 @@ struct _ksched_t_
 	/* actions when thread stopped to be active */
 	int (*thread_deactivate) ( kthread_t * );
 
+	/* thread is released from wait queue; return 1 if scheduler took it
+	   (it will move thread to ready when it is its turn) */
+	int (*thread_wakeup) ( kthread_t * );
+
 	/* set scheduler specific parameters */
 	int (*set_sched_parameters) ( int sched_policy, sched_t *);
 
@@ -1,510 +1,1269 @@
-﻿/*! EDF Scheduler */
-#define _KERNEL_
-
-//TODO:#include "sched_edf.h"
-
-#include <kernel/sched.h>
-#include <kernel/time.h>
-#include <kernel/errno.h>
-#include <lib/types.h>
-
-static int edf_init ( ksched_t *self );
-static int edf_thread_add ( kthread_t *thread );
-static int edf_thread_remove ( kthread_t *thread );
-static int edf_set_sched_parameters ( int sched_policy, sched_t *params );
-static int edf_get_sched_parameters ( int sched_policy, sched_t *params );
-static int edf_set_thread_sched_parameters(kthread_t *kthread, sched_t *params);
-static int edf_get_thread_sched_parameters(kthread_t *kthread, sched_t *params);
-static int edf_thread_activate ( kthread_t *kthread );
-static void edf_period_timer ( void *p );
-static void edf_deadline_timer ( void *p );
-static int edf_thread_deactivate ( kthread_t *kthread );
-static int k_edf_schedule ();
-static int edf_check_deadline ( kthread_t *kthread );
-
-/*! staticaly defined Earliest-Deadline-First Scheduler */
-ksched_t ksched_edf = (ksched_t)
-{
-	.sched_id =		SCHED_EDF,
-
-	.init = 		edf_init,
-	.thread_add =		edf_thread_add,
-	.thread_remove =	edf_thread_remove,
-	.thread_activate =	edf_thread_activate,
-	.thread_deactivate =	edf_thread_deactivate,
-
-	.set_sched_parameters =		edf_set_sched_parameters,
-	.get_sched_parameters =		edf_get_sched_parameters,
-	.set_thread_sched_parameters =	edf_set_thread_sched_parameters,
-	.get_thread_sched_parameters =	edf_get_thread_sched_parameters,
-};
-
-/*! Init EDF scheduler */
-static int edf_init ( ksched_t *self )
-{
-	ASSERT ( self == &ksched_edf );
-
-	self->params.edf.active = NULL;
-	kthreadq_init ( &self->params.edf.ready );
-	kthreadq_init ( &self->params.edf.wait );
-
-	return 0;
-}
-static int edf_thread_add ( kthread_t *kthread )
-{
-	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
-
-	tsched->params.edf.edf_period_alarm = NULL;
-
-	return 0;
-}
-static int edf_thread_remove ( kthread_t *kthread )
-{
-	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
-	ksched_t *gsched = ksched_get ( tsched->sched_policy );
-
-	if ( gsched->params.edf.active == kthread )
-		gsched->params.edf.active = NULL;
-
-	if ( tsched->params.edf.edf_period_alarm )
-	{
-		k_alarm_remove ( tsched->params.edf.edf_period_alarm );
-		tsched->params.edf.edf_period_alarm = NULL;
-	}
-
-	tsched->sched_policy = SCHED_FIFO;
-
-	k_edf_schedule ();
-
-	return 0;
-}
-static int edf_set_sched_parameters ( int sched_policy, sched_t *params )
-{
-	return 0;
-}
-static int edf_get_sched_parameters ( int sched_policy, sched_t *params )
-{
-	return 0;
-}
-
-static int edf_arm_period ( kthread_t *kthread )
-{
-	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
-	alarm_t alarm;
-
-
-	alarm.action = edf_period_timer;
-	alarm.param = kthread;
-	alarm.flags = ALARM_PERIODIC;
-	alarm.period = tsched->params.edf.period;
-	alarm.exp_time = tsched->params.edf.next_run;
-
-	return k_alarm_new (	&tsched->params.edf.edf_period_alarm,
-				&alarm,
-				KERNELCALL );
-}
-
-static int edf_arm_deadline ( kthread_t *kthread )
-{
-	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
-	alarm_t alarm;
-	
-	alarm.action = edf_deadline_timer;
-	alarm.param = kthread;
-	alarm.flags = 0;
-	alarm.period.sec = alarm.period.nsec = 0;
-	alarm.exp_time.sec = alarm.exp_time.nsec = 0;
-
-	return k_alarm_new (	&tsched->params.edf.edf_deadline_alarm,
-				&alarm,
-				KERNELCALL );
-}
-
-
-
-static int edf_set_thread_sched_parameters (kthread_t *kthread, sched_t *params)
-{
-	time_t now;
-	alarm_t alarm;
-	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
-	ksched_t *gsched = ksched_get ( SCHED_EDF );
-
-
-	if ( gsched->params.edf.active == kthread )
-		gsched->params.edf.active = NULL;
-
-	k_get_time ( &now );
-
-	if ( params->edf.flags & EDF_SET )
-	{
-		/*LOG( DEBUG, "%x [SET]", kthread ); */
-		tsched->params.edf.period = params->edf.period;
-		tsched->params.edf.relative_deadline = params->edf.deadline;
-		tsched->params.edf.flags = params->edf.flags;
-
-		/* set periodic alarm */
-		tsched->params.edf.next_run = now;
-		time_add ( &tsched->params.edf.next_run, &params->edf.period );
-		edf_arm_deadline ( kthread );
-		edf_arm_period ( kthread );
-
-		/*
-		 * adjust "next_run" and "deadline" for "0" period
-		 * - first "edf_wait" will set correct values for first period
-		 */
-		tsched->params.edf.next_run = now;
-		time_sub ( &tsched->params.edf.next_run, &params->edf.period );
-
-		tsched->params.edf.active_deadline = now;
-		time_add ( &tsched->params.edf.active_deadline,
-			   &params->edf.deadline );
-	}
-	else if ( params->edf.flags & EDF_WAIT )
-	{
-		if ( edf_check_deadline ( kthread ) )
-			return -1;
-
-		/* set times for next period */
-		if ( time_cmp ( &now, &tsched->params.edf.next_run ) > 0 )
-		{
-			time_add ( &tsched->params.edf.next_run,
-				   &tsched->params.edf.period );
-
-			tsched->params.edf.active_deadline = tsched->params.edf.next_run;
-			time_add ( &tsched->params.edf.active_deadline,
-				   &tsched->params.edf.relative_deadline );
-		
-			if ( kthread == gsched->params.edf.active )
-				gsched->params.edf.active = NULL;
-
-			/* set (separate) alarm for deadline */
-
-			alarm.action = edf_deadline_timer;
-			alarm.param = kthread;
-			alarm.flags = 0;
-			alarm.period.sec = alarm.period.nsec = 0;
-			alarm.exp_time = tsched->params.edf.active_deadline;
-
-			k_alarm_set ( tsched->params.edf.edf_deadline_alarm, &alarm );
-
-		}
-
-		/* is task ready for execution, or must wait until next period */
-		if ( time_cmp ( &tsched->params.edf.next_run, &now ) > 0 )
-		{
-			/* wait till "next_run" */
-			LOG( DEBUG, "%x [EDF WAIT]", kthread );
-			kthread_enqueue ( kthread, &gsched->params.edf.wait );
-			kthreads_schedule (); /* will call edf_schedule() */
-		}
-		else {
-			/* "next_run" has already come,
-			 * activate task => move it to "EDF ready tasks"
-			 */
-			LOG( DEBUG, "%x [EDF READY]", kthread );
-			LOG( DEBUG, "%x [1st READY]", kthreadq_get ( &gsched->params.edf.ready ) );
-			kthread_enqueue ( kthread, &gsched->params.edf.ready );
-			kthreads_schedule (); /* will call edf_schedule() */
-		}
-	}
-	else if ( params->edf.flags & EDF_EXIT )
-	{
-		if ( kthread == gsched->params.edf.active )
-			gsched->params.edf.active = NULL;
-
-		//LOG( DEBUG, "%x [EXIT]", kthread );
-		if ( edf_check_deadline ( kthread ) )
-		{
-			LOG( DEBUG, "%x [EXIT-error]", kthread );
-			return -1;
-		}
-
-		LOG( DEBUG, "%x [EXIT-normal]", kthread );
-		if ( tsched->params.edf.edf_period_alarm )
-			k_alarm_remove ( tsched->params.edf.edf_period_alarm );
-
-		if ( tsched->params.edf.edf_deadline_alarm )
-			k_alarm_remove ( tsched->params.edf.edf_deadline_alarm );
-
-		tsched->sched_policy = SCHED_FIFO;
-
-		LOG( DEBUG, "%x [EXIT]", kthread );
-		if ( k_edf_schedule () )
-		{
-			LOG( DEBUG, "%x [EXIT]", kthread );
-
-			kthreads_schedule (); /* will NOT call edf_schedule() */
-		}
-
-		LOG( DEBUG, "%x [EXIT]", kthread );
-	}
-
-	return 0;
-}
-
-static int edf_get_thread_sched_parameters (kthread_t *kthread, sched_t *params)
-{
-	return 0;
-}
-
-static int k_edf_schedule ()
-{
-	kthread_t *first, *next, *edf_active;
-	kthread_sched_data_t *sch_first, *sch_next;
-	ksched_t *gsched = ksched_get ( SCHED_EDF );
-	int retval = 0;
-
-	edf_active = gsched->params.edf.active;
-	first = kthreadq_get ( &gsched->params.edf.ready );
-
-	LOG( DEBUG, "%x [active]", edf_active );
-	LOG( DEBUG, "%x [first]", first );
-	//LOG( DEBUG, "%x [next]", next );
-
-	if ( !first )
-		return 0; /* no threads in edf.ready queue, edf.active unch. */
-
-	if ( edf_active )
-	{
-		next = first;
-		first = edf_active;
-		LOG( DEBUG, "%x [next]", kthreadq_get_next ( next ) );
-	}
-	else {
-		next = kthreadq_get_next ( first );
-		LOG( DEBUG, "%x [next]", next );
-	}
-
-	while ( first && next )
-	{
-
-		sch_first = kthread_get_sched_param ( first );
-		sch_next = kthread_get_sched_param ( next );
-
-		if ( time_cmp ( &sch_first->params.edf.active_deadline,
-			&sch_next->params.edf.active_deadline ) > 0 )
-		{
-			first = next;
-		}
-
-		next = kthreadq_get_next ( next );
-	}
-
-	if ( first && first != edf_active )
-	{
-		next = kthreadq_remove ( &gsched->params.edf.ready, first );
-		LOG ( DEBUG, "%x removed, %x is now first", next, kthreadq_get ( &gsched->params.edf.ready ) );
-
-		if ( edf_active )
-		{
-			LOG( DEBUG, "%x=>%x [EDF_SCHED_PREEMPT]",
-			     edf_active, first );
-
-			/*
-			 * change active EDF thread:
-			 * -remove it from active/ready list
-			 * -put it into edf.ready list
-			 */
-			if ( kthread_is_ready (edf_active) )
-			{
-				if ( !kthread_is_active (edf_active) )
-				{
-					kthread_remove_from_ready (edf_active);
-
-					/*
-					 * set "deactivated" flag, don't need
-					 * another call to "edf_schedule"
-					 */
-				}
-				else {
-					kthread_get_sched_param (edf_active)
-						->activated = 0;
-				}
-
-				kthread_enqueue ( edf_active,
-						  &gsched->params.edf.ready );
-			}
-			/* else = thread is blocked - leave it there */
-		}
-
-		gsched->params.edf.active = first;
-		LOG( DEBUG, "%x [new active]", first );
-
-		kthread_move_to_ready ( first, LAST );
-		retval = 1;
-	}
-
-	return retval;
-}
-
-/*! Timer interrupt for edf */
-static void edf_period_timer ( void *p )
-{
-	kthread_t *kthread = p, *test;
-
-	ASSERT ( kthread );
-
-	test = kthreadq_remove ( &ksched_edf.params.edf.wait, kthread );
-
-	LOG( DEBUG, "%x %x [Period alarm]", kthread, test );
-
-	if( test == kthread )
-	{
-		if ( !edf_check_deadline ( kthread ) )
-		{
-			//LOG( DEBUG, "%x [Waked, moved to edf.ready]", kthread );
-			kthread_enqueue ( kthread, &ksched_edf.params.edf.ready );
-
-			if ( k_edf_schedule () )
-				kthreads_schedule ();
-		}
-	}
-	else {
-		/*
-		 * thread is not in edf.wait queue, but might be running or its
-		 * blocked - it is probable (sure?) it missed deadline
-		 */
-		LOG( DEBUG, "%x [Not in edf.wait. Missed deadline?]", kthread );
-	}
-}
-
-
-static void edf_deadline_timer ( void *p )
-{
-	alarm_t alarm;
-	kthread_t *kthread = p, *test;
-	kthread_sched_data_t *tsched  = kthread_get_sched_param ( kthread );
-
-
-	ASSERT ( kthread );
-
-	test = kthreadq_remove ( &ksched_edf.params.edf.wait, kthread );
-
-	LOG( DEBUG, "%x %x [Deadline alarm]", kthread, test );
-
-	if( test == kthread )
-	{
-		if ( edf_check_deadline ( kthread ) )
-		{
-			LOG( DEBUG, "%x [Waked, but too late]", kthread );
-
-			kthread_set_syscall_retval ( kthread, -1 );
-			kthread_move_to_ready ( kthread, LAST );
-
-			if ( tsched->params.edf.flags & EDF_TERMINATE )
-			{
-				LOG( DEBUG, "%x [EDF_TERMINATE]", kthread );
-				tsched = kthread_get_sched_param ( kthread );
-				k_alarm_remove ( tsched->params.edf.edf_period_alarm );
-				k_alarm_remove ( tsched->params.edf.edf_deadline_alarm );
-				tsched->params.edf.edf_period_alarm = NULL;
-				kthread_cancel ( kthread, -E_DEADLINE );
-			}
-
-			kthreads_schedule ();
-		}
-	}
-	else {
-		/*
-		 * thread is not in edf.wait queue, but might be running or its
-		 * blocked - it is probable (sure?) it missed deadline
-		 */
-		LOG( DEBUG, "%x [Not in edf.wait. Missed deadline?]", kthread );
-
-		if ( edf_check_deadline ( kthread ) )
-		{
-			/* what to do if its missed? kill thread? */
-			tsched = kthread_get_sched_param ( kthread );
-			if ( tsched->params.edf.flags & EDF_TERMINATE )
-			{
-				LOG( DEBUG, "%x [EDF_TERMINATE]", kthread );
-				k_alarm_remove ( tsched->params.edf.edf_period_alarm );
-				k_alarm_remove ( tsched->params.edf.edf_deadline_alarm );
-				tsched->params.edf.edf_period_alarm = NULL;
-				kthread_cancel ( kthread, -E_DEADLINE );
-			}
-			else if ( tsched->params.edf.flags & EDF_CONTINUE )
-			{
-				/* continue as deadline is not missed */
-				LOG( DEBUG, "%x [EDF_CONTINUE]", kthread );
-			}
-			else if ( tsched->params.edf.flags & EDF_SKIP )
-			{
-				/* skip deadline */
-				/* set times for next period */
-				LOG( DEBUG, "%x [EDF_SKIP]", kthread );
-
-				time_add ( &tsched->params.edf.next_run,
-					   &tsched->params.edf.period );
-			
-				tsched->params.edf.active_deadline = tsched->params.edf.next_run;
-				time_add ( &tsched->params.edf.active_deadline,
-					   &tsched->params.edf.relative_deadline );
-			
-				if ( kthread == ksched_edf.params.edf.active )
-					ksched_edf.params.edf.active = NULL;
-
-				alarm.action = edf_deadline_timer;
-				alarm.param = kthread;
-				alarm.flags = 0;
-				alarm.period.sec = alarm.period.nsec = 0;
-				alarm.exp_time = tsched->params.edf.active_deadline;
-
-				k_alarm_set ( tsched->params.edf.edf_deadline_alarm, &alarm );
-
-				alarm.action = edf_period_timer;
-				alarm.param = kthread;
-				alarm.flags = ALARM_PERIODIC;
-				alarm.period = tsched->params.edf.period;
-				alarm.exp_time = tsched->params.edf.next_run;
-
-				k_alarm_set ( tsched->params.edf.edf_period_alarm, &alarm );
-
-				kthread_enqueue ( kthread, &ksched_edf.params.edf.ready );
-				kthreads_schedule (); /* will call edf_schedule() */
-			}
-		}
-	}
-}
-
-
-
-static int edf_thread_activate ( kthread_t *kthread )
-{
-	return 0;
-}
-
-/*!
- * Deactivate thread because:
- * 1. higher priority thread becomes active
- * 2. this thread time slice is expired
- * 3. this thread blocks on some queue
- */
-static int edf_thread_deactivate ( kthread_t *kthread )
-{
-	return k_edf_schedule ();
-}
-
-/*!
- * Check if task hasn't overrun its deadline at its start
- * Handle deadline overrun, based on flags
- */
-static int edf_check_deadline ( kthread_t *kthread )
-{
-	/* 
-	 * Check if "now" is greater than "active_deadline"
-	 */
-
-	time_t now;
-	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
-
-	k_get_time ( &now );
-
-	if ( time_cmp ( &now, &tsched->params.edf.active_deadline ) > 0 )
-	{
-		LOG( DEBUG, "%x [DEADLINE OVERRUN]", kthread );
-		return -1;
-	}
-
-	return 0;
-}
+﻿/*! EDF Scheduler
+ *
+ * Released jobs (ready EDF threads) wait in 'ready' ordered by deadline in
+ * min-heap; job with earliest deadline is given to primary scheduler (becomes
+ * 'active'). Periodic tasks waiting for next period are in 'wait', ordered by
+ * release time. Releases and deadline checks share single kernel alarm, which
+ * is set to the first of them and reprogrammed only when that changes.
+ *
+ * Tasks that declare execution budget (and all servers) pass admission control
+ * and their jobs are stopped when they exceed budget. Tasks without budget have
+ * unknown demand and are not admitted, so they can't coexist with guarantees:
+ * task without budget is accepted only while no task or server is admitted,
+ * and admission is refused while such tasks exist (E_NOT_SCHEDULABLE).
+ */
+#define _KERNEL_
+
+//TODO:#include "sched_edf.h"
+
+#include <kernel/sched.h>
+#include <kernel/time.h>
+#include <kernel/errno.h>
+#include <lib/types.h>
+#include <lib/bits.h>
+
+/* time in microseconds (for comparing bandwidths) */
+#define TIME_US(T)	( (int64) (T).sec * 1000000 + (T).nsec / 1000 )
+
+#define PPM			1000000	/* utilization 1 [parts per million] */
+#define EDF_DEMAND_POINTS	1000	/* max. deadlines checked in admission */
+
+static int edf_init ( ksched_t *self );
+static int edf_thread_add ( kthread_t *thread );
+static int edf_thread_remove ( kthread_t *thread );
+static int edf_set_sched_parameters ( int sched_policy, sched_t *params );
+static int edf_get_sched_parameters ( int sched_policy, sched_t *params );
+static int edf_set_thread_sched_parameters(kthread_t *kthread, sched_t *params);
+static int edf_get_thread_sched_parameters(kthread_t *kthread, sched_t *params);
+static int edf_thread_activate ( kthread_t *kthread );
+static void edf_timer ( void *p );
+static int edf_thread_deactivate ( kthread_t *kthread );
+static int k_edf_schedule ();
+static int edf_check_deadline ( kthread_t *kthread );
+static int edf_thread_wakeup ( kthread_t *kthread );
+static time_t *edf_deadline ( kthread_t *kthread );
+
+static int edf_ready_cmp ( void *a, void *b );
+static int edf_release_cmp ( void *a, void *b );
+static int edf_deadline_cmp ( void *a, void *b );
+static void edf_ready_add ( kthread_t *kthread );
+static void edf_ready_remove ( kthread_t *kthread );
+static void edf_wait_add ( kthread_t *kthread );
+static void edf_wait_remove ( kthread_t *kthread );
+static void edf_release ( kthread_t *kthread );
+static void edf_job_done ( kthread_t *kthread );
+static void edf_deadline_missed ( kthread_t *kthread );
+static void edf_timer_update ();
+static void edf_skip_job ( kthread_t *kthread );
+static int edf_reserve ( kthread_t *kthread );
+static void edf_unreserve ( kthread_t *kthread );
+static void edf_detach ( kthread_t *kthread );
+static void edf_unbudgeted_leave ( kthread_t *kthread );
+static void edf_heap_insert ( heap_t *heap, kthread_t *kthread,
+			      heap_node_t *node );
+
+static int edf_admit ( ksched_edf_task_t *task, time_t *c, time_t *t,
+		       time_t *d );
+static void edf_leave ( ksched_edf_task_t *task );
+static uint64 edf_demand ( ksched_edf_task_t *task, uint32 l );
+
+static void edf_job_start ( kthread_t *kthread );
+static void edf_job_charge ( kthread_t *kthread );
+static void edf_charge ( kthread_t *kthread );
+static void edf_budget_timer ( void *p );
+
+static int edf_cbs_join ( kthread_t *kthread, sched_t *params );
+static void edf_cbs_leave ( kthread_t *kthread );
+static void edf_cbs_wakeup ( ksched_edf_server_t *server );
+static void edf_cbs_start ( kthread_t *kthread );
+static void edf_cbs_charge ( kthread_t *kthread );
+static void edf_cbs_postpone ( ksched_edf_server_t *server );
+static void edf_cbs_timer ( void *p );
+
+/*! staticaly defined Earliest-Deadline-First Scheduler */
+ksched_t ksched_edf = (ksched_t)
+{
+	.sched_id =		SCHED_EDF,
+
+	.init = 		edf_init,
+	.thread_add =		edf_thread_add,
+	.thread_remove =	edf_thread_remove,
+	.thread_activate =	edf_thread_activate,
+	.thread_deactivate =	edf_thread_deactivate,
+	.thread_wakeup =	edf_thread_wakeup,
+
+	.set_sched_parameters =		edf_set_sched_parameters,
+	.get_sched_parameters =		edf_get_sched_parameters,
+	.set_thread_sched_parameters =	edf_set_thread_sched_parameters,
+	.get_thread_sched_parameters =	edf_get_thread_sched_parameters,
+};
+
+/*! Init EDF scheduler */
+static int edf_init ( ksched_t *self )
+{
+	ksched_edf_t *edf = &self->params.edf;
+	alarm_t alarm;
+	int i;
+
+	ASSERT ( self == &ksched_edf );
+
+	edf->active = NULL;
+	kthreadq_init_ordered ( &edf->ready, THRQ_FIFO | THRQ_READY );
+	kthreadq_init ( &edf->wait );
+
+	edf->heap_max = EDF_HEAP_INITIAL;
+	edf->heap_nodes = kmalloc ( 3 * edf->heap_max * sizeof (heap_node_t *) );
+	ASSERT ( edf->heap_nodes );
+	edf->threads = 0;
+
+	heap_init ( &edf->ready_heap, edf->heap_nodes, edf->heap_max,
+		    edf_ready_cmp );
+	heap_init ( &edf->release_heap, edf->heap_nodes + edf->heap_max,
+		    edf->heap_max, edf_release_cmp );
+	heap_init ( &edf->deadline_heap, edf->heap_nodes + 2 * edf->heap_max,
+		    edf->heap_max, edf_deadline_cmp );
+
+	for ( i = 0; i < EDF_SERVERS; i++ )
+		edf->server[i].threads = 0;
+
+	list_init ( &edf->tasks );
+	edf->unbudgeted = 0;
+	edf->utilization = 0;
+	edf->budget_thread = NULL;
+
+	/* reserve empty alarms (for job budgets and for releases/deadlines) */
+	alarm.action = edf_budget_timer;
+	alarm.param = NULL;
+	alarm.flags = 0;
+	alarm.period.sec = alarm.period.nsec = 0;
+	alarm.exp_time.sec = alarm.exp_time.nsec = 0;
+
+	k_alarm_new ( &edf->budget_alarm, &alarm, KERNELCALL );
+
+	alarm.action = edf_timer;
+	alarm.param = NULL;
+	alarm.flags = 0;
+	alarm.period.sec = alarm.period.nsec = 0;
+	alarm.exp_time.sec = alarm.exp_time.nsec = 0;
+	edf->alarm_exp = alarm.exp_time;
+
+	k_alarm_new ( &edf->edf_alarm, &alarm, KERNELCALL );
+
+	return 0;
+}
+static int edf_thread_add ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	heap_node_init ( &tsched->params.edf.ready_node );
+	heap_node_init ( &tsched->params.edf.release_node );
+	heap_node_init ( &tsched->params.edf.deadline_node );
+	tsched->params.edf.budget.sec = tsched->params.edf.budget.nsec = 0;
+	tsched->params.edf.admitted = 0;
+	tsched->params.edf.unbudgeted = 0;
+	tsched->params.edf.server = NULL;
+	tsched->params.edf.reserved = 0;
+
+	return 0;
+}
+static int edf_thread_remove ( kthread_t *kthread )
+{
+	edf_detach ( kthread );
+
+	edf_timer_update ();
+	k_edf_schedule ();
+
+	return 0;
+}
+
+/*!
+ * Thread leaves EDF (canceled, policy changed, EDF_EXIT or failed request):
+ * remove it from EDF heaps and queues, admitted tasks and server and release
+ * its place in heaps; thread continues as SCHED_FIFO (if not canceled)
+ */
+static void edf_detach ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+	kthread_q *q = NULL;
+
+	if ( edf->active == kthread )
+		edf->active = NULL;
+
+	if ( heap_node_in_heap ( &tsched->params.edf.ready_node ) )
+	{
+		heap_remove ( &edf->ready_heap, &tsched->params.edf.ready_node );
+		q = &edf->ready;
+	}
+	if ( heap_node_in_heap ( &tsched->params.edf.release_node ) )
+	{
+		heap_remove ( &edf->release_heap,
+			      &tsched->params.edf.release_node );
+		q = &edf->wait;
+	}
+	edf_job_done ( kthread );
+	edf_job_charge ( kthread );
+
+	if ( tsched->params.edf.admitted )
+	{
+		edf_leave ( &tsched->params.edf.task );
+		tsched->params.edf.admitted = 0;
+	}
+
+	edf_unbudgeted_leave ( kthread );
+
+	if ( tsched->params.edf.server )
+		edf_cbs_leave ( kthread );
+
+	edf_unreserve ( kthread );
+
+	tsched->sched_policy = SCHED_FIFO;
+
+	/* if not canceled (but policy is changed) thread is still in queue */
+	if ( q && kthreadq_remove ( q, kthread ) )
+		kthread_move_to_ready ( kthread, LAST );
+}
+
+/*! Thread no longer counts as EDF task without budget */
+static void edf_unbudgeted_leave ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	if ( tsched->params.edf.unbudgeted )
+	{
+		ksched_edf.params.edf.unbudgeted--;
+		tsched->params.edf.unbudgeted = 0;
+	}
+}
+static int edf_set_sched_parameters ( int sched_policy, sched_t *params )
+{
+	return 0;
+}
+static int edf_get_sched_parameters ( int sched_policy, sched_t *params )
+{
+	return 0;
+}
+
+static int edf_set_thread_sched_parameters (kthread_t *kthread, sched_t *params)
+{
+	time_t now;
+	int missed;
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+
+	k_get_time ( &now );
+
+	/* any request can put thread into heaps: it must have place there */
+	if ( edf_reserve ( kthread ) )
+	{
+		edf_detach ( kthread );
+		EXIT ( E_NO_MEMORY );
+	}
+
+	if ( ( params->edf.flags & EDF_SET ) && ( params->edf.flags & EDF_CBS ) )
+	{
+		return edf_cbs_join ( kthread, params );
+	}
+	else if ( params->edf.flags & EDF_SET )
+	{
+		/*LOG( DEBUG, "%x [SET]", kthread ); */
+		if ( edf->active == kthread )
+			edf->active = NULL;
+
+		edf_job_done ( kthread );
+		edf_job_charge ( kthread );
+
+		if ( tsched->params.edf.admitted )
+		{
+			edf_leave ( &tsched->params.edf.task );
+			tsched->params.edf.admitted = 0;
+		}
+		edf_unbudgeted_leave ( kthread );
+
+		if ( TIME_US ( params->edf.budget ) > 0 )
+		{
+			if ( !edf_admit ( &tsched->params.edf.task,
+					  &params->edf.budget,
+					  &params->edf.period,
+					  &params->edf.deadline ) )
+			{
+				LOG( DEBUG, "%x [EDF not admitted]", kthread );
+				edf_detach ( kthread );
+				edf_timer_update ();
+				EXIT ( E_NOT_SCHEDULABLE );
+			}
+			tsched->params.edf.admitted = 1;
+		}
+		else if ( list_get ( &edf->tasks, FIRST ) )
+		{
+			/* no guarantees for admitted tasks with unknown demand */
+			LOG( DEBUG, "%x [EDF without budget not admitted]",
+			     kthread );
+			edf_detach ( kthread );
+			edf_timer_update ();
+			EXIT ( E_NOT_SCHEDULABLE );
+		}
+		else {
+			tsched->params.edf.unbudgeted = 1;
+			edf->unbudgeted++;
+		}
+
+		tsched->params.edf.period = params->edf.period;
+		tsched->params.edf.relative_deadline = params->edf.deadline;
+		tsched->params.edf.flags = params->edf.flags;
+		tsched->params.edf.budget = params->edf.budget;
+		if ( TIME_US ( params->edf.budget ) <= 0 )
+			tsched->params.edf.budget.sec =
+				tsched->params.edf.budget.nsec = 0;
+
+		/*
+		 * adjust "next_run" and "deadline" for "0" period
+		 * - first "edf_wait" will set correct values for first period
+		 */
+		tsched->params.edf.next_run = now;
+		time_sub ( &tsched->params.edf.next_run, &params->edf.period );
+
+		tsched->params.edf.active_deadline = now;
+		time_add ( &tsched->params.edf.active_deadline,
+			   &params->edf.deadline );
+	}
+	else if ( params->edf.flags & EDF_WAIT )
+	{
+		ASSERT_ERRNO_AND_EXIT ( kthread == kthread_get_active (),
+					E_INVALID_ARGUMENT );
+
+		if ( edf_check_deadline ( kthread ) )
+			return -1;
+
+		edf_job_done ( kthread );
+		edf_job_charge ( kthread );
+
+		if ( edf->active == kthread )
+			edf->active = NULL;
+
+		/* set times for next period */
+		if ( time_cmp ( &now, &tsched->params.edf.next_run ) > 0 )
+		{
+			time_add ( &tsched->params.edf.next_run,
+				   &tsched->params.edf.period );
+
+			tsched->params.edf.active_deadline =
+				tsched->params.edf.next_run;
+			time_add ( &tsched->params.edf.active_deadline,
+				   &tsched->params.edf.relative_deadline );
+		}
+
+		/* is task ready for execution, or must wait until next period */
+		if ( time_cmp ( &tsched->params.edf.next_run, &now ) > 0 )
+		{
+			/* wait till "next_run" */
+			LOG( DEBUG, "%x [EDF WAIT]", kthread );
+			edf_wait_add ( kthread );
+		}
+		else {
+			/* "next_run" has already come,
+			 * activate task => move it to "EDF ready tasks"
+			 */
+			LOG( DEBUG, "%x [EDF READY]", kthread );
+			edf_release ( kthread );
+		}
+
+		edf_timer_update ();
+		kthreads_schedule (); /* will call edf_schedule() */
+	}
+	else if ( params->edf.flags & EDF_EXIT )
+	{
+		if ( tsched->params.edf.server )
+			missed = 0;
+		else
+			missed = edf_check_deadline ( kthread );
+
+		edf_detach ( kthread );
+		edf_timer_update ();
+
+		LOG( DEBUG, "%x [EXIT]", kthread );
+		if ( k_edf_schedule () )
+			kthreads_schedule (); /* will NOT call edf_schedule() */
+
+		if ( missed )
+			return -1;
+	}
+
+	return 0;
+}
+
+static int edf_get_thread_sched_parameters (kthread_t *kthread, sched_t *params)
+{
+	return 0;
+}
+
+/*!
+ * Select ready job with earliest deadline; if its deadline is earlier than
+ * deadline of currently active EDF thread, replace it
+ * \return 1 if active EDF thread is changed, 0 otherwise
+ */
+static int k_edf_schedule ()
+{
+	kthread_t *first, *edf_active;
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+
+	edf_active = edf->active;
+	first = heap_first ( &edf->ready_heap );
+
+	if ( !first )
+		return 0; /* no threads in edf.ready queue, edf.active unch. */
+
+	if ( edf_active &&
+	     time_cmp ( edf_deadline ( edf_active ), edf_deadline ( first ) ) <= 0 )
+		return 0;
+
+	edf_ready_remove ( first );
+
+	if ( edf_active )
+	{
+		LOG( DEBUG, "%x=>%x [EDF_SCHED_PREEMPT]", edf_active, first );
+
+		/*
+		 * change active EDF thread:
+		 * -remove it from active/ready list
+		 * -put it into edf.ready list
+		 */
+		if ( kthread_is_ready (edf_active) )
+		{
+			if ( !kthread_is_active (edf_active) )
+			{
+				kthread_remove_from_ready (edf_active);
+			}
+			else {
+				/* deactivate hook won't be called */
+				edf_charge ( edf_active );
+				kthread_get_sched_param (edf_active)
+					->activated = 0;
+			}
+
+			edf_ready_add ( edf_active );
+		}
+		/* else = thread is blocked - leave it there */
+	}
+
+	edf->active = first;
+	LOG( DEBUG, "%x [new active]", first );
+
+	kthread_move_to_ready ( first, LAST );
+
+	return 1;
+}
+
+/*! Release jobs and check deadlines (single alarm for all tasks) */
+static void edf_timer ( void *p )
+{
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+	kthread_t *kthread;
+	kthread_sched_data_t *tsched;
+	time_t ref;
+	int resched = 0;
+
+	/* alarm might be activated bit before its time */
+	k_get_time ( &ref );
+	if ( time_cmp ( &ref, &edf->alarm_exp ) < 0 )
+		ref = edf->alarm_exp;
+	edf->alarm_exp.sec = edf->alarm_exp.nsec = 0;
+
+	/* release all jobs whose period started */
+	while ( ( kthread = heap_first ( &edf->release_heap ) ) )
+	{
+		tsched = kthread_get_sched_param ( kthread );
+		if ( time_cmp ( &tsched->params.edf.next_run, &ref ) > 0 )
+			break;
+
+		edf_wait_remove ( kthread );
+		edf_release ( kthread );
+		resched = 1;
+	}
+
+	/* handle all missed deadlines */
+	while ( ( kthread = heap_first ( &edf->deadline_heap ) ) )
+	{
+		tsched = kthread_get_sched_param ( kthread );
+		if ( time_cmp ( &tsched->params.edf.active_deadline, &ref ) > 0 )
+			break;
+
+		heap_remove ( &edf->deadline_heap,
+			      &tsched->params.edf.deadline_node );
+		edf_deadline_missed ( kthread );
+		resched = 1;
+	}
+
+	edf_timer_update ();
+
+	if ( k_edf_schedule () || resched )
+		kthreads_schedule ();
+}
+
+/*! Job is still running (or ready) after its deadline */
+static void edf_deadline_missed ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	LOG( DEBUG, "%x [DEADLINE OVERRUN]", kthread );
+
+	if ( tsched->params.edf.flags & EDF_TERMINATE )
+	{
+		LOG( DEBUG, "%x [EDF_TERMINATE]", kthread );
+		kthread_cancel ( kthread, -E_DEADLINE );
+	}
+	else if ( tsched->params.edf.flags & EDF_CONTINUE )
+	{
+		/* continue as deadline is not missed */
+		LOG( DEBUG, "%x [EDF_CONTINUE]", kthread );
+	}
+	else if ( tsched->params.edf.flags & EDF_SKIP )
+	{
+		/* skip deadline: continue job as it was released in next period */
+		LOG( DEBUG, "%x [EDF_SKIP]", kthread );
+		edf_skip_job ( kthread );
+	}
+}
+
+/*! Move current job to next period (with new deadline and budget) */
+static void edf_skip_job ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+
+	time_add ( &tsched->params.edf.next_run, &tsched->params.edf.period );
+
+	tsched->params.edf.active_deadline = tsched->params.edf.next_run;
+	time_add ( &tsched->params.edf.active_deadline,
+		   &tsched->params.edf.relative_deadline );
+
+	tsched->params.edf.used.sec = tsched->params.edf.used.nsec = 0;
+	tsched->params.edf.overrun = 0;
+
+	if ( heap_node_in_heap ( &tsched->params.edf.deadline_node ) )
+		heap_update ( &edf->deadline_heap,
+			      &tsched->params.edf.deadline_node );
+	else
+		edf_heap_insert ( &edf->deadline_heap, kthread,
+				  &tsched->params.edf.deadline_node );
+
+	if ( heap_node_in_heap ( &tsched->params.edf.ready_node ) )
+		heap_update ( &edf->ready_heap, &tsched->params.edf.ready_node );
+}
+
+/*! Set alarm to first release or deadline (if that is changed) */
+static void edf_timer_update ()
+{
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+	kthread_t *kthread;
+	kthread_sched_data_t *tsched;
+	alarm_t alarm;
+
+	alarm.exp_time.sec = alarm.exp_time.nsec = 0;
+
+	kthread = heap_first ( &edf->release_heap );
+	if ( kthread )
+	{
+		tsched = kthread_get_sched_param ( kthread );
+		alarm.exp_time = tsched->params.edf.next_run;
+	}
+
+	kthread = heap_first ( &edf->deadline_heap );
+	if ( kthread )
+	{
+		tsched = kthread_get_sched_param ( kthread );
+		if ( !( alarm.exp_time.sec + alarm.exp_time.nsec ) ||
+		     time_cmp ( &tsched->params.edf.active_deadline,
+				&alarm.exp_time ) < 0 )
+			alarm.exp_time = tsched->params.edf.active_deadline;
+	}
+
+	if ( !time_cmp ( &alarm.exp_time, &edf->alarm_exp ) )
+		return;
+
+	edf->alarm_exp = alarm.exp_time;
+
+	alarm.action = edf_timer;
+	alarm.param = NULL;
+	alarm.flags = 0;
+	alarm.period.sec = alarm.period.nsec = 0;
+
+	k_alarm_set ( edf->edf_alarm, &alarm );
+}
+
+static int edf_thread_activate ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	if ( tsched->params.edf.server )
+		edf_cbs_start ( kthread );
+	else
+		edf_job_start ( kthread );
+
+	return 0;
+}
+
+/*!
+ * Deactivate thread because:
+ * 1. higher priority thread becomes active
+ * 2. this thread time slice is expired
+ * 3. this thread blocks on some queue
+ */
+static int edf_thread_deactivate ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	edf_charge ( kthread );
+
+	if ( tsched->params.edf.server )
+	{
+
+		/* blocked CBS thread returns through edf_thread_wakeup */
+		if ( !kthread_is_ready ( kthread ) &&
+		     ksched_edf.params.edf.active == kthread )
+			ksched_edf.params.edf.active = NULL;
+	}
+
+	return k_edf_schedule ();
+}
+
+/*!
+ * CBS thread is released from some wait queue (e.g. semaphore): it must wait
+ * in edf.ready for its turn, as any other EDF job
+ */
+static int edf_thread_wakeup ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	if ( !tsched->params.edf.server || ksched_edf.params.edf.active == kthread )
+		return 0;
+
+	if ( !tsched->params.edf.server->running )
+		edf_cbs_wakeup ( tsched->params.edf.server );
+
+	edf_ready_add ( kthread );
+	k_edf_schedule ();
+
+	return 1;
+}
+
+/*!
+ * Check if task hasn't overrun its deadline at its start
+ * Handle deadline overrun, based on flags
+ */
+static int edf_check_deadline ( kthread_t *kthread )
+{
+	/* 
+	 * Check if "now" is greater than "active_deadline"
+	 */
+
+	time_t now;
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	k_get_time ( &now );
+
+	if ( time_cmp ( &now, &tsched->params.edf.active_deadline ) > 0 )
+	{
+		LOG( DEBUG, "%x [DEADLINE OVERRUN]", kthread );
+		return -1;
+	}
+
+	return 0;
+}
+
+/*! Deadline used for scheduling: server deadline for CBS threads */
+static time_t *edf_deadline ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	if ( tsched->params.edf.server )
+		return &tsched->params.edf.server->deadline;
+	else
+		return &tsched->params.edf.active_deadline;
+}
+
+/*! EDF queues ------------------------------------------------------------- */
+
+static int edf_ready_cmp ( void *a, void *b )
+{
+	return time_cmp ( edf_deadline ( a ), edf_deadline ( b ) );
+}
+static int edf_release_cmp ( void *a, void *b )
+{
+	return time_cmp ( &kthread_get_sched_param ( a )->params.edf.next_run,
+			  &kthread_get_sched_param ( b )->params.edf.next_run );
+}
+static int edf_deadline_cmp ( void *a, void *b )
+{
+	return time_cmp (
+		&kthread_get_sched_param ( a )->params.edf.active_deadline,
+		&kthread_get_sched_param ( b )->params.edf.active_deadline );
+}
+
+/*! Put thread (active or just released) into 'ready' */
+static void edf_ready_add ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+
+	kthread_enqueue ( kthread, &edf->ready );
+	edf_heap_insert ( &edf->ready_heap, kthread,
+			  &tsched->params.edf.ready_node );
+}
+static void edf_ready_remove ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+
+	heap_remove ( &edf->ready_heap, &tsched->params.edf.ready_node );
+	kthreadq_unlink ( &edf->ready, kthread );
+}
+
+/*! Put thread into 'wait' (until its next period) */
+static void edf_wait_add ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+
+	kthread_enqueue ( kthread, &edf->wait );
+	edf_heap_insert ( &edf->release_heap, kthread,
+			  &tsched->params.edf.release_node );
+}
+static void edf_wait_remove ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+
+	heap_remove ( &edf->release_heap, &tsched->params.edf.release_node );
+	kthreadq_unlink ( &edf->wait, kthread );
+}
+
+/*! Release new job: its deadline is checked from now on */
+static void edf_release ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+
+	edf_heap_insert ( &edf->deadline_heap, kthread,
+			  &tsched->params.edf.deadline_node );
+	tsched->params.edf.used.sec = tsched->params.edf.used.nsec = 0;
+	tsched->params.edf.overrun = 0;
+
+	edf_ready_add ( kthread );
+}
+
+/*!
+ * Make sure heaps have place for thread: each thread is at most once in each
+ * heap, so when every EDF thread has its place reserved, insert can't fail
+ * \return 0 if place is reserved, -1 if there isn't enough memory
+ */
+static int edf_reserve ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+	heap_node_t **nodes;
+	int max;
+
+	if ( tsched->params.edf.reserved )
+		return 0;
+
+	if ( edf->threads == edf->heap_max )
+	{
+		/* move all heaps into larger arrays */
+		max = edf->heap_max * 2;
+		nodes = kmalloc ( 3 * max * sizeof (heap_node_t *) );
+		if ( !nodes )
+			return -1;
+
+		heap_resize ( &edf->ready_heap, nodes, max );
+		heap_resize ( &edf->release_heap, nodes + max, max );
+		heap_resize ( &edf->deadline_heap, nodes + 2 * max, max );
+
+		kfree ( edf->heap_nodes );
+		edf->heap_nodes = nodes;
+		edf->heap_max = max;
+	}
+
+	edf->threads++;
+	tsched->params.edf.reserved = 1;
+
+	return 0;
+}
+static void edf_unreserve ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	if ( tsched->params.edf.reserved )
+	{
+		ksched_edf.params.edf.threads--;
+		tsched->params.edf.reserved = 0;
+	}
+}
+
+/*! Insert thread into heap (can't fail: its place is reserved) */
+static void edf_heap_insert ( heap_t *heap, kthread_t *kthread,
+			      heap_node_t *node )
+{
+	ASSERT ( kthread_get_sched_param ( kthread )->params.edf.reserved );
+
+	if ( heap_insert ( heap, kthread, node ) )
+		ASSERT ( FALSE ); /* more threads in heap than reserved */
+}
+
+/*! Job completed (or task left EDF): stop checking its deadline */
+static void edf_job_done ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	if ( heap_node_in_heap ( &tsched->params.edf.deadline_node ) )
+		heap_remove ( &ksched_edf.params.edf.deadline_heap,
+			      &tsched->params.edf.deadline_node );
+}
+
+
+/*! Constant bandwidth server ----------------------------------------------- */
+/*
+ * Server has budget Q for every period T. Its threads are scheduled by EDF
+ * with server deadline. When budget is exhausted it is replenished and
+ * deadline is postponed for T, so server never uses more than Q/T of processor
+ * (and can't jeopardize other EDF tasks) even when its threads overrun.
+ */
+
+/*! Join server (create it if not used); budget and period are set by first */
+static int edf_cbs_join ( kthread_t *kthread, sched_t *params )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_server_t *server;
+	alarm_t alarm;
+
+	ASSERT_ERRNO_AND_EXIT ( params->edf.server >= 0 &&
+				params->edf.server < EDF_SERVERS &&
+				kthread == kthread_get_active (),
+				E_INVALID_ARGUMENT );
+
+	server = &ksched_edf.params.edf.server[params->edf.server];
+
+	/* server thread has budget (server's) */
+	edf_unbudgeted_leave ( kthread );
+
+	if ( !server->threads )
+	{
+		ASSERT_ERRNO_AND_EXIT (
+			TIME_US ( params->edf.budget ) > 0 &&
+			TIME_US ( params->edf.budget ) <=
+				TIME_US ( params->edf.period ),
+			E_INVALID_ARGUMENT );
+
+		if ( !edf_admit ( &server->task, &params->edf.budget,
+				  &params->edf.period, &params->edf.period ) )
+		{
+			edf_detach ( kthread );
+			edf_timer_update ();
+			EXIT ( E_NOT_SCHEDULABLE );
+		}
+
+		server->budget = params->edf.budget;
+		server->period = params->edf.period;
+		server->remaining.sec = server->remaining.nsec = 0;
+		k_get_time ( &server->deadline );
+		server->running = NULL;
+
+		alarm.action = edf_cbs_timer;
+		alarm.param = server;
+		alarm.flags = 0;
+		alarm.period.sec = alarm.period.nsec = 0;
+		alarm.exp_time.sec = alarm.exp_time.nsec = 0;
+
+		k_alarm_new ( &server->alarm, &alarm, KERNELCALL );
+	}
+
+	if ( tsched->params.edf.server )
+		edf_cbs_leave ( kthread );
+
+	/* periodic task becomes server job */
+	edf_job_done ( kthread );
+	edf_job_charge ( kthread );
+	if ( tsched->params.edf.admitted )
+	{
+		edf_leave ( &tsched->params.edf.task );
+		tsched->params.edf.admitted = 0;
+	}
+
+	server->threads++;
+	tsched->params.edf.server = server;
+
+	if ( ksched_edf.params.edf.active == kthread )
+		ksched_edf.params.edf.active = NULL;
+
+	/* from now on it is EDF job with server deadline */
+	if ( !server->running )
+		edf_cbs_wakeup ( server );
+
+	edf_ready_add ( kthread );
+	kthreads_schedule (); /* will call edf_schedule() */
+
+	return 0;
+}
+
+/*! Leave server (release it if last) */
+static void edf_cbs_leave ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_server_t *server = tsched->params.edf.server;
+
+	edf_cbs_charge ( kthread );
+
+	if ( --server->threads == 0 )
+	{
+		k_alarm_remove ( server->alarm );
+		edf_leave ( &server->task );
+	}
+
+	tsched->params.edf.server = NULL;
+}
+
+/*!
+ * Server becomes active (its thread is ready): if remaining budget can't be
+ * used before current deadline without exceeding bandwidth Q/T (c >= (d-t)Q/T)
+ * start new period: d = t + T, c = Q
+ */
+static void edf_cbs_wakeup ( ksched_edf_server_t *server )
+{
+	time_t now, left;
+
+	k_get_time ( &now );
+
+	left = server->deadline;
+	if ( time_cmp ( &left, &now ) > 0 )
+	{
+		time_sub ( &left, &now );
+
+		if ( TIME_US ( server->remaining ) * TIME_US ( server->period ) <
+		     TIME_US ( left ) * TIME_US ( server->budget ) )
+			return; /* keep current budget and deadline */
+	}
+
+	server->deadline = now;
+	time_add ( &server->deadline, &server->period );
+	server->remaining = server->budget;
+}
+
+/*! Thread starts running: arm alarm for budget exhaustion */
+static void edf_cbs_start ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_server_t *server = tsched->params.edf.server;
+	alarm_t alarm;
+
+	if ( !TIME_US ( server->remaining ) )
+		edf_cbs_postpone ( server );
+
+	server->running = kthread;
+	k_get_time ( &server->exec_start );
+
+	alarm.action = edf_cbs_timer;
+	alarm.param = server;
+	alarm.flags = 0;
+	alarm.period.sec = alarm.period.nsec = 0;
+	alarm.exp_time = server->exec_start;
+	time_add ( &alarm.exp_time, &server->remaining );
+
+	k_alarm_set ( server->alarm, &alarm );
+}
+
+/*! Charge consumed time to server; postpone deadline if budget is used */
+static void edf_cbs_charge ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_server_t *server = tsched->params.edf.server;
+	time_t now;
+
+	if ( !server || server->running != kthread )
+		return;
+
+	k_get_time ( &now );
+	time_sub ( &now, &server->exec_start );
+
+	if ( time_cmp ( &now, &server->remaining ) < 0 )
+	{
+		time_sub ( &server->remaining, &now );
+	}
+	else {
+		/* budget exhausted: replenish and postpone deadline */
+		LOG( DEBUG, "%x [CBS budget exhausted]", kthread );
+		edf_cbs_postpone ( server );
+	}
+
+	server->running = NULL;
+}
+
+/*! Replenish budget and postpone deadline; reorder server's ready threads */
+static void edf_cbs_postpone ( ksched_edf_server_t *server )
+{
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+	kthread_sched_data_t *tsched;
+	kthread_t *kthread;
+
+	time_add ( &server->deadline, &server->period );
+	server->remaining = server->budget;
+
+	if ( server->threads < 2 )
+		return;
+
+	kthread = kthreadq_get ( &edf->ready );
+	while ( kthread )
+	{
+		tsched = kthread_get_sched_param ( kthread );
+		if ( tsched->params.edf.server == server )
+			heap_update ( &edf->ready_heap,
+				      &tsched->params.edf.ready_node );
+
+		kthread = kthreadq_get_next ( kthread );
+	}
+}
+
+/*! Budget exhausted while thread was running */
+static void edf_cbs_timer ( void *p )
+{
+	ksched_edf_server_t *server = p;
+	kthread_t *kthread = server->running;
+
+	if ( !kthread || kthread_get_active () != kthread )
+		return;
+
+	edf_cbs_charge ( kthread );
+
+	/* with postponed deadline, is it still first? */
+	if ( k_edf_schedule () )
+		kthreads_schedule ();
+	else
+		edf_cbs_start ( kthread );
+}
+
+
+/*! Admission control ------------------------------------------------------- */
+
+/*!
+ * Admit task if it and all already admitted tasks (and servers) remain
+ * schedulable: total utilization must not exceed 1; when some deadlines are
+ * shorter than periods, density or (if that fails) processor demand test is
+ * used (demand of jobs with deadlines in [0, L] must not exceed L, for every
+ * deadline L up to Baruah's bound). Too many points to check => reject.
+ * \return 1 if task is admitted (and added to list), 0 otherwise
+ */
+static int edf_admit ( ksched_edf_task_t *task, time_t *c, time_t *t,
+		       time_t *d )
+{
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+	ksched_edf_task_t *iter;
+	uint32 u, density, bound, dl;
+	int constrained, points;
+
+	if ( TIME_US ( *c ) <= 0 || TIME_US ( *t ) <= 0 || TIME_US ( *d ) <= 0 ||
+	     TIME_US ( *t ) > 0x7fffffff || TIME_US ( *d ) > 0x7fffffff ||
+	     TIME_US ( *c ) > TIME_US ( *d ) || TIME_US ( *c ) > TIME_US ( *t ) )
+		return 0;
+
+	task->c = TIME_US ( *c );
+	task->t = TIME_US ( *t );
+	task->d = TIME_US ( *d );
+	task->u = mul_div_32 ( task->c, PPM, task->t );
+
+	/* tasks without budget could use all processor time */
+	if ( edf->unbudgeted )
+		return 0;
+
+	u = edf->utilization + task->u;
+	if ( u > PPM )
+		return 0;
+
+	/* implicit deadlines (D >= T): utilization test is exact */
+	constrained = task->d < task->t;
+	density = mul_div_32 ( task->c, PPM, task->d < task->t ? task->d : task->t );
+	iter = list_get ( &edf->tasks, FIRST );
+	while ( iter )
+	{
+		if ( iter->d < iter->t )
+			constrained = 1;
+		density += mul_div_32 ( iter->c, PPM,
+					iter->d < iter->t ? iter->d : iter->t );
+		iter = list_get_next ( &iter->list );
+	}
+
+	if ( !constrained || density <= PPM )
+		goto admitted;
+
+	if ( u >= PPM - 1000 )
+		return 0; /* bound would be too large */
+
+	/* L* = max ( D_max, sum ( (T - D) * U ) / (1 - U) ), in ms */
+	bound = 0;
+	iter = task;
+	while ( iter )
+	{
+		if ( iter->d < iter->t )
+			bound += mul_div_32 ( ( iter->t - iter->d ) / 1000 + 1,
+					      iter->u, PPM - u ) + 1;
+		if ( iter->d / 1000 + 1 > bound )
+			bound = iter->d / 1000 + 1;
+
+		iter = iter == task ? list_get ( &edf->tasks, FIRST ) :
+				      list_get_next ( &iter->list );
+	}
+	if ( bound > 0x7fffffff / 1000 )
+		return 0;
+	bound *= 1000;
+
+	/* check demand at every absolute deadline up to bound */
+	points = 0;
+	iter = task;
+	while ( iter )
+	{
+		for ( dl = iter->d; dl <= bound; dl += iter->t )
+		{
+			if ( ++points > EDF_DEMAND_POINTS ||
+			     edf_demand ( task, dl ) > dl )
+				return 0;
+		}
+
+		iter = iter == task ? list_get ( &edf->tasks, FIRST ) :
+				      list_get_next ( &iter->list );
+	}
+
+admitted:
+	list_append ( &edf->tasks, task, &task->list );
+	edf->utilization = u;
+
+	return 1;
+}
+
+/*! Remove admitted task (or server) */
+static void edf_leave ( ksched_edf_task_t *task )
+{
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+
+	list_remove ( &edf->tasks, FIRST, &task->list );
+	edf->utilization -= task->u;
+}
+
+/*! Processor demand in [0, l] of admitted tasks and new 'task' */
+static uint64 edf_demand ( ksched_edf_task_t *task, uint32 l )
+{
+	ksched_edf_task_t *iter = task;
+	uint64 demand = 0;
+
+	while ( iter )
+	{
+		if ( l >= iter->d )
+			demand += (uint64) ( ( l - iter->d ) / iter->t + 1 ) *
+				  iter->c;
+
+		iter = iter == task ?
+			list_get ( &ksched_edf.params.edf.tasks, FIRST ) :
+			list_get_next ( &iter->list );
+	}
+
+	return demand;
+}
+
+
+/*! Job budget enforcement -------------------------------------------------- */
+
+/*! Job (re)starts running: arm alarm for rest of its budget */
+static void edf_job_start ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+	alarm_t alarm;
+
+	if ( !TIME_US ( tsched->params.edf.budget ) || tsched->params.edf.overrun )
+		return;
+
+	edf->budget_thread = kthread;
+	k_get_time ( &tsched->params.edf.exec_start );
+
+	alarm.action = edf_budget_timer;
+	alarm.param = NULL;
+	alarm.flags = 0;
+	alarm.period.sec = alarm.period.nsec = 0;
+	alarm.exp_time = tsched->params.edf.exec_start;
+	time_add ( &alarm.exp_time, &tsched->params.edf.budget );
+	time_sub ( &alarm.exp_time, &tsched->params.edf.used );
+
+	k_alarm_set ( edf->budget_alarm, &alarm );
+}
+
+/*! Add execution time since job was started to its used time */
+static void edf_job_charge ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+	time_t now;
+
+	if ( edf->budget_thread != kthread )
+		return;
+
+	k_get_time ( &now );
+	time_sub ( &now, &tsched->params.edf.exec_start );
+	time_add ( &tsched->params.edf.used, &now );
+
+	edf->budget_thread = NULL;
+}
+
+/*! Thread stops running: charge its server or its job */
+static void edf_charge ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	if ( tsched->params.edf.server )
+		edf_cbs_charge ( kthread );
+	else
+		edf_job_charge ( kthread );
+}
+
+/*! Running job used its budget */
+static void edf_budget_timer ( void *p )
+{
+	ksched_edf_t *edf = &ksched_edf.params.edf;
+	kthread_t *kthread = edf->budget_thread;
+	kthread_sched_data_t *tsched;
+
+	if ( !kthread || kthread_get_active () != kthread )
+		return;
+
+	tsched = kthread_get_sched_param ( kthread );
+
+	edf_job_charge ( kthread );
+
+	if ( time_cmp ( &tsched->params.edf.used,
+			&tsched->params.edf.budget ) < 0 )
+	{
+		edf_job_start ( kthread ); /* alarm was bit early */
+		return;
+	}
+
+	LOG( DEBUG, "%x [EDF BUDGET OVERRUN]", kthread );
+
+	if ( tsched->params.edf.flags & EDF_TERMINATE )
+	{
+		kthread_cancel ( kthread, -E_DEADLINE );
+		kthreads_schedule ();
+		return;
+	}
+
+	if ( tsched->params.edf.flags & EDF_SKIP )
+	{
+		/* rest of job is executed in next period */
+		edf_skip_job ( kthread );
+		edf_timer_update ();
+	}
+	else {
+		/* EDF_CONTINUE (or no action): don't check it again */
+		tsched->params.edf.overrun = 1;
+	}
+
+	if ( k_edf_schedule () )
+		kthreads_schedule ();
+	else
+		edf_job_start ( kthread );
+}
@@ -5,8 +5,42 @@
 #ifdef _KERNEL_
 
 #include <lib/types.h>
+#include <lib/heap.h>
 #include <kernel/thread.h>
 
+/* initial heap size (doubled when more threads use EDF) */
+#define EDF_HEAP_INITIAL	16
+
+/*! Admitted task or server (times in microseconds) */
+typedef struct _ksched_edf_task_t_
+{
+	uint32 c;	/* worst case execution time (budget) */
+	uint32 t;	/* period */
+	uint32 d;	/* relative deadline */
+	uint32 u;	/* utilization c/t [ppm] */
+
+	list_h list;	/* in 'ksched_edf_t.tasks' */
+}
+ksched_edf_task_t;
+
+/*! Constant bandwidth server (shared by threads that join it) */
+typedef struct _ksched_edf_server_t_
+{
+	time_t budget;		/* Q - budget given every period */
+	time_t period;		/* T */
+	time_t remaining;	/* c - remaining budget */
+	time_t deadline;	/* d - current server deadline */
+
+	int threads;		/* number of threads using server (0 - free) */
+	kthread_t *running;	/* thread consuming budget */
+	time_t exec_start;	/* when 'running' started (or was charged) */
+
+	void *alarm;		/* kernel alarm for budget exhaustion */
+
+	ksched_edf_task_t task;	/* for admission control */
+}
+ksched_edf_server_t;
+
 /*! Per thread scheduler data */
 typedef struct _ksched_edf_thread_params_t
 {
@@ -16,8 +50,20 @@ typedef struct _ksched_edf_thread_params_t
 	time_t active_deadline;
 	int flags;
 
-	void *edf_period_alarm;		/* kernel alarm reference used in EDF */
-	void *edf_deadline_alarm;
+	heap_node_t ready_node;		/* in 'ready_heap' */
+	heap_node_t release_node;	/* in 'release_heap' */
+	heap_node_t deadline_node;	/* in 'deadline_heap' */
+
+	time_t budget;		/* execution time per job (0 - not limited) */
+	time_t used;		/* execution time of current job */
+	time_t exec_start;	/* when it was activated (or charged) */
+	int overrun;		/* current job exceeded budget */
+	int admitted;		/* 'task' is in list of admitted tasks */
+	int unbudgeted;		/* set without budget (counted in 'unbudgeted') */
+	ksched_edf_task_t task;
+
+	ksched_edf_server_t *server;	/* CBS thread if not NULL */
+	int reserved;		/* has place in heaps (see edf_reserve) */
 }
 ksched_edf_thread_params_t;
 
@@ -26,8 +72,28 @@ typedef struct _ksched_edf_t_
 {
 	kthread_t *active; /* thread selected by EDF as top priority */
 
-	kthread_q ready;
-	kthread_q wait;
+	kthread_q ready;	/* released jobs (blocked for primary scheduler) */
+	kthread_q wait;		/* tasks waiting for next period */
+
+	heap_t ready_heap;	/* 'ready' ordered by deadline */
+	heap_t release_heap;	/* 'wait' ordered by release time */
+	heap_t deadline_heap;	/* released periodic jobs ordered by deadline */
+
+	heap_node_t **heap_nodes; /* arrays for all three heaps */
+	int heap_max;		/* size of each array */
+	int threads;		/* threads with reserved place in heaps */
+
+	void *edf_alarm;	/* first release or deadline (single alarm) */
+	time_t alarm_exp;	/* when it is set to expire (0 - not set) */
+
+	ksched_edf_server_t server[EDF_SERVERS];
+
+	list_t tasks;		/* admitted tasks and servers */
+	uint32 utilization;	/* their total utilization [ppm] */
+	int unbudgeted;		/* tasks set without budget (not admitted) */
+
+	kthread_t *budget_thread; /* running job whose budget is enforced */
+	void *budget_alarm;
 }
 ksched_edf_t;
 
@@ -0,0 +1,416 @@
+/*! Fair share Scheduler
+ *
+ * Each ready thread accumulates virtual runtime: processor time it consumed,
+ * scaled by its weight (derived from 'nice'). Thread with smallest virtual
+ * runtime is next to run. Only that thread (and threads just woken up) are
+ * given to primary scheduler (in ready queue); others wait in tree ordered by
+ * virtual runtime (for primary scheduler they are blocked in 'parked' queue).
+ *
+ * Time slice is 'latency' divided among ready threads proportionally to their
+ * weight, but not shorter than 'min_granularity'. When slice expires (or thread
+ * is preempted or blocks) virtual runtime is updated and thread with smallest
+ * one is selected. Preempted thread keeps processor if its virtual runtime
+ * isn't larger than smallest one by more than 'min_granularity'.
+ */
+#define _KERNEL_
+
+#include <kernel/sched.h>	/* includes "sched_fair.h" */
+#include <kernel/time.h>
+#include <kernel/errno.h>
+#include <lib/types.h>
+
+#define NICE_0_WEIGHT	1024
+#define VFACTOR_SHIFT	16
+
+#define FAIR_LATENCY		20000	/* default values [us] */
+#define FAIR_MIN_GRANULARITY	4000
+#define FAIR_LATENCY_MAX	1000000
+
+/*! Weights for nice -20 to 19; each step changes share for about 10% */
+static const uint fair_weights[] = {
+	/* -20 */ 88761, 71755, 56483, 46273, 36291,
+	/* -15 */ 29154, 23254, 18705, 14949, 11916,
+	/* -10 */  9548,  7620,  6100,  4904,  3906,
+	/*  -5 */  3121,  2501,  1991,  1586,  1277,
+	/*   0 */  1024,   820,   655,   526,   423,
+	/*   5 */   335,   272,   215,   172,   137,
+	/*  10 */   110,    87,    70,    56,    45,
+	/*  15 */    36,    29,    23,    18,    15
+};
+
+static int fair_init ( ksched_t *self );
+static int fair_thread_add ( kthread_t *kthread );
+static int fair_thread_remove ( kthread_t *kthread );
+static int fair_set_sched_parameters ( int sched_policy, sched_t *params );
+static int fair_get_sched_parameters ( int sched_policy, sched_t *params );
+static int fair_set_thread_sched_parameters(kthread_t *kthread,sched_t *params);
+static int fair_get_thread_sched_parameters(kthread_t *kthread,sched_t *params);
+static int fair_thread_activate ( kthread_t *kthread );
+static void fair_timer ( void *p );
+static int fair_thread_deactivate ( kthread_t *kthread );
+
+static int fair_cmp ( void *a, void *b );
+static uint64 fair_now ();
+static void fair_set_nice ( kthread_t *kthread, int nice );
+static void fair_update_min ( ksched_t *gsched, uint64 vruntime );
+static void fair_park ( ksched_t *gsched, kthread_t *kthread );
+static void fair_release_first ( ksched_t *gsched );
+
+/*! staticaly defined Fair share Scheduler */
+ksched_t ksched_fair = (ksched_t)
+{
+	.sched_id =		SCHED_FAIR,
+
+	.init = 		fair_init,
+	.thread_add =		fair_thread_add,
+	.thread_remove =	fair_thread_remove,
+	.thread_activate =	fair_thread_activate,
+	.thread_deactivate =	fair_thread_deactivate,
+
+	.set_sched_parameters =		fair_set_sched_parameters,
+	.get_sched_parameters =		fair_get_sched_parameters,
+	.set_thread_sched_parameters =	fair_set_thread_sched_parameters,
+	.get_thread_sched_parameters =	fair_get_thread_sched_parameters,
+
+	.params.fair.latency =		FAIR_LATENCY,
+	.params.fair.min_granularity =	FAIR_MIN_GRANULARITY
+};
+
+/*! Init fair share scheduler */
+static int fair_init ( ksched_t *self )
+{
+	ksched_fair_t *fair = &self->params.fair;
+
+	ASSERT ( self == &ksched_fair );
+
+	avl_init ( &fair->tree, fair_cmp );
+	kthreadq_init_ordered ( &fair->parked, THRQ_FIFO | THRQ_READY );
+	fair->min_vruntime = 0;
+	fair->load = 0;
+
+	/* reserve an empty alarm (for slice end) */
+	fair->alarm.exp_time.sec = fair->alarm.exp_time.nsec = 0;
+	fair->alarm.period.sec = fair->alarm.period.nsec = 0;
+	fair->alarm.action = fair_timer;
+	fair->alarm.param = NULL;
+	fair->alarm.flags = 0;
+
+	k_alarm_new ( &fair->fair_alarm, &fair->alarm, KERNELCALL );
+
+	return 0;
+}
+
+/*! Add thread with nice 0; start it at current minimal virtual runtime */
+static int fair_thread_add ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_fair_t *fair = &ksched_fair.params.fair;
+
+	fair_set_nice ( kthread, 0 );
+	tsched->params.fair.vruntime = fair->min_vruntime;
+	tsched->params.fair.parked = 0;
+	tsched->params.fair.expired = 0;
+	tsched->params.fair.sleeping = !kthread_is_ready ( kthread );
+
+	if ( !tsched->params.fair.sleeping )
+		fair->load += tsched->params.fair.weight;
+
+	return 0;
+}
+
+/*! Remove thread (canceled or changed scheduling policy) */
+static int fair_thread_remove ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_t *gsched = &ksched_fair;
+
+	if ( !tsched->params.fair.sleeping )
+		gsched->params.fair.load -= tsched->params.fair.weight;
+
+	if ( tsched->params.fair.parked )
+	{
+		avl_remove ( &gsched->params.fair.tree,
+			     &tsched->params.fair.node );
+		tsched->params.fair.parked = 0;
+
+		/* still in 'parked' queue if not canceled */
+		if ( kthreadq_remove ( &gsched->params.fair.parked, kthread ) )
+			kthread_move_to_ready ( kthread, LAST );
+	}
+	else if ( !tsched->params.fair.sleeping )
+	{
+		/* it was running or ready - let next one in */
+		fair_release_first ( gsched );
+	}
+
+	tsched->sched_policy = SCHED_FIFO;
+
+	return 0;
+}
+
+/*! Set latency and minimal granularity */
+static int fair_set_sched_parameters ( int sched_policy, sched_t *params )
+{
+	ksched_fair_t *fair = &ksched_fair.params.fair;
+	uint latency, gran;
+
+	latency = params->fair.latency.sec * 1000000 +
+		  params->fair.latency.nsec / 1000;
+	gran = params->fair.min_granularity.sec * 1000000 +
+	       params->fair.min_granularity.nsec / 1000;
+
+	ASSERT_ERRNO_AND_EXIT ( latency <= FAIR_LATENCY_MAX &&
+				gran <= FAIR_LATENCY_MAX, E_INVALID_ARGUMENT );
+
+	if ( latency )
+		fair->latency = latency;
+	if ( gran )
+		fair->min_granularity = gran;
+
+	return 0;
+}
+static int fair_get_sched_parameters ( int sched_policy, sched_t *params )
+{
+	ksched_fair_t *fair = &ksched_fair.params.fair;
+
+	params->fair.nice = 0;
+	params->fair.latency.sec = fair->latency / 1000000;
+	params->fair.latency.nsec = ( fair->latency % 1000000 ) * 1000;
+	params->fair.min_granularity.sec = fair->min_granularity / 1000000;
+	params->fair.min_granularity.nsec =
+		( fair->min_granularity % 1000000 ) * 1000;
+
+	return 0;
+}
+
+/*! Set thread's nice value */
+static int fair_set_thread_sched_parameters(kthread_t *kthread,sched_t *params)
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_fair_t *fair = &ksched_fair.params.fair;
+
+	ASSERT_ERRNO_AND_EXIT ( params->fair.nice >= FAIR_NICE_MIN &&
+				params->fair.nice <= FAIR_NICE_MAX,
+				E_INVALID_ARGUMENT );
+
+	if ( !tsched->params.fair.sleeping )
+		fair->load -= tsched->params.fair.weight;
+
+	fair_set_nice ( kthread, params->fair.nice );
+
+	if ( !tsched->params.fair.sleeping )
+		fair->load += tsched->params.fair.weight;
+
+	return 0;
+}
+static int fair_get_thread_sched_parameters(kthread_t *kthread,sched_t *params)
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	fair_get_sched_parameters ( SCHED_FAIR, params );
+	params->fair.nice = tsched->params.fair.nice;
+
+	return 0;
+}
+
+/*! Start time slice for thread */
+static int fair_thread_activate ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_t *gsched = &ksched_fair;
+	ksched_fair_t *fair = &gsched->params.fair;
+	uint64 vmin;
+	uint slice;
+
+	if ( tsched->params.fair.sleeping )
+	{
+		/* woken up: don't let it use all time it "saved" sleeping */
+		tsched->params.fair.sleeping = 0;
+		fair->load += tsched->params.fair.weight;
+
+		vmin = (uint64) fair->latency * 500; /* half latency [ns] */
+		if ( fair->min_vruntime > vmin )
+			vmin = fair->min_vruntime - vmin;
+		else
+			vmin = 0;
+
+		if ( tsched->params.fair.vruntime < vmin )
+			tsched->params.fair.vruntime = vmin;
+	}
+
+	tsched->params.fair.exec_start = fair_now ();
+	tsched->params.fair.expired = 0;
+
+	/* slice = latency * weight / load (in 1/1024 parts) */
+	slice = fair->latency;
+	if ( fair->load > tsched->params.fair.weight )
+		slice = ( slice * ( ( tsched->params.fair.weight << 10 ) /
+				    fair->load ) ) >> 10;
+	if ( slice < fair->min_granularity )
+		slice = fair->min_granularity;
+
+	k_get_time ( &fair->alarm.exp_time );
+	fair->alarm.exp_time.nsec += ( slice % 1000000 ) * 1000;
+	fair->alarm.exp_time.sec += slice / 1000000 +
+				    fair->alarm.exp_time.nsec / 1000000000;
+	fair->alarm.exp_time.nsec %= 1000000000;
+	fair->alarm.param = kthread;
+
+	k_alarm_set ( fair->fair_alarm, &fair->alarm );
+
+	return 0;
+}
+
+/*! Time slice is elapsed */
+static void fair_timer ( void *p )
+{
+	kthread_t *kthread = p;
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	if ( kthread_get_active () != kthread ||
+	     tsched->sched_policy != SCHED_FAIR )
+		return; /* thread was preempted, blocked or canceled */
+
+	tsched->params.fair.expired = 1;
+
+	kthread_move_to_ready ( kthread, LAST );
+	kthreads_schedule (); /* will call fair_thread_deactivate */
+}
+
+/*!
+ * Deactivate thread because:
+ * 1. higher priority thread becomes active
+ * 2. this thread time slice is expired
+ * 3. this thread blocks on some queue
+ * Update its virtual runtime and let thread with smallest one in.
+ */
+static int fair_thread_deactivate ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	kthread_sched_data_t *sfirst;
+	ksched_t *gsched = &ksched_fair;
+	ksched_fair_t *fair = &gsched->params.fair;
+	kthread_t *first;
+	uint64 now, delta, gran;
+
+	now = fair_now ();
+	delta = now - tsched->params.fair.exec_start;
+	if ( delta >> 32 )
+		delta = 0xffffffff;
+	tsched->params.fair.vruntime +=
+		( delta * tsched->params.fair.vfactor ) >> VFACTOR_SHIFT;
+	tsched->params.fair.exec_start = now;
+
+	fair_update_min ( gsched, tsched->params.fair.vruntime );
+
+	if ( !kthread_is_ready ( kthread ) )
+	{
+		/* blocked */
+		tsched->params.fair.sleeping = 1;
+		fair->load -= tsched->params.fair.weight;
+		fair_release_first ( gsched );
+
+		return 1;
+	}
+
+	first = avl_first ( &fair->tree );
+	if ( !first )
+		return 0;
+
+	sfirst = kthread_get_sched_param ( first );
+
+	gran = 0;
+	if ( !tsched->params.fair.expired )
+		gran = (uint64) fair->min_granularity * 1000;
+
+	if ( tsched->params.fair.vruntime <= sfirst->params.fair.vruntime + gran )
+		return 0; /* keep running (or stay ready) */
+
+	if ( !kthread_is_active ( kthread ) )
+		kthread_remove_from_ready ( kthread );
+
+	fair_park ( gsched, kthread );
+	fair_release_first ( gsched );
+
+	return 1;
+}
+
+/*! Compare threads by virtual runtime (then by address, to be unique) */
+static int fair_cmp ( void *a, void *b )
+{
+	kthread_sched_data_t *ta = kthread_get_sched_param ( a );
+	kthread_sched_data_t *tb = kthread_get_sched_param ( b );
+
+	if ( ta->params.fair.vruntime < tb->params.fair.vruntime )
+		return -1;
+	if ( ta->params.fair.vruntime > tb->params.fair.vruntime )
+		return 1;
+
+	return (uint) a < (uint) b ? -1 : ( a != b );
+}
+
+/*! Current time in nanoseconds */
+static uint64 fair_now ()
+{
+	time_t t;
+
+	k_get_time ( &t );
+
+	return (uint64) t.sec * 1000000000 + t.nsec;
+}
+
+static void fair_set_nice ( kthread_t *kthread, int nice )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	uint weight = fair_weights[nice - FAIR_NICE_MIN];
+
+	tsched->params.fair.nice = nice;
+	tsched->params.fair.weight = weight;
+	tsched->params.fair.vfactor = ( NICE_0_WEIGHT << VFACTOR_SHIFT ) / weight;
+}
+
+/*! Advance minimal virtual runtime (never goes back) */
+static void fair_update_min ( ksched_t *gsched, uint64 vruntime )
+{
+	kthread_t *first = avl_first ( &gsched->params.fair.tree );
+	uint64 v;
+
+	if ( first )
+	{
+		v = kthread_get_sched_param ( first )->params.fair.vruntime;
+		if ( v < vruntime )
+			vruntime = v;
+	}
+
+	if ( vruntime > gsched->params.fair.min_vruntime )
+		gsched->params.fair.min_vruntime = vruntime;
+}
+
+/*! Take thread from primary scheduler, put it in tree */
+static void fair_park ( ksched_t *gsched, kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	kthread_enqueue ( kthread, &gsched->params.fair.parked );
+	avl_insert ( &gsched->params.fair.tree, kthread,
+		     &tsched->params.fair.node );
+	tsched->params.fair.parked = 1;
+}
+
+/*! Give thread with smallest virtual runtime to primary scheduler */
+static void fair_release_first ( ksched_t *gsched )
+{
+	kthread_t *first = avl_first ( &gsched->params.fair.tree );
+	kthread_sched_data_t *tsched;
+
+	if ( !first )
+		return;
+
+	tsched = kthread_get_sched_param ( first );
+
+	avl_remove ( &gsched->params.fair.tree, &tsched->params.fair.node );
+	kthreadq_unlink ( &gsched->params.fair.parked, first );
+	tsched->params.fair.parked = 0;
+
+	kthread_move_to_ready ( first, LAST );
+}
@@ -0,0 +1,45 @@
+/*! Fair share scheduler (threads ordered by weighted virtual runtime) */
+
+#pragma once
+
+#ifdef _KERNEL_
+
+#include <lib/types.h>
+#include <lib/avl.h>
+#include <kernel/thread.h>
+
+/*! Per thread scheduler data */
+typedef struct _ksched_fair_thread_params_t_
+{
+	uint64 vruntime;	/* consumed processor time [ns], weighted */
+	uint64 exec_start;	/* when thread was activated [ns] */
+	uint weight;		/* weight derived from nice value */
+	uint vfactor;		/* NICE_0_WEIGHT / weight, fixed point (16b) */
+	int nice;
+
+	int sleeping;		/* blocked - not counted in load */
+	int parked;		/* in tree, waiting for its turn */
+	int expired;		/* time slice elapsed */
+
+	avl_node_t node;	/* node in 'ksched_fair_t.tree' */
+}
+ksched_fair_thread_params_t;
+
+/*! Fair share global parameters */
+typedef struct _ksched_fair_t_
+{
+	avl_tree_t tree;	/* ready threads not given to primary scheduler */
+	kthread_q parked;	/* same threads, "blocked" for primary scheduler */
+
+	uint64 min_vruntime;	/* monotonic; start value for new threads */
+	uint load;		/* sum of weights of ready threads */
+
+	uint latency;		/* target period for all ready threads [us] */
+	uint min_granularity;	/* shortest time slice [us] */
+
+	void *fair_alarm;	/* kernel alarm reference (slice end) */
+	alarm_t alarm;		/* alarm parameters */
+}
+ksched_fair_t;
+
+#endif /* _KERNEL_ */
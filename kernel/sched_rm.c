@@ -0,0 +1,492 @@
+/*! Rate (deadline) monotonic Scheduler
+ *
+ * Periodic threads (which declared period, relative deadline and worst case
+ * execution time with RM_SET) get fixed priorities from band reserved for this
+ * scheduler (RM_PRIO_LOW - RM_PRIO_HIGH): shorter min(deadline, period) gets
+ * higher priority (deadline monotonic, same as rate monotonic when deadlines
+ * are equal to periods). Priorities are recalculated when new thread is
+ * admitted; if there are more different periods than levels in band, longest
+ * ones share lowest level.
+ *
+ * Other threads can't get priorities from this band.
+ *
+ * Deadline must not be longer than period: response time analysis below checks
+ * only first job of each thread, which is enough only when every job ends
+ * before next one is released (D <= T).
+ *
+ * Thread is admitted only if response time of every periodic thread remains
+ * within its deadline (response time analysis with priorities that would be
+ * assigned; threads with same priority are counted as higher priority ones,
+ * as they are served in FIFO order).
+ *
+ * Job ends with RM_WAIT: thread waits (in 'wait' queue) until next period
+ * starts. All threads waiting for next period are in 'release_heap' and only
+ * one kernel alarm is used, set to earliest release time.
+ */
+#define _KERNEL_
+
+#include <kernel/sched.h>	/* includes "sched_rm.h" */
+#include <kernel/time.h>
+#include <kernel/errno.h>
+#include <lib/types.h>
+#include <lib/bits.h>
+
+/* time in microseconds */
+#define TIME_US(T)	( (int64) (T).sec * 1000000 + (T).nsec / 1000 )
+
+#define PPM			1000000	/* utilization 1 [parts per million] */
+#define RM_RTA_ITERATIONS	1000	/* max. iterations for one response */
+
+static int rm_init ( ksched_t *self );
+static int rm_thread_add ( kthread_t *kthread );
+static int rm_thread_remove ( kthread_t *kthread );
+static int rm_set_thread_sched_parameters ( kthread_t *kthread,
+					    sched_t *params );
+static int rm_get_thread_sched_parameters ( kthread_t *kthread,
+					    sched_t *params );
+
+static int rm_admit ( kthread_t *kthread, sched_t *params );
+static void rm_leave ( kthread_t *kthread );
+static int rm_reserve ();
+static int rm_schedulable ();
+static void rm_levels ();
+static void rm_assign_prio ();
+static int rm_cmp ( void *a, void *b );
+static int rm_release_cmp ( void *a, void *b );
+
+static void rm_timer ( void *p );
+static void rm_timer_update ();
+static void rm_release ( kthread_t *kthread );
+
+/*! staticaly defined Rate Monotonic Scheduler */
+ksched_t ksched_rm = (ksched_t)
+{
+	.sched_id =		SCHED_RM,
+
+	.init = 		rm_init,
+	.thread_add =		rm_thread_add,
+	.thread_remove =	rm_thread_remove,
+
+	.set_thread_sched_parameters =	rm_set_thread_sched_parameters,
+	.get_thread_sched_parameters =	rm_get_thread_sched_parameters,
+};
+
+/*! Init RM scheduler */
+static int rm_init ( ksched_t *self )
+{
+	ksched_rm_t *rm = &self->params.rm;
+	alarm_t alarm;
+
+	ASSERT ( self == &ksched_rm );
+
+	list_init ( &rm->tasks );
+	rm->utilization = 0;
+
+	kthreadq_init ( &rm->wait );
+	rm->release_nodes = kmalloc ( RM_HEAP_INITIAL * sizeof (heap_node_t *) );
+	ASSERT ( rm->release_nodes );
+	heap_init ( &rm->release_heap, rm->release_nodes, RM_HEAP_INITIAL,
+		    rm_release_cmp );
+	rm->threads = 0;
+
+	/* reserve an empty alarm (for releases) */
+	alarm.action = rm_timer;
+	alarm.param = NULL;
+	alarm.flags = 0;
+	alarm.period.sec = alarm.period.nsec = 0;
+	alarm.exp_time.sec = alarm.exp_time.nsec = 0;
+	rm->alarm_exp = alarm.exp_time;
+
+	k_alarm_new ( &rm->rm_alarm, &alarm, KERNELCALL );
+
+	return 0;
+}
+
+/*! Thread is not periodic until RM_SET */
+static int rm_thread_add ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	tsched->params.rm.admitted = 0;
+	tsched->params.rm.prio = kthread_get_prio ( kthread );
+	heap_node_init ( &tsched->params.rm.release_node );
+
+	return 0;
+}
+
+/*! Remove thread (canceled or changed scheduling policy) */
+static int rm_thread_remove ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	if ( tsched->params.rm.admitted )
+		rm_leave ( kthread );
+
+	tsched->sched_policy = SCHED_FIFO;
+
+	return 0;
+}
+
+/*!
+ * RM_SET - thread becomes periodic (if admitted), its first job starts now
+ * RM_WAIT - job is done, wait for next period; return -1 if deadline is missed
+ * RM_EXIT - thread is no longer periodic (gets back its priority)
+ */
+static int rm_set_thread_sched_parameters ( kthread_t *kthread,
+					    sched_t *params )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_rm_t *rm = &ksched_rm.params.rm;
+	time_t now;
+	int retval = 0;
+
+	k_get_time ( &now );
+
+	if ( params->rm.flags & RM_SET )
+	{
+		if ( tsched->params.rm.admitted )
+			rm_leave ( kthread );
+
+		tsched->params.rm.prio = kthread_get_prio ( kthread );
+
+		/* room in release heap for one more admitted thread */
+		if ( rm_reserve () )
+			EXIT ( E_NO_MEMORY );
+
+		if ( !rm_admit ( kthread, params ) )
+		{
+			LOG( DEBUG, "%x [RM not admitted]", kthread );
+			EXIT ( E_NOT_SCHEDULABLE );
+		}
+
+		tsched->params.rm.period = params->rm.period;
+		tsched->params.rm.relative_deadline = params->rm.deadline;
+		tsched->params.rm.next_run = now;
+		tsched->params.rm.active_deadline = now;
+		time_add ( &tsched->params.rm.active_deadline,
+			   &params->rm.deadline );
+
+		rm_assign_prio ();
+	}
+	else if ( params->rm.flags & RM_WAIT )
+	{
+		ASSERT_ERRNO_AND_EXIT ( kthread == kthread_get_active () &&
+					tsched->params.rm.admitted,
+					E_INVALID_ARGUMENT );
+
+		if ( time_cmp ( &now, &tsched->params.rm.active_deadline ) > 0 )
+		{
+			LOG( DEBUG, "%x [RM DEADLINE MISSED]", kthread );
+			kthread_set_errno ( kthread, -E_DEADLINE );
+			retval = -1;
+		}
+
+		/* next job */
+		time_add ( &tsched->params.rm.next_run,
+			   &tsched->params.rm.period );
+		tsched->params.rm.active_deadline = tsched->params.rm.next_run;
+		time_add ( &tsched->params.rm.active_deadline,
+			   &tsched->params.rm.relative_deadline );
+
+		if ( time_cmp ( &tsched->params.rm.next_run, &now ) > 0 )
+		{
+			kthread_enqueue ( kthread, &rm->wait );
+			if ( heap_insert ( &rm->release_heap, kthread,
+					   &tsched->params.rm.release_node ) )
+				ASSERT ( FALSE ); /* reserved in RM_SET */
+			rm_timer_update ();
+			kthreads_schedule ();
+		}
+		/* else: late - next job is already released */
+	}
+	else if ( params->rm.flags & RM_EXIT )
+	{
+		if ( tsched->params.rm.admitted )
+			rm_leave ( kthread );
+	}
+
+	return retval;
+}
+
+static int rm_get_thread_sched_parameters ( kthread_t *kthread,
+					    sched_t *params )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	params->rm.period = tsched->params.rm.period;
+	params->rm.deadline = tsched->params.rm.relative_deadline;
+	params->rm.wcet.sec = tsched->params.rm.c / 1000000;
+	params->rm.wcet.nsec = ( tsched->params.rm.c % 1000000 ) * 1000;
+	params->rm.flags = tsched->params.rm.admitted ? RM_SET : 0;
+
+	return 0;
+}
+
+/*!
+ * Add thread to periodic ones if all remain schedulable
+ * \return 1 if thread is admitted, 0 otherwise
+ */
+static int rm_admit ( kthread_t *kthread, sched_t *params )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_rm_t *rm = &ksched_rm.params.rm;
+	uint32 u;
+
+	if ( TIME_US ( params->rm.wcet ) <= 0 ||
+	     TIME_US ( params->rm.period ) <= 0 ||
+	     TIME_US ( params->rm.deadline ) <= 0 ||
+	     TIME_US ( params->rm.period ) > 0x7fffffff ||
+	     TIME_US ( params->rm.deadline ) > TIME_US ( params->rm.period ) ||
+	     TIME_US ( params->rm.wcet ) > TIME_US ( params->rm.deadline ) )
+		return 0;
+
+	tsched->params.rm.c = TIME_US ( params->rm.wcet );
+	tsched->params.rm.t = TIME_US ( params->rm.period );
+	tsched->params.rm.d = TIME_US ( params->rm.deadline );
+
+	u = mul_div_32 ( tsched->params.rm.c, PPM, tsched->params.rm.t );
+	if ( rm->utilization + u > PPM )
+		return 0;
+
+	list_sort_add ( &rm->tasks, kthread, &tsched->params.rm.list, rm_cmp );
+
+	if ( !rm_schedulable () )
+	{
+		list_remove ( &rm->tasks, FIRST, &tsched->params.rm.list );
+		return 0;
+	}
+
+	rm->utilization += u;
+	rm->threads++;
+	tsched->params.rm.admitted = 1;
+
+	return 1;
+}
+
+/*! Thread is no longer periodic */
+static void rm_leave ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_rm_t *rm = &ksched_rm.params.rm;
+
+	list_remove ( &rm->tasks, FIRST, &tsched->params.rm.list );
+	rm->utilization -= mul_div_32 ( tsched->params.rm.c, PPM,
+					tsched->params.rm.t );
+	rm->threads--;
+	tsched->params.rm.admitted = 0;
+
+	if ( heap_node_in_heap ( &tsched->params.rm.release_node ) )
+	{
+		heap_remove ( &rm->release_heap,
+			      &tsched->params.rm.release_node );
+		rm_timer_update ();
+
+		/* still in 'wait' queue if not canceled */
+		if ( kthreadq_remove ( &rm->wait, kthread ) )
+			kthread_move_to_ready ( kthread, LAST );
+	}
+
+	/* others keep their order (gaps are removed on next admission) */
+	kthread_set_prio ( kthread, tsched->params.rm.prio );
+}
+
+/*!
+ * Make sure release heap has room for one more admitted thread (each admitted
+ * thread is at most once in it, so later insertions can't fail)
+ * \return 0 if successful, -1 if there isn't enough memory
+ */
+static int rm_reserve ()
+{
+	ksched_rm_t *rm = &ksched_rm.params.rm;
+	heap_node_t **nodes;
+	int max;
+
+	if ( rm->threads < rm->release_heap.max )
+		return 0;
+
+	max = rm->release_heap.max * 2;
+	nodes = kmalloc ( max * sizeof (heap_node_t *) );
+	if ( !nodes )
+		return -1;
+
+	heap_resize ( &rm->release_heap, nodes, max );
+	kfree ( rm->release_nodes );
+	rm->release_nodes = nodes;
+
+	return 0;
+}
+
+/*!
+ * Response time analysis: R = C + sum ( ceil ( R / Tj ) * Cj ), for all
+ * threads j with higher or same priority level (as assigned from band, where
+ * longest ones might share lowest level); iterated until R doesn't change
+ * \return 1 if response time of every admitted thread is within deadline
+ */
+static int rm_schedulable ()
+{
+	ksched_rm_t *rm = &ksched_rm.params.rm;
+	kthread_t *ki, *kj;
+	ksched_rm_thread_params_t *ti, *tj;
+	uint64 w;
+	uint32 r;
+	int i;
+
+	rm_levels ();
+
+	for ( ki = list_get ( &rm->tasks, FIRST ); ki;
+	      ki = list_get_next ( &ti->list ) )
+	{
+		ti = &kthread_get_sched_param ( ki )->params.rm;
+		r = ti->c;
+
+		for ( i = 0; ; i++ )
+		{
+			if ( i == RM_RTA_ITERATIONS )
+				return 0;
+
+			w = ti->c;
+			for ( kj = list_get ( &rm->tasks, FIRST ); kj;
+			      kj = list_get_next ( &tj->list ) )
+			{
+				tj = &kthread_get_sched_param ( kj )->params.rm;
+				if ( kj != ki && tj->level >= ti->level )
+					w += (uint64) ( ( r + tj->t - 1 ) /
+							tj->t ) * tj->c;
+			}
+
+			if ( w > ti->d )
+				return 0;
+			if ( w == r )
+				break;
+
+			r = w;
+		}
+	}
+
+	return 1;
+}
+
+/*! Calculate priorities from band by order in 'tasks' */
+static void rm_levels ()
+{
+	ksched_rm_t *rm = &ksched_rm.params.rm;
+	kthread_t *kthread, *prev = NULL;
+	ksched_rm_thread_params_t *tp;
+	int prio = RM_PRIO_HIGH;
+
+	for ( kthread = list_get ( &rm->tasks, FIRST ); kthread;
+	      kthread = list_get_next ( &tp->list ) )
+	{
+		tp = &kthread_get_sched_param ( kthread )->params.rm;
+
+		if ( prev && rm_cmp ( prev, kthread ) && prio > RM_PRIO_LOW )
+			prio--;
+
+		tp->level = prio;
+		prev = kthread;
+	}
+}
+
+/*! Set priorities from band */
+static void rm_assign_prio ()
+{
+	ksched_rm_t *rm = &ksched_rm.params.rm;
+	kthread_t *kthread;
+	ksched_rm_thread_params_t *tp;
+
+	rm_levels ();
+
+	for ( kthread = list_get ( &rm->tasks, FIRST ); kthread;
+	      kthread = list_get_next ( &tp->list ) )
+	{
+		tp = &kthread_get_sched_param ( kthread )->params.rm;
+
+		if ( kthread_get_prio ( kthread ) != tp->level )
+			kthread_set_prio ( kthread, tp->level );
+	}
+}
+
+/*! Compare threads by min ( deadline, period ) */
+static int rm_cmp ( void *a, void *b )
+{
+	ksched_rm_thread_params_t *ta = &kthread_get_sched_param(a)->params.rm;
+	ksched_rm_thread_params_t *tb = &kthread_get_sched_param(b)->params.rm;
+	uint32 ka = ta->d < ta->t ? ta->d : ta->t;
+	uint32 kb = tb->d < tb->t ? tb->d : tb->t;
+
+	return ka < kb ? -1 : ( ka > kb );
+}
+
+static int rm_release_cmp ( void *a, void *b )
+{
+	return time_cmp ( &kthread_get_sched_param ( a )->params.rm.next_run,
+			  &kthread_get_sched_param ( b )->params.rm.next_run );
+}
+
+/*! Release all threads whose next period started */
+static void rm_timer ( void *p )
+{
+	ksched_rm_t *rm = &ksched_rm.params.rm;
+	kthread_t *kthread;
+	time_t ref;
+	int released = 0;
+
+	/* alarm might be activated bit before its time */
+	k_get_time ( &ref );
+	if ( time_cmp ( &ref, &rm->alarm_exp ) < 0 )
+		ref = rm->alarm_exp;
+	rm->alarm_exp.sec = rm->alarm_exp.nsec = 0;
+
+	while ( ( kthread = heap_first ( &rm->release_heap ) ) )
+	{
+		if ( time_cmp ( &kthread_get_sched_param ( kthread )->
+				params.rm.next_run, &ref ) > 0 )
+			break;
+
+		rm_release ( kthread );
+		released = 1;
+	}
+
+	rm_timer_update ();
+
+	if ( released )
+		kthreads_schedule ();
+}
+
+/*! Set alarm to first release time (if it is changed) */
+static void rm_timer_update ()
+{
+	ksched_rm_t *rm = &ksched_rm.params.rm;
+	kthread_t *kthread;
+	alarm_t alarm;
+
+	alarm.exp_time.sec = alarm.exp_time.nsec = 0;
+
+	kthread = heap_first ( &rm->release_heap );
+	if ( kthread )
+		alarm.exp_time =
+			kthread_get_sched_param ( kthread )->params.rm.next_run;
+
+	if ( !time_cmp ( &alarm.exp_time, &rm->alarm_exp ) )
+		return;
+
+	rm->alarm_exp = alarm.exp_time;
+
+	alarm.action = rm_timer;
+	alarm.param = NULL;
+	alarm.flags = 0;
+	alarm.period.sec = alarm.period.nsec = 0;
+
+	k_alarm_set ( rm->rm_alarm, &alarm );
+}
+
+/*! Start next job: move thread from 'wait' to ready */
+static void rm_release ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	ksched_rm_t *rm = &ksched_rm.params.rm;
+
+	heap_remove ( &rm->release_heap, &tsched->params.rm.release_node );
+	kthreadq_unlink ( &rm->wait, kthread );
+	kthread_move_to_ready ( kthread, LAST );
+}
@@ -0,0 +1,55 @@
+/*! Rate (deadline) monotonic scheduler */
+
+#pragma once
+
+#ifdef _KERNEL_
+
+#include <lib/types.h>
+#include <lib/list.h>
+#include <lib/heap.h>
+#include <kernel/thread.h>
+
+/*! Priorities reserved for periodic threads (upper half) */
+#define RM_PRIO_HIGH	( PRIO_LEVELS - 1 )
+#define RM_PRIO_LOW	PRIO_RM_BAND
+#define RM_PRIO_LEVELS	( RM_PRIO_HIGH - RM_PRIO_LOW + 1 )
+
+/* initial size of release heap (doubled when more threads are admitted) */
+#define RM_HEAP_INITIAL	16
+
+/*! Per thread scheduler data */
+typedef struct _ksched_rm_thread_params_t_
+{
+	time_t period;
+	time_t relative_deadline;
+	time_t next_run;	/* release time of next (or current) job */
+	time_t active_deadline;	/* deadline of current job */
+
+	uint32 c, t, d;		/* wcet, period, deadline [us] (admission) */
+
+	int admitted;		/* periodic thread (in 'ksched_rm_t.tasks') */
+	int prio;		/* priority before thread become periodic */
+	int level;		/* priority from band (set by rm_levels) */
+
+	list_h list;		/* in 'tasks' */
+	heap_node_t release_node; /* in 'release_heap' (waiting next period) */
+}
+ksched_rm_thread_params_t;
+
+/*! RM scheduler global parameters */
+typedef struct _ksched_rm_t_
+{
+	list_t tasks;		/* admitted threads, highest priority first */
+	uint32 utilization;	/* their total utilization [ppm] */
+
+	kthread_q wait;		/* threads waiting for next period */
+	heap_t release_heap;	/* same threads, by release time */
+	heap_node_t **release_nodes;
+	int threads;		/* admitted threads (each once in heap at most) */
+
+	void *rm_alarm;		/* kernel alarm for releases */
+	time_t alarm_exp;	/* when it is set to expire (0 if not set) */
+}
+ksched_rm_t;
+
+#endif /* _KERNEL_ */
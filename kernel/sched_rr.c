@@ -1,4 +1,13 @@
-/*! Round Robin Scheduler */
+/*! Round Robin Scheduler
+ *
+ * Each thread gets its quantum (thread's own, if set, or scheduler's). Only one
+ * kernel alarm is used for all RR threads and it is set lazily: when thread is
+ * activated alarm is reprogrammed only if it is not armed or is armed to fire
+ * after that thread's slice end. Deactivation doesn't remove alarm: when it
+ * fires before active RR thread's slice end (or when active thread isn't RR
+ * thread) it is just rearmed (or left unarmed). Thread switches within slice
+ * (blocking, preemption) usually don't touch alarm list at all.
+ */
 #define _KERNEL_
 
 #include "sched_rr.h"
@@ -18,6 +27,9 @@ static int rr_thread_activate ( kthread_t *kthread );
 static void rr_timer ( void *p );
 static int rr_thread_deactivate ( kthread_t *kthread );
 
+static time_t *rr_time_slice ( kthread_t *kthread );
+static void rr_timer_set ( time_t *exp_time );
+
 /*! staticaly defined Round Robin Scheduler */
 ksched_t ksched_rr = (ksched_t)
 {
@@ -51,6 +63,7 @@ static int rr_init ( ksched_t *self )
 	self->params.rr.alarm.action = rr_timer;
 	self->params.rr.alarm.param = NULL;
 	self->params.rr.alarm.flags = 0;
+	self->params.rr.alarm_exp = self->params.rr.alarm.exp_time;
 
 	k_alarm_new ( &self->params.rr.rr_alarm, &self->params.rr.alarm,
 		      KERNELCALL );
@@ -62,43 +75,68 @@ static int rr_init ( ksched_t *self )
 static int rr_thread_add ( kthread_t *kthread )
 {
 	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
-	ksched_t *gsched = ksched_get ( tsched->sched_policy );
 
-	tsched->params.rr.remainder = gsched->params.rr.time_slice;
+	tsched->params.rr.time_slice.sec = tsched->params.rr.time_slice.nsec = 0;
+	tsched->params.rr.remainder = *rr_time_slice ( kthread );
 
 	return 0;
 }
+
+/*!
+ * Remove thread from RR scheduler (canceled or changed scheduling policy);
+ * alarm, if armed for it, will find that active thread is no longer RR thread
+ */
 static int rr_thread_remove ( kthread_t *kthread )
 {
-	/* TODO */
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	tsched->params.rr.remainder.sec = tsched->params.rr.remainder.nsec = 0;
+
 	return 0;
 }
 
+/*! Set global time slice (must be longer than threshold) */
 static int rr_set_sched_parameters ( int sched_policy, sched_t *params )
 {
 	ksched_t *gsched = ksched_get ( sched_policy );
 
+	ASSERT_ERRNO_AND_EXIT ( time_cmp ( &params->rr.time_slice,
+					   &gsched->params.rr.threshold ) > 0,
+				E_INVALID_ARGUMENT );
+
 	gsched->params.rr.time_slice = params->rr.time_slice;
 
 	return 0;
 }
 static int rr_get_sched_parameters ( int sched_policy, sched_t *params )
 {
-	/* TODO */
+	ksched_t *gsched = ksched_get ( sched_policy );
+
+	params->rr.time_slice = gsched->params.rr.time_slice;
+
 	return 0;
 }
 
+/*! Set thread's quantum (zero to use global time slice) */
 static int rr_set_thread_sched_parameters (kthread_t *kthread, sched_t *params)
 {
-	/* Nothing to set for thread! Just as an example - set to global RR */
-	ksched_rr.params.rr.time_slice = params->rr.time_slice;
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	ASSERT_ERRNO_AND_EXIT ( !( params->rr.time_slice.sec +
+				   params->rr.time_slice.nsec ) ||
+				time_cmp ( &params->rr.time_slice,
+					   &ksched_rr.params.rr.threshold ) > 0,
+				E_INVALID_ARGUMENT );
+
+	tsched->params.rr.time_slice = params->rr.time_slice;
 
 	return 0;
 }
 
 static int rr_get_thread_sched_parameters (kthread_t *kthread, sched_t *params)
 {
-	/* TODO */
+	params->rr.time_slice = *rr_time_slice ( kthread );
+
 	return 0;
 }
 
@@ -113,7 +151,7 @@ static int rr_thread_activate ( kthread_t *kthread )
 		&gsched->params.rr.threshold ) <= 0 )
 	{
 		time_add ( &tsched->params.rr.remainder,
-			   &gsched->params.rr.time_slice );
+			   rr_time_slice ( kthread ) );
 	}
 
 	/* Get current time and store it */
@@ -123,11 +161,12 @@ static int rr_thread_activate ( kthread_t *kthread )
 	tsched->params.rr.slice_end = tsched->params.rr.slice_start;
 	time_add ( &tsched->params.rr.slice_end, &tsched->params.rr.remainder );
 
-	/* Set alarm for remainder time */
-	gsched->params.rr.alarm.exp_time = tsched->params.rr.slice_end;
-	gsched->params.rr.alarm.param = kthread;
-
-	k_alarm_set ( gsched->params.rr.rr_alarm, &gsched->params.rr.alarm );
+	/* armed alarm that fires before slice end is good enough */
+	if ( !( gsched->params.rr.alarm_exp.sec +
+		gsched->params.rr.alarm_exp.nsec ) ||
+	     time_cmp ( &gsched->params.rr.alarm_exp,
+			&tsched->params.rr.slice_end ) > 0 )
+		rr_timer_set ( &tsched->params.rr.slice_end );
 
 	return 0;
 }
@@ -135,17 +174,27 @@ static int rr_thread_activate ( kthread_t *kthread )
 /*! Timer interrupt for Round Robin */
 static void rr_timer ( void *p )
 {
-	kthread_t *kthread = p;
-	kthread_sched_data_t *tsched;
+	kthread_t *kthread = kthread_get_active ();
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+	time_t ref;
+
+	/* alarm might be activated bit before its time */
+	k_get_time ( &ref );
+	if ( time_cmp ( &ref, &ksched_rr.params.rr.alarm_exp ) < 0 )
+		ref = ksched_rr.params.rr.alarm_exp;
+	ksched_rr.params.rr.alarm_exp.sec = 0;
+	ksched_rr.params.rr.alarm_exp.nsec = 0;
 
-	if ( kthread_get_active () != kthread )
+	if ( tsched->sched_policy != SCHED_RR || !tsched->activated )
+		return; /* RR thread blocked, got preempted or canceled */
+
+	if ( time_cmp ( &tsched->params.rr.slice_end, &ref ) > 0 )
 	{
-		/* bug or rr thread got canceled! Let asume second :) */
+		/* alarm was set for some previous thread */
+		rr_timer_set ( &tsched->params.rr.slice_end );
 		return;
 	}
 
-	tsched = kthread_get_sched_param ( kthread );
-
 	/* given time is elapsed, set remainder to zero */
 	tsched->params.rr.remainder.sec = tsched->params.rr.remainder.nsec = 0;
 
@@ -172,12 +221,20 @@ static int rr_thread_deactivate ( kthread_t *kthread )
 	{
 		/*
 		 * "slice interrupted"
-		 * recalculate remainder
-		 * TODO: remove alarm!!!
+		 * recalculate remainder (alarm is left as is)
 		 */
 		k_get_time ( &t );
-		time_sub ( &tsched->params.rr.slice_end, &t );
-		tsched->params.rr.remainder = tsched->params.rr.slice_end;
+		if ( time_cmp ( &tsched->params.rr.slice_end, &t ) > 0 )
+		{
+			time_sub ( &tsched->params.rr.slice_end, &t );
+			tsched->params.rr.remainder =
+				tsched->params.rr.slice_end;
+		}
+		else {
+			/* alarm is late, slice is used */
+			tsched->params.rr.remainder.sec = 0;
+			tsched->params.rr.remainder.nsec = 0;
+		}
 
 		if ( kthread_is_ready ( kthread ) )
 		{
@@ -197,3 +254,26 @@ static int rr_thread_deactivate ( kthread_t *kthread )
 	return 0;
 }
 
+/*! Thread's quantum */
+static time_t *rr_time_slice ( kthread_t *kthread )
+{
+	kthread_sched_data_t *tsched = kthread_get_sched_param ( kthread );
+
+	if ( tsched->params.rr.time_slice.sec +
+	     tsched->params.rr.time_slice.nsec )
+		return &tsched->params.rr.time_slice;
+	else
+		return &ksched_rr.params.rr.time_slice;
+}
+
+/*! (Re)arm alarm */
+static void rr_timer_set ( time_t *exp_time )
+{
+	ksched_rr_t *rr = &ksched_rr.params.rr;
+
+	rr->alarm_exp = *exp_time;
+	rr->alarm.exp_time = *exp_time;
+	rr->alarm.param = NULL;
+
+	k_alarm_set ( rr->rr_alarm, &rr->alarm );
+}
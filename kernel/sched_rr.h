@@ -9,6 +9,7 @@
 /*! Per thread scheduler data */
 typedef struct _ksched_rr_thread_params_
 {
+	time_t time_slice;	/* thread's quantum (zero - use global one) */
 	time_t slice_start;
 	time_t slice_end;
 	time_t remainder;
@@ -24,6 +25,7 @@ typedef struct _ksched_rr_t_
 				   next one */
 	void *rr_alarm;		/* kernel alarm reference used in RR */
 	alarm_t alarm;		/* alarm parameters */
+	time_t alarm_exp;	/* when alarm is armed to fire (0 if not) */
 }
 ksched_rr_t;
 
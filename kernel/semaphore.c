@@ -10,16 +10,24 @@
 #include <kernel/errno.h>
 #include <lib/types.h>
 
-/*! Initialize new semaphore with initial value */
+/*!
+ * Initialize new semaphore with initial value
+ * \param sem Semaphore descriptor (user level descriptor)
+ * \param initial_value Initial semaphore value
+ * \param flags Order of releasing blocked threads (THRQ_FIFO or THRQ_PRIO)
+ */
 int sys__sem_init ( void *p )
 {
 	sem_t *sem;
 	int initial_value;
+	uint flags;
 	ksem_t *ksem;
 
 	sem = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
 	p += sizeof (void *);
 	initial_value = *( (int *) p );
+	p += sizeof (int);
+	flags = *( (uint *) p );
 
 	ASSERT_ERRNO_AND_EXIT ( sem, E_INVALID_HANDLE );
 
@@ -27,9 +35,15 @@ int sys__sem_init ( void *p )
 	ASSERT ( ksem );
 
 	ksem->sem_value = initial_value;
-	kthreadq_init ( &ksem->queue );
+	kthreadq_init_ordered ( &ksem->queue, flags & THRQ_PRIO );
 
-	sem->ptr = ksem;
+	sem->id = k_handle_new ( ksem, HANDLE_SEM );
+	if ( !sem->id )
+	{
+		kthreadq_destroy ( &ksem->queue );
+		kfree ( ksem );
+		EXIT ( E_NO_MEMORY );
+	}
 
 	EXIT ( SUCCESS );
 }
@@ -42,15 +56,18 @@ int sys__sem_destroy ( void *p )
 
 	sem = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
 
-	ASSERT_ERRNO_AND_EXIT ( sem && sem->ptr, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( sem, E_INVALID_HANDLE );
 
-	ksem = sem->ptr;
+	ksem = k_handle_get ( sem->id, HANDLE_SEM );
+	ASSERT_ERRNO_AND_EXIT ( ksem, E_INVALID_HANDLE );
 
 	if ( kthreadq_release_all ( &ksem->queue ) )
 		kthreads_schedule ();
 
+	k_handle_free ( sem->id );
+	kthreadq_destroy ( &ksem->queue );
 	kfree ( ksem );
-	sem->ptr = NULL;
+	sem->id = 0;
 
 	EXIT ( SUCCESS );
 }
@@ -63,9 +80,10 @@ int sys__sem_post ( void *p )
 
 	sem = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
 
-	ASSERT_ERRNO_AND_EXIT ( sem && sem->ptr, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( sem, E_INVALID_HANDLE );
 
-	ksem = sem->ptr;
+	ksem = k_handle_get ( sem->id, HANDLE_SEM );
+	ASSERT_ERRNO_AND_EXIT ( ksem, E_INVALID_HANDLE );
 
 	SET_ERRNO ( SUCCESS );
 
@@ -85,9 +103,10 @@ int sys__sem_wait ( void *p )
 
 	sem = U2K_GET_ADR ( *( (void **) p ), kthread_get_process (NULL) );
 
-	ASSERT_ERRNO_AND_EXIT ( sem && sem->ptr, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( sem, E_INVALID_HANDLE );
 
-	ksem = sem->ptr;
+	ksem = k_handle_get ( sem->id, HANDLE_SEM );
+	ASSERT_ERRNO_AND_EXIT ( ksem, E_INVALID_HANDLE );
 
 	SET_ERRNO ( SUCCESS );
 
@@ -4,6 +4,8 @@
 #include <arch/interrupts.h>
 #include <kernel/time.h>
 #include <kernel/thread.h>
+#include <kernel/futex.h>
+#include <kernel/trace.h>
 #include <kernel/syscall.h>
 #include <kernel/devices.h>
 #include <kernel/memory.h>
@@ -47,6 +49,10 @@ void k_startup ( unsigned long magic, unsigned long addr )
 	/* detect memory faults (qemu do not detect segment violations!) */
 	arch_register_interrupt_handler ( INT_STF, k_memory_fault, NULL );
 	arch_register_interrupt_handler ( INT_GPF, k_memory_fault, NULL );
+#ifdef PAGING
+	/* add process pages on demand */
+	arch_register_interrupt_handler ( INT_PF, k_page_fault, NULL );
+#endif
 
 	/* timer subsystem */
 	k_time_init ();
@@ -61,6 +67,14 @@ void k_startup ( unsigned long magic, unsigned long addr )
 
 	kprint ( "%s\n", system_info );
 
+#ifdef TRACE
+	/* event trace (sent through TRACE_DEVICE) */
+	k_trace_init ();
+#endif
+
+	/* wait queues for user level synchronization */
+	k_futex_init ();
+
 	/* thread subsystem */
 	kthreads_init ();
 
@@ -68,7 +82,7 @@ void k_startup ( unsigned long magic, unsigned long addr )
 	if ( !kthread_start_process ( K_INIT_PROG, NULL, 0 ) )
 	{
 		LOG ( ERROR, "\nAborting!\n" );
-		halt();
+		PANIC_HALT ();
 	}
 
 	if ( strcmp ( U_STDIN, "i8042" ) == 0 )
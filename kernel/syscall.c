@@ -12,11 +12,15 @@
 #include <kernel/time.h>
 #include <kernel/semaphore.h>
 #include <kernel/monitor.h>
+#include <kernel/rwlock.h>
+#include <kernel/barrier.h>
+#include <kernel/futex.h>
 #include <kernel/devices.h>
 #include <kernel/memory.h>
 #include <kernel/messages.h>
 
 #include <kernel/errno.h>
+#include <kernel/trace.h>
 
 /*! syscall handlers */
 static int (*k_sysfunc[SYSFUNCS]) ( void *params ) =
@@ -29,6 +33,8 @@ static int (*k_sysfunc[SYSFUNCS]) ( void *params ) =
 	sys__cancel_thread,
 	sys__thread_self,
 	sys__start_program,
+	sys__thread_stats,
+	sys__thread_yield,
 
 	sys__set_sched_params,
 	sys__get_sched_params,
@@ -60,6 +66,19 @@ static int (*k_sysfunc[SYSFUNCS]) ( void *params ) =
 	sys__monitor_signal,
 	sys__monitor_broadcast,
 
+	sys__rwlock_init,
+	sys__rwlock_destroy,
+	sys__rwlock_rdlock,
+	sys__rwlock_wrlock,
+	sys__rwlock_unlock,
+
+	sys__barrier_init,
+	sys__barrier_destroy,
+	sys__barrier_wait,
+
+	sys__futex_wait,
+	sys__futex_wake,
+
 	sys__device_send,
 	sys__device_recv,
 	sys__device_open,
@@ -75,6 +94,8 @@ static int (*k_sysfunc[SYSFUNCS]) ( void *params ) =
 	sys__msg_post,
 	sys__msg_recv,
 
+	sys__process_extend,
+
 	sys__sysinfo,
 
 	sys__suspend
@@ -99,15 +120,34 @@ void k_syscall ( uint irqn )
 
 	params = arch_syscall_get_params ( context );
 
+	if ( id != SUSPEND ) /* idle thread is not traced */
+		TRACE_EVENT ( TRACE_SYSCALL_ENTER, id );
+
 	retval = k_sysfunc[id] ( params );
 
 	if ( id != THREAD_EXIT )
 		arch_syscall_set_retval ( context, retval );
+
+	if ( id != SUSPEND )
+		TRACE_EVENT ( TRACE_SYSCALL_EXIT, id );
 }
 
 /*! Stop processor until next interrupt occurs - for idle thread only! */
 int sys__suspend ( void *p )
 {
+	int more;
+
+	/* nothing else to do - send buffered kernel messages (one chunk) */
+	more = kprint_drain ();
+
+#ifdef TRACE
+	/* and trace records (as many as trace device accepts) */
+	k_trace_drain ();
+#endif
+	if ( more > 0 )
+		return 0; /* more to send - don't suspend yet */
+
+	/* buffers are empty or devices are full: wait for interrupt */
 	enable_interrupts ();
 	suspend ();
 
@@ -12,6 +12,8 @@ enum {
 	CANCEL_THREAD,
 	THREAD_SELF,
 	START_PROGRAM,
+	THREAD_STATS,
+	THREAD_YIELD,
 
 	SET_SCHED_PARAMS,
 	GET_SCHED_PARAMS,
@@ -43,6 +45,19 @@ enum {
 	MONITOR_SIGNAL,
 	MONITOR_BROADCAST,
 
+	RWLOCK_INIT,
+	RWLOCK_DESTROY,
+	RWLOCK_RDLOCK,
+	RWLOCK_WRLOCK,
+	RWLOCK_UNLOCK,
+
+	BARRIER_INIT,
+	BARRIER_DESTROY,
+	BARRIER_WAIT,
+
+	FUTEX_WAIT,
+	FUTEX_WAKE,
+
 	DEVICE_SEND,
 	DEVICE_RECV,
 	DEVICE_OPEN,
@@ -58,6 +73,8 @@ enum {
 	SEND_MESG,
 	RECV_MESG,
 
+	PROCESS_EXTEND,
+
 	SYSINFO,
 
 	SUSPEND,
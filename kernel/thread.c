@@ -5,12 +5,15 @@
 #include "thread.h"
 
 #include <arch/interrupts.h>
+#include <arch/descriptors.h>
 #include <arch/syscall.h>
 #include <kernel/memory.h>
 #include <kernel/devices.h>
 #include <kernel/kprint.h>
 #include <kernel/errno.h>
 #include <kernel/sched.h>
+#include <kernel/trace.h>
+#include <kernel/time.h>
 #include <lib/bits.h>
 #include <lib/list.h>
 #include <lib/string.h>
@@ -47,6 +50,8 @@ void kthreads_init ()
 	kernel_proc.stack_pool = NULL;
 	kernel_proc.m.start = NULL;
 	kernel_proc.m.size = (size_t) 0xffffffff;
+	kernel_proc.segm = arch_user_segments_alloc ( kernel_proc.m.start,
+						      kernel_proc.m.size );
 
 	(void) kthread_create ( idle_thread, NULL, NULL, 0, 0, NULL, 0, 1,
 				&kernel_proc );
@@ -88,26 +93,41 @@ kthread_t *kthread_start_process ( char *prog_name, void *param, int prio )
 	proc->prog = prog;
 	proc->m.size = prog->m.size + prog->pi->heap_size + prog->pi->stack_size;
 
-	proc->m.start = proc->pi = kmalloc ( proc->m.size );
+	proc->m.start = proc->pi = k_process_mem_alloc ( proc->m.size );
 
 	if ( !proc->pi )
 	{
 		kprint ( "Not enough memory! (%d)\n", proc->m.size );
-		kfree ( proc->pi );
+		kfree ( proc );
 		return NULL;
 	}
 
+#ifdef PAGING
+	/* kernel writes code, data and thread stacks area: don't fault on it */
+	if ( k_process_mem_map ( proc->pi, prog->m.size ) ||
+	     k_process_mem_map ( (void *) proc->pi + prog->m.size +
+				 prog->pi->heap_size, prog->pi->stack_size ) )
+	{
+		kprint ( "Not enough memory! (%d)\n", proc->m.size );
+		k_process_mem_free ( proc->m.start, proc->m.size );
+		kfree ( proc );
+		return NULL;
+	}
+#endif
+
 	/* copy code and data */
 	memcpy ( proc->pi, prog->pi, prog->m.size );
 
 	/* define heap and stack */
 	proc->pi->heap = (void *) proc->pi + prog->m.size;
 	proc->pi->stack = proc->pi->heap + prog->pi->heap_size;
+#ifndef PAGING /* with paging, pages are zeroed on first access */
 	memset (proc->pi->heap, 0, prog->pi->heap_size + prog->pi->stack_size);
+#endif
 	proc->m.start = proc->pi;
 
-	proc->pi->stdin = u_stdin;
-	proc->pi->stdout = u_stdout;
+	proc->pi->stdin = u_stdin ? HANDLE2PTR ( u_stdin->handle ) : NULL;
+	proc->pi->stdout = u_stdout ? HANDLE2PTR ( u_stdout->handle ) : NULL;
 
 	/* initialize memory pool for threads stacks */
 	proc->stack_pool = ffs_init ( proc->pi->stack, prog->pi->stack_size );
@@ -118,6 +138,8 @@ kthread_t *kthread_start_process ( char *prog_name, void *param, int prio )
 	proc->pi->end_adr = proc->pi->stack + prog->pi->stack_size;
 
 	proc->thr_count = 0;
+	memset ( &proc->acct, 0, sizeof (kacct_t) );
+	proc->segm = arch_user_segments_alloc ( proc->m.start, proc->m.size );
 
 	if ( !prio )
 		prio = proc->pi->prio;
@@ -153,6 +175,13 @@ kthread_t *kthread_start_process ( char *prog_name, void *param, int prio )
 	}
 	kthread = kthread_create ( proc->pi->init, args, NULL, 0, prio,
 				   NULL, 0, 1, proc );
+	if ( !kthread )
+	{
+		arch_user_segments_free ( proc->segm );
+		k_process_mem_free ( proc->m.start, proc->m.size );
+		kfree ( proc );
+		return NULL;
+	}
 
 	list_append ( &procs, proc, &proc->all );
 
@@ -171,6 +200,7 @@ kthread_t *kthread_start_process ( char *prog_name, void *param, int prio )
  * \param stack_size Stack size
  * \param run Move thread descriptor to ready threads?
  * \param proc Process descriptor thread belongs to
+ * \return Thread descriptor, NULL if thread can't be created
  * \return Pointer to descriptor of created kernel thread
  */
 kthread_t *kthread_create ( void *start_func, void *param, void *exit_func,
@@ -178,12 +208,15 @@ kthread_t *kthread_create ( void *start_func, void *param, void *exit_func,
 			    size_t stack_size, int run, kprocess_t *proc )
 {
 	kthread_t *kthread;
+	void *orig_addr;
+	int own_stack = 0; /* 1 - from process pool, 2 - from kernel heap */
 
 	/* if stack is not defined */
 	if ( proc && proc->stack_pool && ( !stack || !stack_size ) )
 	{
 		stack_size = proc->pi->thread_stack;
 		stack = ffs_alloc ( proc->stack_pool, stack_size );
+		own_stack = 1;
 	}
 	else if ( !stack || !stack_size )
 	{
@@ -191,33 +224,62 @@ kthread_t *kthread_create ( void *start_func, void *param, void *exit_func,
 			stack_size = DEFAULT_THREAD_STACK_SIZE;
 
 		stack = kmalloc ( stack_size );
+		own_stack = 2;
 	}
 	ASSERT ( stack && stack_size );
 
-	/* thread descriptor */
-#ifdef USE_SSE
-	kthread = kmalloc ( sizeof (kthread_t) + CONTEXT_ALIGNMENT - 1 );
-	ASSERT ( kthread );
-	void *orig_addr = kthread;
-
-	kthread = (void *) (((uint32) kthread) & 0xfffffff0 );
+	/* thread descriptor (aligned to cache line) */
+	orig_addr = kmalloc ( sizeof (kthread_t) + KTHREAD_ALIGNMENT - 1 );
+	ASSERT ( orig_addr );
+	kthread = (void *) ( ( (aint) orig_addr + KTHREAD_ALIGNMENT - 1 ) &
+			     ~( KTHREAD_ALIGNMENT - 1 ) );
 	kthread->orig_addr = orig_addr;
+
+	/* thread context - in separate block, not to pollute "hot" part */
+#ifdef USE_SSE
+	orig_addr = kmalloc ( sizeof (context_t) + CONTEXT_ALIGNMENT - 1 );
+	ASSERT ( orig_addr );
+	kthread->context = (void *) ( ( (aint) orig_addr + CONTEXT_ALIGNMENT - 1 )
+				      & ~( CONTEXT_ALIGNMENT - 1 ) );
+	kthread->context_orig = orig_addr;
 #else
-	kthread = kmalloc ( sizeof (kthread_t) );
-	ASSERT ( kthread );
+	kthread->context = kmalloc ( sizeof (context_t) );
+	ASSERT ( kthread->context );
 #endif
 
 	/* initialize thread descriptor */
-	kthread->id = k_new_unique_id ();
+	kthread->id = k_handle_new ( kthread, HANDLE_THREAD );
+	if ( !kthread->id )
+	{
+		/* handle table is full (and can't grow) */
+#ifdef USE_SSE
+		kfree ( kthread->context_orig );
+#else
+		kfree ( kthread->context );
+#endif
+		kfree ( kthread->orig_addr );
+
+		if ( own_stack == 1 )
+			ffs_free ( proc->stack_pool, stack );
+		else if ( own_stack == 2 )
+			kfree ( stack );
+
+		return NULL;
+	}
 
 	kthread->state = THR_STATE_PASSIVE;
+	memset ( &kthread->acct, 0, sizeof (kacct_t) );
+	kthread->acct_since = k_get_cycles ();
 
+	/* priorities from PRIO_RM_BAND up are only for periodic (RM) threads;
+	   syscalls reject them, kernel created threads (e.g. for alarms with
+	   'prio + 1') are limited below band */
 	if ( prio < 0 ) prio = 0;
-	if ( prio >= PRIO_LEVELS ) prio = PRIO_LEVELS - 1;
+	if ( prio >= PRIO_RM_BAND ) prio = PRIO_RM_BAND - 1;
 	kthread->prio = prio;
 
 
-	arch_create_thread_context ( &kthread->context, start_func, param,
+	arch_create_thread_context ( kthread->context, start_func, param,
 				     exit_func, stack, stack_size, proc );
 	kthread->queue = NULL;
 	kthread->exit_status = 0;
@@ -252,7 +314,7 @@ kthread_t *kthread_create ( void *start_func, void *param, void *exit_func,
  */
 void kthreads_schedule ()
 {
-	int highest_prio;
+	int highest_prio, preempted;
 	kthread_t *curr, *next;
 
 	curr = active_thread;
@@ -266,6 +328,10 @@ void kthreads_schedule ()
 	if ( !curr || curr->state != THR_STATE_ACTIVE ||
 	     highest_prio > curr->prio )
 	{
+		/* still ready => preempted (involuntary switch) */
+		preempted = curr && ( curr->state == THR_STATE_ACTIVE ||
+				      curr->state == THR_STATE_READY );
+
 		if ( curr ) /* change active thread */
 		{
 			ksched_deactivate_thread ( curr );
@@ -285,14 +351,29 @@ void kthreads_schedule ()
 		if ( kthreadq_get ( &ready_q[highest_prio] ) == NULL )
 			kthread_ready_list_set_empty ( highest_prio );
 
+		TRACE_EVENT ( TRACE_SWITCH, HANDLE_INDEX ( next->id ) );
+
+		if ( curr && curr != next )
+		{
+			if ( preempted )
+				curr->acct.invol_switches++;
+			else if ( curr->state != THR_STATE_PASSIVE )
+				curr->acct.vol_switches++;
+		}
+		kthread_account ( next );
+
 		active_thread = next;
 		active_thread->state = THR_STATE_ACTIVE;
 		active_thread->queue = NULL;
 		ksched_activate_thread ( active_thread );
+
+		/* let process know which of its threads is active */
+		if ( active_thread->proc->pi )
+			active_thread->proc->pi->thread_id = active_thread->id;
 	}
 
 	/* select 'active_thread' context */
-	arch_select_thread ( &active_thread->context );
+	arch_select_thread ( active_thread->context );
 }
 
 /*! operations on thread queues (blocked threads) --------------------------- */
@@ -309,10 +390,56 @@ void kthread_enqueue ( kthread_t *kthread, kthread_q *q )
 	if ( !kthread )
 		kthread = active_thread;
 
+	kthread_account ( kthread );
+
 	kthread->state = THR_STATE_WAIT;
 	kthread->queue = q;
 
-	kthreadq_append ( kthread->queue, kthread );
+	if ( q->flags & THRQ_PRIO )
+		kthreadq_prio_add ( q, kthread );
+	else
+		kthreadq_append ( kthread->queue, kthread );
+}
+
+/*!
+ * Priority ordered queues: higher priority threads are in front, equal
+ * priority threads are kept in FIFO order. Queue remembers last thread of
+ * each non-empty priority level, so new thread is inserted (in constant time)
+ * after last thread of lowest non-empty level with same or higher priority.
+ */
+static void kthreadq_prio_add ( kthread_q *q, kthread_t *kthread )
+{
+	int prio = kthread->prio, i;
+	uint32 mask;
+	list_h *after = NULL;
+
+	i = prio / THRQ_MBITS;
+	mask = q->levels[i] & ( ~0U << ( prio % THRQ_MBITS ) );
+	while ( !mask && ++i < THRQ_MASKS )
+		mask = q->levels[i];
+
+	if ( mask )
+		after = q->tail[ i * THRQ_MBITS + lsb_index ( mask ) ];
+
+	list_insert_after ( &q->q, kthread, &kthread->ql, after );
+
+	q->tail[prio] = &kthread->ql;
+	q->levels[prio / THRQ_MBITS] |= 1U << ( prio % THRQ_MBITS );
+}
+
+/*! Update level tail after thread (that was after 'prev') is removed */
+static void kthreadq_prio_removed ( kthread_q *q, kthread_t *kthread,
+				    list_h *prev )
+{
+	int prio = kthread->prio;
+
+	if ( q->tail[prio] != &kthread->ql )
+		return; /* not last in its level */
+
+	if ( prev && ( (kthread_t *) prev->object )->prio == prio )
+		q->tail[prio] = prev;
+	else
+		q->levels[prio / THRQ_MBITS] &= ~( 1U << ( prio % THRQ_MBITS ) );
 }
 
 /*!
@@ -416,6 +543,17 @@ static void kthread_ready_list_set_empty ( int index )
  */
 void kthread_move_to_ready ( kthread_t *kthread, int where )
 {
+	kthread_account ( kthread );
+
+	if ( kthread->state == THR_STATE_WAIT )
+	{
+		TRACE_EVENT ( TRACE_WAKEUP, HANDLE_INDEX ( kthread->id ) );
+
+		/* secondary scheduler might keep it in its own queue */
+		if ( ksched_wakeup_thread ( kthread ) )
+			return;
+	}
+
 	kthread->state = THR_STATE_READY;
 	kthread->queue = &ready_q[kthread->prio];
 
@@ -450,7 +588,7 @@ static void kthread_remove_descriptor ( kthread_t *kthread )
 {
 	kthread_t *test;
 
-	k_free_unique_id ( kthread->id );
+	k_handle_free ( kthread->id );
 	kthread->id = 0;
 
 #ifdef DEBUG
@@ -461,10 +599,11 @@ static void kthread_remove_descriptor ( kthread_t *kthread )
 #endif
 
 #ifdef USE_SSE
-	kfree ( kthread->orig_addr );
+	kfree ( kthread->context_orig );
 #else
-	kfree ( kthread );
+	kfree ( kthread->context );
 #endif
+	kfree ( kthread->orig_addr );
 }
 
 /*!
@@ -478,6 +617,8 @@ int kthread_cancel ( kthread_t *kthread, int exit_status )
 	if ( kthread->state == THR_STATE_PASSIVE )
 		return SUCCESS; /* thread is already finished */
 
+	kthread_account ( kthread );
+
 	if ( kthread->state == THR_STATE_READY )
 	{
 		/* remove target 'thread' from its queue */
@@ -501,9 +642,12 @@ int kthread_cancel ( kthread_t *kthread, int exit_status )
 		return E_INVALID_HANDLE; /* thread descriptor corrupted ! */
 	}
 
+	kthread->state = THR_STATE_PASSIVE;
+
 	kthread->ref_cnt--;
 	kthread->exit_status = exit_status;
 	kthread->proc->thr_count--;
+	kthread_acct_add ( &kthread->proc->acct, &kthread->acct );
 
 
 #ifdef	MESSAGES
@@ -528,7 +672,9 @@ int kthread_cancel ( kthread_t *kthread, int exit_status )
 	if ( kthread->proc->thr_count == 0 && kthread->proc->pi )
 	{
 		/* last (non-kernel) thread - remove process */
-		kfree ( kthread->proc->pi );
+		arch_user_segments_free ( kthread->proc->segm );
+		k_process_mem_free ( kthread->proc->m.start,
+				     kthread->proc->m.size );
 #ifdef DEBUG
 		test = list_find_and_remove ( &procs, &kthread->proc->all );
 		ASSERT ( test == kthread->proc );
@@ -536,6 +682,11 @@ int kthread_cancel ( kthread_t *kthread, int exit_status )
 		(void) list_remove ( &procs, 0, &kthread->proc->all );
 #endif
 		kfree ( kthread->proc );
+
+#ifdef QEMU_EXIT
+		if ( !list_get ( &procs, FIRST ) )
+			kthread_all_done ();
+#endif
 	}
 
 	if ( !kthread->ref_cnt )
@@ -553,11 +704,43 @@ int kthread_cancel ( kthread_t *kthread, int exit_status )
 	return SUCCESS;
 }
 
+#ifdef QEMU_EXIT
+/* time left to devices to send buffered output after last program ends */
+#define QEMU_EXIT_DELAY_MS	200
+
+static void *qemu_exit_alarm;
+static alarm_t qemu_exit_alarm_params;
+
+/*! Last program ended: exit emulator (for automated runs, see bench/run.sh) */
+static void kthread_all_done ()
+{
+	alarm_t *alarm = &qemu_exit_alarm_params;
+	time_t delay = { 0, QEMU_EXIT_DELAY_MS * 1000000 };
+
+	k_get_time ( &alarm->exp_time );
+	time_add ( &alarm->exp_time, &delay );
+	alarm->period.sec = alarm->period.nsec = 0;
+	alarm->action = kthread_qemu_exit;
+	alarm->param = NULL;
+	alarm->flags = 0;
+
+	if ( !qemu_exit_alarm )
+		k_alarm_new ( &qemu_exit_alarm, alarm, KERNELCALL );
+	k_alarm_set ( qemu_exit_alarm, alarm );
+}
+
+static void kthread_qemu_exit ( void *param )
+{
+	kprint_flush ();
+	qemu_exit ( 0 );
+}
+#endif /* QEMU_EXIT */
 
 
 /*! Idle thread ------------------------------------------------------------- */
 #include <api/syscall.h>
 
+
 /*! Idle thread starting (and only) function */
 static void idle_thread ( void *param )
 {
@@ -593,6 +776,10 @@ int sys__create_thread ( void *p )
 
 	prio = *( (int *) p ); p += sizeof (int);
 
+	/* priorities from PRIO_RM_BAND up are given only by RM scheduler */
+	ASSERT_ERRNO_AND_EXIT ( prio >= 0 && prio < PRIO_RM_BAND,
+				E_INVALID_ARGUMENT );
+
 	kthread = kthread_create (func, param, active_thread->proc->pi->exit,
 				  sched, prio, NULL, 0, 1, active_thread->proc);
 
@@ -613,6 +800,29 @@ int sys__create_thread ( void *p )
 	RETURN ( SUCCESS );
 }
 
+/*!
+ * Terminate all threads of process (process is removed with its last thread)
+ * \param proc Process descriptor
+ * \param exit_status Exit status given to all its threads
+ */
+void kthread_kill_process ( kprocess_t *proc, int exit_status )
+{
+	kthread_t *kthread, *next;
+
+	kthread = list_get ( &all_threads, FIRST );
+	while ( kthread )
+	{
+		/* canceled thread's descriptor may be released */
+		next = list_get_next ( &kthread->all );
+
+		if ( kthread->proc == proc &&
+		     kthread->state != THR_STATE_PASSIVE )
+			kthread_cancel ( kthread, exit_status );
+
+		kthread = next;
+	}
+}
+
 /*!
  * End current thread (exit from it)
  * \param status Exit status number
@@ -646,11 +856,11 @@ int sys__wait_for_thread ( void *p )
 
 	wait = *( (int *) p );
 
-	ASSERT_ERRNO_AND_EXIT ( thread && thread->thread, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( thread, E_INVALID_HANDLE );
 
-	kthread = thread->thread;
+	kthread = k_handle_get ( thread->thr_id, HANDLE_THREAD );
 
-	if ( kthread->id != thread->thr_id ) /* at 'kthread' is now something else */
+	if ( !kthread ) /* descriptor is already released */
 	{
 		ret_value = -SUCCESS;
 		SET_ERRNO ( SUCCESS );
@@ -697,11 +907,11 @@ int sys__cancel_thread ( void *p )
 
 	thread = U2K_GET_ADR ( *( (void **) p ), active_thread->proc );
 
-	ASSERT_ERRNO_AND_EXIT ( thread && thread->thread, E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( thread, E_INVALID_HANDLE );
 
-	kthread = thread->thread;
+	kthread = k_handle_get ( thread->thr_id, HANDLE_THREAD );
 
-	if ( kthread->id != thread->thr_id )
+	if ( !kthread )
 		EXIT ( SUCCESS ); /* thread is already finished */
 
 	/* remove thread from queue where its descriptor is */
@@ -739,6 +949,155 @@ int sys__thread_self ( void *p )
 	EXIT ( SUCCESS );
 }
 
+/*! Give processor to next ready thread with same priority (if there is one) */
+int sys__thread_yield ( void *p )
+{
+	SET_ERRNO ( SUCCESS );
+
+	kthread_move_to_ready ( active_thread, LAST );
+	kthreads_schedule ();
+
+	RETURN ( SUCCESS );
+}
+
+/*!
+ * Copy accounting snapshot of all threads or all processes to user buffer
+ * \param flags STATS_THREADS or STATS_PROCESSES
+ * \param buf Array of 'thread_stats_t' elements
+ * \param max Number of elements in 'buf'
+ * \return number of elements filled
+ */
+int sys__thread_stats ( void *p )
+{
+	int flags, max, cnt = 0;
+	thread_stats_t *buf;
+	kthread_t *kthread;
+	kprocess_t *proc = active_thread->proc;
+	kacct_t acct;
+	size_t room;
+
+	flags = *( (int *) p );		p += sizeof (int);
+	buf = *( (void **) p );		p += sizeof (void *);
+	max = *( (int *) p );
+
+	ASSERT_ERRNO_AND_EXIT ( buf && (aint) buf < proc->m.size && max > 0 &&
+				( flags == STATS_THREADS ||
+				  flags == STATS_PROCESSES ), E_INVALID_ARGUMENT );
+
+	/* write only inside calling process: limit 'max' to what fits */
+	room = ( proc->m.size - (aint) buf ) / sizeof (thread_stats_t);
+	ASSERT_ERRNO_AND_EXIT ( room > 0, E_INVALID_ARGUMENT );
+	if ( max > room )
+		max = room;
+
+	buf = U2K_GET_ADR ( buf, proc );
+
+	if ( flags == STATS_THREADS )
+	{
+		kthread = list_get ( &all_threads, FIRST );
+		for ( ; kthread && cnt < max; cnt++ )
+		{
+			kthread_account ( kthread );
+			kthread_stats_fill ( &buf[cnt], &kthread->acct,
+					     kthread->proc );
+			buf[cnt].id = kthread->id;
+			buf[cnt].threads = 1;
+			buf[cnt].prio = kthread->prio;
+			buf[cnt].state = kthread->state;
+			buf[cnt].sched_policy = kthread->sched.sched_policy;
+
+			kthread = list_get_next ( &kthread->all );
+		}
+
+		return cnt;
+	}
+
+	/* per process: finished threads and running ones */
+	for ( proc = &kernel_proc; proc && cnt < max; cnt++ )
+	{
+		acct = proc->acct;
+		buf[cnt].threads = 0;
+
+		kthread = list_get ( &all_threads, FIRST );
+		while ( kthread )
+		{
+			if ( kthread->proc == proc &&
+			     kthread->state != THR_STATE_PASSIVE )
+			{
+				kthread_account ( kthread );
+				kthread_acct_add ( &acct, &kthread->acct );
+				buf[cnt].threads++;
+			}
+			kthread = list_get_next ( &kthread->all );
+		}
+
+		kthread_stats_fill ( &buf[cnt], &acct, proc );
+		buf[cnt].id = 0;
+		buf[cnt].prio = buf[cnt].state = buf[cnt].sched_policy = 0;
+
+		if ( proc == &kernel_proc )
+			proc = list_get ( &procs, FIRST );
+		else
+			proc = list_get_next ( &proc->all );
+	}
+
+	return cnt;
+}
+
+/*! Charge time since last state change to thread's current state */
+static inline void kthread_account ( kthread_t *kthread )
+{
+	uint64 now = k_get_cycles ();
+	uint64 delta = now - kthread->acct_since;
+
+	switch ( kthread->state )
+	{
+	case THR_STATE_ACTIVE:
+		kthread->acct.run += delta;
+		break;
+	case THR_STATE_READY:
+		kthread->acct.ready += delta;
+		break;
+	case THR_STATE_WAIT:
+		if ( kthread->queue && ( kthread->queue->flags & THRQ_READY ) )
+			kthread->acct.ready += delta;
+		else
+			kthread->acct.wait += delta;
+		break;
+	}
+
+	kthread->acct_since = now;
+}
+
+static void kthread_acct_add ( kacct_t *sum, kacct_t *acct )
+{
+	sum->run += acct->run;
+	sum->ready += acct->ready;
+	sum->wait += acct->wait;
+	sum->vol_switches += acct->vol_switches;
+	sum->invol_switches += acct->invol_switches;
+}
+
+/*! Set times, switches and program name in snapshot element */
+static void kthread_stats_fill ( thread_stats_t *st, kacct_t *acct,
+				 kprocess_t *proc )
+{
+	char *name = "kernel";
+	int i;
+
+	if ( proc->prog )
+		name = proc->prog->prog_name;
+	for ( i = 0; i < STATS_NAME_LEN - 1 && name[i]; i++ )
+		st->name[i] = name[i];
+	st->name[i] = 0;
+
+	k_cycles_to_time ( acct->run, &st->run_time );
+	k_cycles_to_time ( acct->ready, &st->ready_time );
+	k_cycles_to_time ( acct->wait, &st->wait_time );
+	st->vol_switches = acct->vol_switches;
+	st->invol_switches = acct->invol_switches;
+}
+
 /*!
  * Start new process
  * \param prog_name Program name (as given with module)
@@ -766,6 +1125,8 @@ int sys__start_program ( void *p )
 	param = *( (void **) p ); p += sizeof (void *);
 
 	prio = *( (int *) p );
+	ASSERT_ERRNO_AND_EXIT ( prio >= 0 && prio < PRIO_RM_BAND,
+				E_INVALID_ARGUMENT );
 
 	if ( param ) /* copy parameters from one process space to another */
 	{
@@ -817,6 +1178,7 @@ int sys__start_program ( void *p )
 int kthread_info ()
 {
 	kthread_t *kthread;
+	time_t run;
 	int i = 1;
 
 	kprint ( "Threads info\n" );
@@ -829,6 +1191,13 @@ int kthread_info ()
 		  active_thread->prio, active_thread->state,
 		  active_thread->exit_status );
 
+	kthread_account ( active_thread );
+	k_cycles_to_time ( active_thread->acct.run, &run );
+	kprint ( "\trun=%d ms, switches: voluntary=%d, involuntary=%d\n",
+		  run.sec * 1000 + run.nsec / 1000000,
+		  active_thread->acct.vol_switches,
+		  active_thread->acct.invol_switches );
+
 	kthread = list_get ( &all_threads, FIRST );
 	while ( kthread )
 	{
@@ -840,6 +1209,13 @@ int kthread_info ()
 			 kthread->prio, kthread->state,
 			 kthread->exit_status );
 
+		kthread_account ( kthread );
+		k_cycles_to_time ( kthread->acct.run, &run );
+		kprint ( "\trun=%d ms, switches: voluntary=%d, "
+			 "involuntary=%d\n", run.sec * 1000 + run.nsec / 1000000,
+			 kthread->acct.vol_switches,
+			 kthread->acct.invol_switches );
+
 		kthread = list_get_next ( &kthread->all );
 	}
 
@@ -877,9 +1253,9 @@ inline void *kthread_get_active ()
 inline void *kthread_get_context ( kthread_t *kthread )
 {
 	if ( kthread )
-		return &kthread->context;
+		return kthread->context;
 	else
-		return &active_thread->context;
+		return active_thread->context;
 }
 inline int kthread_get_prio ( kthread_t *kthread )
 {
@@ -918,8 +1294,17 @@ int kthread_set_prio ( kthread_t *kthread, int prio )
 		kthreads_schedule ();
 		break;
 
-	case THR_STATE_WAIT: /* as now there is only FIFO queue */
-		kthr->prio = prio;
+	case THR_STATE_WAIT:
+		if ( kthr->queue && ( kthr->queue->flags & THRQ_PRIO ) )
+		{
+			/* reposition thread in priority ordered queue */
+			kthreadq_remove ( kthr->queue, kthr );
+			kthr->prio = prio;
+			kthread_enqueue ( kthr, kthr->queue );
+		}
+		else {
+			kthr->prio = prio;
+		}
 		break;
 
 	case THR_STATE_PASSIVE: /* report error or just change priority? */
@@ -970,7 +1355,33 @@ inline int kthread_is_ready ( kthread_t *kthread )
 /*! thread queue manipulation */
 inline void kthreadq_init ( kthread_q *q )
 {
+	kthreadq_init_ordered ( q, THRQ_FIFO );
+}
+inline void kthreadq_init_ordered ( kthread_q *q, uint flags )
+{
+	int i;
+
 	list_init ( &q->q );
+	q->flags = flags;
+
+	q->tail = NULL;
+	for ( i = 0; i < THRQ_MASKS; i++ )
+		q->levels[i] = 0;
+
+	if ( flags & THRQ_PRIO )
+	{
+		q->tail = kmalloc ( PRIO_LEVELS * sizeof (list_h *) );
+		ASSERT ( q->tail );
+	}
+}
+/*! Release queue memory (queue must be empty) */
+void kthreadq_destroy ( kthread_q *q )
+{
+	ASSERT ( !list_get ( &q->q, FIRST ) );
+
+	if ( q->tail )
+		kfree ( q->tail );
+	q->tail = NULL;
 }
 inline void kthreadq_append ( kthread_q *q, kthread_t *kthread )
 {
@@ -982,10 +1393,40 @@ inline void kthreadq_prepend ( kthread_q *q, kthread_t *kthread )
 }
 inline kthread_t *kthreadq_remove ( kthread_q *q, kthread_t *kthread )
 {
-	if ( kthread )
-		return list_find_and_remove ( &q->q, &kthread->ql );
-	else
-		return list_remove ( &q->q, FIRST, NULL );
+	list_h *prev;
+
+	if ( !( q->flags & THRQ_PRIO ) )
+	{
+		if ( kthread )
+			return list_find_and_remove ( &q->q, &kthread->ql );
+		else
+			return list_remove ( &q->q, FIRST, NULL );
+	}
+
+	if ( !kthread )
+	{
+		kthread = list_remove ( &q->q, FIRST, NULL );
+		if ( kthread )
+			kthreadq_prio_removed ( q, kthread, NULL );
+		return kthread;
+	}
+
+	prev = kthread->ql.prev;
+	if ( list_find_and_remove ( &q->q, &kthread->ql ) != kthread )
+		return NULL;
+	kthreadq_prio_removed ( q, kthread, prev );
+
+	return kthread;
+}
+/*! Remove thread known to be in queue 'q' (without searching for it) */
+inline void kthreadq_unlink ( kthread_q *q, kthread_t *kthread )
+{
+	list_h *prev = kthread->ql.prev;
+
+	list_remove ( &q->q, FIRST, &kthread->ql );
+
+	if ( q->flags & THRQ_PRIO )
+		kthreadq_prio_removed ( q, kthread, prev );
 }
 inline kthread_t *kthreadq_get ( kthread_q *q )
 {
@@ -1017,8 +1458,8 @@ inline kthread_t *kthread_get_descriptor ( thread_t *thr )
 {
 	kthread_t *kthread;
 
-	if ( thr && (kthread = thr->thread) && thr->thr_id == kthread->id &&
-		kthread->state != THR_STATE_PASSIVE )
+	if ( thr && ( kthread = k_handle_get ( thr->thr_id, HANDLE_THREAD ) ) &&
+	     kthread->state != THR_STATE_PASSIVE )
 		return kthread;
 	else
 		return NULL;
@@ -8,6 +8,8 @@ int sys__thread_exit ( void *p );
 int sys__wait_for_thread ( void *p );
 int sys__cancel_thread ( void *p );
 int sys__thread_self ( void *p );
+int sys__thread_stats ( void *p );
+int sys__thread_yield ( void *p );
 
 int sys__start_program ( void *p );
 
@@ -20,10 +22,23 @@ int sys__get_errno ( void *p );
 #include <lib/list.h>
 
 /*! Thread queue */
+#define THRQ_MBITS	( sizeof (uint32) * 8 )
+
+/* kernel only flag (with THRQ_FIFO/THRQ_PRIO from lib/types.h): threads in
+   queue are runnable, only held back by secondary scheduler; their waiting
+   time is accounted as ready, not as blocked */
+#define THRQ_READY	2
+#define THRQ_MASKS	( ( PRIO_LEVELS + THRQ_MBITS - 1 ) / THRQ_MBITS )
+
 typedef struct _kthread_q_
 {
 	list_t q;		/* queue implementation in list.h/list.c */
-	/* uint flags; */	/* various flags, e.g. sort order */
+	uint flags;		/* various flags, e.g. sort order (THRQ_*) */
+
+	/* only for THRQ_PRIO: last thread in each priority level and mask of
+	   non-empty levels (insertion without searching the list) */
+	list_h **tail;
+	uint32 levels[THRQ_MASKS];
 }
 kthread_q;
 
@@ -50,6 +65,7 @@ void kthreads_schedule ();
 void kthread_move_to_ready ( kthread_t *kthr, int where );
 kthread_t *kthread_remove_from_ready ( kthread_t *kthr );
 int kthread_cancel ( kthread_t *kthread, int exit_status );
+void kthread_kill_process ( kprocess_t *proc, int exit_status );
 
 /*! Get-ers and Set-ers */
 extern inline int kthread_is_active ( kthread_t *kthread );
@@ -78,9 +94,12 @@ extern inline kthread_t *kthread_get_descriptor ( thread_t *thr );
 
 /*! Thread queue manipulation */
 extern inline void kthreadq_init ( kthread_q *q );
+extern inline void kthreadq_init_ordered ( kthread_q *q, uint flags );
+void kthreadq_destroy ( kthread_q *q );
 extern inline void kthreadq_append ( kthread_q *q, kthread_t *kthr );
 extern inline void kthreadq_prepend ( kthread_q *q, kthread_t *kthread );
 extern inline kthread_t *kthreadq_remove ( kthread_q *q, kthread_t *kthr );
+extern inline void kthreadq_unlink ( kthread_q *q, kthread_t *kthr );
 extern inline kthread_t *kthreadq_get ( kthread_q *q );
 extern inline kthread_t *kthreadq_get_next ( kthread_t *kthr );
 
@@ -103,26 +122,36 @@ int kthread_info ();
 
 #include <arch/context.h>
 
+/* descriptor is aligned to cache line so that fields used on every
+   scheduling decision (at descriptor start) are loaded together */
+#define KTHREAD_ALIGNMENT	64
+
 /*! Thread descriptor */
 struct _kthread_t_
 {
-	context_t context;	/* storage for thread context */
-
-	uint id;		/* thread id */
-
+	/* "hot" part - used by scheduler and thread queue operations */
 	int state;		/* thread state */
 
-	list_h ql;		/* list element for "thread state" list */
-
 	int prio;		/* priority - primary scheduling parameter */
 
-	kthread_sched_data_t sched;	/* secondary scheduler parameters */
+	list_h ql;		/* list element for "thread state" list */
 
 	kthread_q *queue;	/* in witch queue (if not active) */
+
+	context_t *context;	/* storage for thread context (separate block) */
+
+	uint id;		/* thread id */
+
 	void *qdata;		/* temporary storage for data while waiting */
 
+	kthread_sched_data_t sched;	/* secondary scheduler parameters */
+
+	/* "cold" part - rarely used */
 	kthread_q join_queue;	/* queue for threads waiting for this to end */
 
+	kacct_t acct;		/* time spent in each state, switches */
+	uint64 acct_since;	/* when thread entered current state */
+
 	void *stack;		/* stack address and size (for deallocation) */
 	uint stack_size;
 
@@ -142,10 +171,11 @@ struct _kthread_t_
 
 	int ref_cnt;		/* can we free this descriptor? */
 
-#ifdef USE_SSE
 	void *orig_addr;	/* start of memory chunk for this descriptor
 				   might be different than "kthread" because of
-				   alignment (if used) */
+				   alignment */
+#ifdef USE_SSE
+	void *context_orig;	/* same for context (FPU context alignment) */
 #endif
 };
 
@@ -165,8 +195,24 @@ static void kthread_ready_list_set_empty ( int index );
 
 static void kthread_remove_descriptor ( kthread_t *kthr );
 
+/* accounting */
+static inline void kthread_account ( kthread_t *kthr );
+static void kthread_acct_add ( kacct_t *sum, kacct_t *acct );
+static void kthread_stats_fill ( thread_stats_t *st, kacct_t *acct,
+				 kprocess_t *proc );
+
+/* priority ordered thread queues */
+static void kthreadq_prio_add ( kthread_q *q, kthread_t *kthread );
+static void kthreadq_prio_removed ( kthread_q *q, kthread_t *kthread,
+				    list_h *prev );
+
 /* idle thread */
 static void idle_thread ( void *param );
 
+#ifdef QEMU_EXIT
+static void kthread_all_done ();
+static void kthread_qemu_exit ( void *param );
+#endif
+
 #endif	/* _K_THREAD_C_ */
 #endif	/* _KERNEL_ */
@@ -10,6 +10,7 @@
 #include <kernel/memory.h>
 #include <kernel/kprint.h>
 #include <kernel/errno.h>
+#include <kernel/trace.h>
 #include <lib/bits.h>
 #include <arch/processor.h>
 
@@ -65,6 +66,8 @@ static int k_schedule_alarms ()
 			/* but first remove alarm from list */
 			first = list_remove ( &kalarms, FIRST, NULL );
 
+			TRACE_EVENT ( TRACE_ALARM, first );
+
 			if ( first->alarm.flags & ALARM_PERIODIC )
 			{
 				/* calculate next activation time */
@@ -179,6 +182,7 @@ int k_alarm_new ( void **id, alarm_t *alarm, int priv )
 	/* param checking is skipped - assuming all is OK */
 
 	kthreadq_init ( &kalarm->queue );
+	kalarm->handle = 0;
 
 #ifdef DEBUG
 	kalarm->magic = ALARM_MAGIC;
@@ -249,6 +253,8 @@ int k_alarm_remove ( void *id )
 #ifdef DEBUG
 	kalarm->magic = 0;
 #endif
+	if ( kalarm->handle )
+		k_handle_free ( kalarm->handle );
 
 	SET_ERRNO ( SUCCESS );
 
@@ -280,13 +286,14 @@ void k_get_time ( time_t *time )
 /*!
  * Create new alarm
  * \param alarm Alarm parameters
- * \return status (0 for success), but also in 'param->alarm_id' is pointer to
- *		newly created alarm (handler)
+ * \return status (0 for success), but also in 'param->alarm_id' is handle of
+ *		newly created alarm
  */
 int sys__alarm_new ( void *p )
 {
 	void **id;
 	alarm_t *alarm;
+	kalarm_t *kalarm;
 
 	id = *( (void **) p );	p += sizeof ( void *);
 	alarm = *( (void **) p );
@@ -298,7 +305,18 @@ int sys__alarm_new ( void *p )
 
 	ASSERT_ERRNO_AND_EXIT ( id && alarm, E_INVALID_HANDLE );
 
-	return k_alarm_new ( id, alarm, SYSCALL );
+	k_alarm_new ( (void **) &kalarm, alarm, SYSCALL );
+
+	kalarm->handle = k_handle_new ( kalarm, HANDLE_ALARM );
+	if ( !kalarm->handle )
+	{
+		k_alarm_remove ( kalarm );
+		EXIT ( E_NO_MEMORY );
+	}
+
+	*id = HANDLE2PTR ( kalarm->handle );
+
+	EXIT ( SUCCESS );
 }
 
 /*!
@@ -310,6 +328,7 @@ int sys__alarm_set ( void *p )
 {
 	void *id;
 	alarm_t *alarm;
+	kalarm_t *kalarm;
 
 	id = *( (void **) p );	p += sizeof ( void *);
 	alarm = *( (void **) p );
@@ -317,24 +336,30 @@ int sys__alarm_set ( void *p )
 	ASSERT_ERRNO_AND_EXIT ( id && alarm, E_INVALID_HANDLE );
 
 	alarm =  U2K_GET_ADR ( alarm, kthread_get_process (NULL) );
+	kalarm = k_handle_get ( PTR2HANDLE ( id ), HANDLE_ALARM );
+
+	ASSERT_ERRNO_AND_EXIT ( alarm && kalarm, E_INVALID_HANDLE );
 
-	return k_alarm_set ( id, alarm );
+	return k_alarm_set ( kalarm, alarm );
 }
 
 /*!
  * Delete alarm
- * \param alarm Alarm id (pointer)
+ * \param alarm Alarm id (handle)
  * \return status (0 for success)
  */
 int sys__alarm_remove ( void *p )
 {
 	void *id;
+	kalarm_t *kalarm;
 
 	id = *( (void **) p );
 
-	ASSERT_ERRNO_AND_EXIT ( id, E_INVALID_HANDLE );
+	kalarm = k_handle_get ( PTR2HANDLE ( id ), HANDLE_ALARM );
+
+	ASSERT_ERRNO_AND_EXIT ( kalarm, E_INVALID_HANDLE );
 
-	return k_alarm_remove ( id );
+	return k_alarm_remove ( kalarm );
 }
 
 /*!
@@ -355,10 +380,9 @@ int sys__alarm_get ( void *p )
 
 	alarm =  U2K_GET_ADR ( alarm, kthread_get_process (NULL) );
 
-	kalarm = id;
+	kalarm = k_handle_get ( PTR2HANDLE ( id ), HANDLE_ALARM );
 
-	ASSERT_ERRNO_AND_EXIT ( kalarm && kalarm->magic == ALARM_MAGIC,
-				E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( alarm && kalarm, E_INVALID_HANDLE );
 
 	*alarm = kalarm->alarm;
 
@@ -388,7 +412,7 @@ int sys__get_time ( void *p )
 
 /*!
  * Wait for alarm to expire (activate)
- * \param alarm Alarm id (pointer)
+ * \param alarm Alarm id (handle)
  * \param wait Do thread really wait or not (just return status)?
  * \return status (0 for success)
  */
@@ -400,16 +424,12 @@ int sys__wait_for_alarm ( void *p )
 	int retval;
 
 	id = *( (void **) p );
-	ASSERT_ERRNO_AND_EXIT ( id, E_INVALID_HANDLE );
-
-
 	p += sizeof (void *);
 	wait =  *( (int *)   p );
 
-	kalarm = id;
+	kalarm = k_handle_get ( PTR2HANDLE ( id ), HANDLE_ALARM );
 
-	ASSERT_ERRNO_AND_EXIT ( kalarm && kalarm->magic == ALARM_MAGIC,
-				E_INVALID_HANDLE );
+	ASSERT_ERRNO_AND_EXIT ( kalarm, E_INVALID_HANDLE );
 
 	retval = 0;
 	SET_ERRNO ( SUCCESS );
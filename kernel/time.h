@@ -13,6 +13,7 @@ int sys__wait_for_alarm ( void *p );
 #ifdef _KERNEL_
 
 #include <lib/types.h>
+#include <arch/time.h>
 
 /*! interface to kernel */
 void k_time_init ();
@@ -21,6 +22,10 @@ int k_alarm_set ( void *id, alarm_t *alarm );
 int k_alarm_remove ( void *id );
 void k_get_time ( time_t *time );
 
+/* fast clock (for accounting), in arch specific units */
+#define k_get_cycles()			arch_get_cycles()
+#define k_cycles_to_time(CYCLES, TIME)	arch_cycles_to_time ( CYCLES, TIME )
+
 #endif /* _KERNEL_ */
 
 /*! rest of the file is only for 'kernel/time.c' ---------------------------- */
@@ -39,6 +44,8 @@ typedef struct _kalarm_t_
 
 	void *thread;	/* owner threads pointer */
 
+	uint handle;	/* handle given to owner thread (0 for kernel alarm) */
+
 	kthread_q queue; /* which threads wait for this alarm? */
 
 #ifdef DEBUG
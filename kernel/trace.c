@@ -0,0 +1,137 @@
+/*! Event trace - binary records in ring buffer, sent to host when idle
+ *
+ * Recording an event only stores 16 bytes into ring buffer (no formatting).
+ * Buffer is drained from idle thread, so tracing does not delay other threads.
+ * If buffer is full, oldest events are overwritten (TRACE_LOST is reported).
+ */
+#ifdef TRACE
+
+#define _KERNEL_
+
+#define _K_TRACE_C_
+#include "trace.h"
+
+#include <kernel/thread.h>
+#include <kernel/devices.h>
+#include <kernel/memory.h>
+#include <kernel/errno.h>
+#include <arch/processor.h>
+#include <lib/string.h>
+
+static ktrace_event_t trace_buf[TRACE_EVENTS];
+static uint trace_head, trace_tail;	/* free running indexes */
+static uint trace_lost;			/* overwritten events */
+
+static kdevice_t *trace_dev;
+static int trace_dev_irq;	/* do not trace interrupts caused by draining */
+
+/* line being sent to trace device */
+#define LINE_SIZE	( sizeof (TRACE_PREFIX) - 1 + 2 * sizeof (ktrace_event_t) + 1 )
+static char trace_line[LINE_SIZE];
+static int line_sent = LINE_SIZE;
+
+/*! Initialize trace buffer and open device used to send records */
+void k_trace_init ()
+{
+	trace_head = trace_tail = trace_lost = 0;
+
+	trace_dev = k_device_open ( TRACE_DEVICE );
+	trace_dev_irq = trace_dev ? trace_dev->dev.irq_num : -1;
+
+	k_trace ( TRACE_START, 0 );
+}
+
+/*! Record event */
+void k_trace ( uint type, uint arg )
+{
+	ktrace_event_t *ev;
+	uint64 tsc;
+
+	if ( type == TRACE_IRQ && (int) arg == trace_dev_irq )
+		return;
+
+	if ( trace_head - trace_tail >= TRACE_EVENTS )
+	{
+		trace_tail++; /* overwrite oldest */
+		trace_lost++;
+	}
+
+	read_tsc ( tsc );
+
+	ev = &trace_buf[ trace_head % TRACE_EVENTS ];
+	ev->tsc_lo = (uint32) tsc;
+	ev->tsc_hi = (uint32) ( tsc >> 32 );
+	ev->type = type;
+	ev->thread = kthread_get_active () ?
+		     HANDLE_INDEX ( kthread_get_id ( NULL ) ) : 0;
+	ev->arg = arg;
+
+	trace_head++;
+}
+
+/*! Encode event as text line (so it can be mixed with other output) */
+static void k_trace_encode ( ktrace_event_t *ev )
+{
+	static const char hex[] = "0123456789abcdef";
+	uint8 *b = (uint8 *) ev;
+	char *l = trace_line;
+	int i;
+
+	for ( i = 0; i < sizeof (TRACE_PREFIX) - 1; i++ )
+		*l++ = TRACE_PREFIX[i];
+
+	for ( i = 0; i < sizeof (ktrace_event_t); i++ )
+	{
+		*l++ = hex[ b[i] >> 4 ];
+		*l++ = hex[ b[i] & 0x0f ];
+	}
+
+	*l = '\n';
+}
+
+/*! Send as many recorded events to trace device as it can accept now */
+void k_trace_drain ()
+{
+	ktrace_event_t lost;
+	int rest;
+
+	if ( !trace_dev )
+		return;
+
+	while (1)
+	{
+		if ( line_sent == LINE_SIZE ) /* previous line sent - get next */
+		{
+			if ( trace_lost )
+			{
+				lost = trace_buf[ trace_tail % TRACE_EVENTS ];
+				lost.type = TRACE_LOST;
+				lost.arg = trace_lost;
+				trace_lost = 0;
+				k_trace_encode ( &lost );
+			}
+			else if ( trace_tail != trace_head )
+			{
+				k_trace_encode (
+					&trace_buf[ trace_tail % TRACE_EVENTS ] );
+				trace_tail++;
+			}
+			else {
+				return; /* buffer empty */
+			}
+			line_sent = 0;
+		}
+
+		rest = k_device_send ( &trace_line[line_sent],
+				       LINE_SIZE - line_sent, 0, trace_dev );
+		if ( rest < 0 )
+			return;
+
+		line_sent = LINE_SIZE - rest;
+
+		if ( rest > 0 )
+			return; /* device buffer is full; continue later */
+	}
+}
+
+#endif /* TRACE */
@@ -0,0 +1,56 @@
+/*! Event trace - binary records in ring buffer, sent to host when idle
+ *
+ * Enabled with TRACE in OPTIONALS (Makefile); otherwise TRACE_EVENT is empty.
+ */
+
+#pragma once
+
+#include <lib/types.h>
+
+/*! Event types */
+enum {
+	TRACE_START = 1,	/* trace started; arg = 0 */
+	TRACE_SWITCH,		/* context switch; arg = new thread number */
+	TRACE_WAKEUP,		/* thread moved from wait to ready; arg = its number */
+	TRACE_ALARM,		/* alarm activated; arg = alarm (address) */
+	TRACE_SYSCALL_ENTER,	/* arg = syscall id */
+	TRACE_SYSCALL_EXIT,	/* arg = syscall id */
+	TRACE_IRQ,		/* arg = interrupt number */
+	TRACE_LOST,		/* arg = number of overwritten events */
+
+	TRACE_TYPES
+};
+
+/*! Event record (16 bytes) */
+typedef struct _ktrace_event_t_
+{
+	uint32 tsc_lo;		/* time stamp counter (when event occurred) */
+	uint32 tsc_hi;
+	uint16 type;		/* event type */
+	uint16 thread;		/* active thread number (index of its id,
+				   HANDLE_INDEX in kernel/memory.h) */
+	uint32 arg;		/* event specific argument */
+}
+ktrace_event_t;
+
+/* number of events in ring buffer (must be power of 2) */
+#define TRACE_EVENTS	4096
+
+/* device (shared) where records are sent: each record in single line
+   "@T" + 32 hex digits (record bytes), to be separated from other output */
+#define TRACE_DEVICE	"COM1"
+#define TRACE_PREFIX	"@T"
+
+#ifdef TRACE
+
+void k_trace_init ();
+void k_trace ( uint type, uint arg );
+void k_trace_drain ();
+
+#define TRACE_EVENT(TYPE, ARG)	k_trace ( TYPE, (uint) (ARG) )
+
+#else /* !TRACE */
+
+#define TRACE_EVENT(TYPE, ARG)
+
+#endif /* TRACE */
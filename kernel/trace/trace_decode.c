@@ -0,0 +1,194 @@
+/*! Event trace decoder (host side)
+ *
+ * Reads serial output of system (with TRACE enabled), extracts trace records
+ * (lines with "@T" prefix) and prints timeline of events. At the end,
+ * scheduling latency (from thread wakeup until it becomes active) is given.
+ * Other output is ignored (or printed with -t).
+ *
+ * Usage: trace_decode [-f cpu_MHz] [-t] < serial_output
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* record format must match kernel/trace.h (little endian, 16 bytes) */
+enum {
+	TRACE_START = 1,
+	TRACE_SWITCH,
+	TRACE_WAKEUP,
+	TRACE_ALARM,
+	TRACE_SYSCALL_ENTER,
+	TRACE_SYSCALL_EXIT,
+	TRACE_IRQ,
+	TRACE_LOST,
+
+	TRACE_TYPES
+};
+
+static char *type_name[TRACE_TYPES] = {
+	"?", "start", "switch", "wakeup", "alarm", "syscall", "sysret",
+	"irq", "LOST"
+};
+
+#define TRACE_PREFIX	"@T"
+#define RECORD_SIZE	16
+#define MAX_THREADS	65536
+
+typedef struct _event_t_
+{
+	uint64_t tsc;
+	unsigned type;
+	unsigned thread;
+	uint32_t arg;
+}
+event_t;
+
+static uint64_t wakeup_tsc[MAX_THREADS]; /* 0 if thread not waiting */
+
+static int hexval ( int c )
+{
+	if ( c >= '0' && c <= '9' )
+		return c - '0';
+	if ( c >= 'a' && c <= 'f' )
+		return c - 'a' + 10;
+	return -1;
+}
+
+/*! Parse record from text (32 hex digits); return 0 on success */
+static int parse_record ( char *s, event_t *ev )
+{
+	uint8_t b[RECORD_SIZE];
+	int i, h, l;
+
+	for ( i = 0; i < RECORD_SIZE; i++ )
+	{
+		h = hexval ( s[2*i] );
+		l = h >= 0 ? hexval ( s[2*i+1] ) : -1;
+		if ( l < 0 )
+			return -1;
+		b[i] = ( h << 4 ) | l;
+	}
+
+	ev->tsc = 0;
+	for ( i = 7; i >= 0; i-- )
+		ev->tsc = ( ev->tsc << 8 ) | b[i];
+	ev->type = b[8] | ( b[9] << 8 );
+	ev->thread = b[10] | ( b[11] << 8 );
+	ev->arg = b[12] | ( b[13] << 8 ) | ( b[14] << 16 ) |
+		  ( (uint32_t) b[15] << 24 );
+
+	return ev->type > 0 && ev->type < TRACE_TYPES ? 0 : -1;
+}
+
+int main ( int argc, char *argv[] )
+{
+	char line[1024], *rec;
+	event_t ev;
+	uint64_t first = 0, prev = 0, lat, lat_min = ~0ULL, lat_max = 0;
+	double lat_sum = 0, mhz = 0;
+	unsigned long events = 0, lost = 0, lat_cnt = 0, bad = 0;
+	int i, text = 0;
+
+	for ( i = 1; i < argc; i++ )
+	{
+		if ( !strcmp ( argv[i], "-f" ) && i + 1 < argc )
+			mhz = atof ( argv[++i] );
+		else if ( !strcmp ( argv[i], "-t" ) )
+			text = 1;
+		else {
+			fprintf ( stderr, "Usage: %s [-f cpu_MHz] [-t]\n",
+				  argv[0] );
+			return 1;
+		}
+	}
+
+	printf ( "%16s %12s %6s %-8s %s\n", mhz ? "time[us]" : "time[cycles]",
+		 mhz ? "delta[us]" : "delta", "thread", "event", "arg" );
+
+	while ( fgets ( line, sizeof (line), stdin ) )
+	{
+		rec = strstr ( line, TRACE_PREFIX );
+		if ( !rec )
+		{
+			if ( text )
+				printf ( "# %s", line );
+			continue;
+		}
+		if ( text && rec != line )
+			printf ( "# %.*s\n", (int) ( rec - line ), line );
+
+		if ( parse_record ( rec + strlen ( TRACE_PREFIX ), &ev ) )
+		{
+			bad++;
+			continue;
+		}
+
+		if ( !events || ev.type == TRACE_START )
+			first = prev = ev.tsc;
+		events++;
+
+		if ( mhz )
+			printf ( "%16.3f %12.3f", ( ev.tsc - first ) / mhz,
+				 ( ev.tsc - prev ) / mhz );
+		else
+			printf ( "%16llu %12llu",
+				 (unsigned long long) ( ev.tsc - first ),
+				 (unsigned long long) ( ev.tsc - prev ) );
+		prev = ev.tsc;
+
+		printf ( " %6u %-8s ", ev.thread, type_name[ev.type] );
+		if ( ev.type == TRACE_ALARM )
+			printf ( "%x\n", ev.arg );
+		else
+			printf ( "%u\n", ev.arg );
+
+		switch ( ev.type )
+		{
+		case TRACE_WAKEUP:
+			if ( ev.arg < MAX_THREADS )
+				wakeup_tsc[ev.arg] = ev.tsc;
+			break;
+
+		case TRACE_SWITCH:
+			if ( ev.arg < MAX_THREADS && wakeup_tsc[ev.arg] )
+			{
+				lat = ev.tsc - wakeup_tsc[ev.arg];
+				wakeup_tsc[ev.arg] = 0;
+				lat_cnt++;
+				lat_sum += lat;
+				if ( lat < lat_min ) lat_min = lat;
+				if ( lat > lat_max ) lat_max = lat;
+			}
+			break;
+
+		case TRACE_LOST:
+			lost += ev.arg;
+			memset ( wakeup_tsc, 0, sizeof (wakeup_tsc) );
+			break;
+
+		case TRACE_START:
+			memset ( wakeup_tsc, 0, sizeof (wakeup_tsc) );
+			break;
+		}
+	}
+
+	printf ( "\nevents: %lu, lost: %lu, malformed: %lu\n",
+		 events, lost, bad );
+
+	if ( lat_cnt )
+	{
+		if ( mhz )
+			printf ( "wakeup->switch latency [us]: min %.3f avg %.3f "
+				 "max %.3f (%lu samples)\n", lat_min / mhz,
+				 lat_sum / lat_cnt / mhz, lat_max / mhz, lat_cnt );
+		else
+			printf ( "wakeup->switch latency [cycles]: min %llu avg "
+				 "%.0f max %llu (%lu samples)\n",
+				 (unsigned long long) lat_min, lat_sum / lat_cnt,
+				 (unsigned long long) lat_max, lat_cnt );
+	}
+
+	return 0;
+}
@@ -0,0 +1,201 @@
+/*! AVL tree - balanced binary search tree
+ *
+ * Insert and remove are recursive (depth is at most ~1.44 log2(n)).
+ * Nodes with equal keys are ordered by node address, so rotations can not
+ * make a node unreachable by search (needed for remove).
+ */
+
+#include "avl.h"
+
+#include <lib/types.h>
+#include ASSERT_H
+
+#define HEIGHT(N)	( (N) ? (N)->height : 0 )
+
+static int avl_cmp ( avl_tree_t *tree, avl_node_t *a, avl_node_t *b );
+static void avl_update ( avl_node_t *node );
+static avl_node_t *avl_rotate_right ( avl_node_t *node );
+static avl_node_t *avl_rotate_left ( avl_node_t *node );
+static avl_node_t *avl_balance ( avl_node_t *node );
+static avl_node_t *avl_add ( avl_tree_t *tree, avl_node_t *root,
+			     avl_node_t *node );
+static avl_node_t *avl_remove_min ( avl_node_t *root, avl_node_t **min );
+static avl_node_t *avl_del ( avl_tree_t *tree, avl_node_t *root,
+			     avl_node_t *node );
+
+void avl_init ( avl_tree_t *tree, int (*cmp) ( void *, void * ) )
+{
+	ASSERT ( tree && cmp );
+
+	tree->root = tree->first = NULL;
+	tree->cmp = cmp;
+}
+
+/*! Add object to tree; 'node' is tree node inside object */
+void avl_insert ( avl_tree_t *tree, void *object, avl_node_t *node )
+{
+	ASSERT ( tree && node );
+
+	node->left = node->right = NULL;
+	node->height = 1;
+	node->object = object;
+
+	tree->root = avl_add ( tree, tree->root, node );
+
+	if ( !tree->first || avl_cmp ( tree, node, tree->first ) < 0 )
+		tree->first = node;
+}
+
+/*! Remove object (given with its tree node) from tree */
+void *avl_remove ( avl_tree_t *tree, avl_node_t *node )
+{
+	avl_node_t *iter;
+
+	ASSERT ( tree && node );
+
+	tree->root = avl_del ( tree, tree->root, node );
+
+	if ( tree->first == node )
+	{
+		iter = tree->root;
+		while ( iter && iter->left )
+			iter = iter->left;
+		tree->first = iter;
+	}
+
+	return node->object;
+}
+
+/*! Get smallest object in tree (NULL if tree is empty) */
+void *avl_first ( avl_tree_t *tree )
+{
+	ASSERT ( tree );
+
+	if ( tree->first )
+		return tree->first->object;
+	else
+		return NULL;
+}
+
+/* compare keys; equal keys by node address */
+static int avl_cmp ( avl_tree_t *tree, avl_node_t *a, avl_node_t *b )
+{
+	int cmp = tree->cmp ( a->object, b->object );
+
+	if ( cmp )
+		return cmp;
+
+	return a < b ? -1 : ( a > b );
+}
+
+static void avl_update ( avl_node_t *node )
+{
+	int l = HEIGHT ( node->left ), r = HEIGHT ( node->right );
+
+	node->height = ( l > r ? l : r ) + 1;
+}
+
+static avl_node_t *avl_rotate_right ( avl_node_t *node )
+{
+	avl_node_t *l = node->left;
+
+	node->left = l->right;
+	l->right = node;
+	avl_update ( node );
+	avl_update ( l );
+
+	return l;
+}
+
+static avl_node_t *avl_rotate_left ( avl_node_t *node )
+{
+	avl_node_t *r = node->right;
+
+	node->right = r->left;
+	r->left = node;
+	avl_update ( node );
+	avl_update ( r );
+
+	return r;
+}
+
+/*! Restore balance of subtree (children are balanced) */
+static avl_node_t *avl_balance ( avl_node_t *node )
+{
+	int diff;
+
+	avl_update ( node );
+
+	diff = HEIGHT ( node->left ) - HEIGHT ( node->right );
+
+	if ( diff > 1 )
+	{
+		if ( HEIGHT ( node->left->left ) < HEIGHT ( node->left->right ) )
+			node->left = avl_rotate_left ( node->left );
+		return avl_rotate_right ( node );
+	}
+	if ( diff < -1 )
+	{
+		if ( HEIGHT ( node->right->right ) < HEIGHT ( node->right->left ) )
+			node->right = avl_rotate_right ( node->right );
+		return avl_rotate_left ( node );
+	}
+
+	return node;
+}
+
+static avl_node_t *avl_add ( avl_tree_t *tree, avl_node_t *root,
+			     avl_node_t *node )
+{
+	if ( !root )
+		return node;
+
+	if ( avl_cmp ( tree, node, root ) < 0 )
+		root->left = avl_add ( tree, root->left, node );
+	else
+		root->right = avl_add ( tree, root->right, node );
+
+	return avl_balance ( root );
+}
+
+/*! Detach smallest node from subtree */
+static avl_node_t *avl_remove_min ( avl_node_t *root, avl_node_t **min )
+{
+	if ( !root->left )
+	{
+		*min = root;
+		return root->right;
+	}
+
+	root->left = avl_remove_min ( root->left, min );
+
+	return avl_balance ( root );
+}
+
+static avl_node_t *avl_del ( avl_tree_t *tree, avl_node_t *root,
+			     avl_node_t *node )
+{
+	avl_node_t *min;
+
+	ASSERT ( root ); /* node must be in tree */
+
+	if ( root == node )
+	{
+		if ( !root->right )
+			return root->left;
+
+		/* replace node with smallest node from right subtree */
+		root->right = avl_remove_min ( root->right, &min );
+		min->left = root->left;
+		min->right = root->right;
+
+		return avl_balance ( min );
+	}
+
+	if ( avl_cmp ( tree, node, root ) < 0 )
+		root->left = avl_del ( tree, root->left, node );
+	else
+		root->right = avl_del ( tree, root->right, node );
+
+	return avl_balance ( root );
+}
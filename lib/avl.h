@@ -0,0 +1,33 @@
+/*! AVL tree - balanced binary search tree
+ *
+ * Tree node must be included in object that we want to put in tree (as with
+ * list elements, see list.h). Objects are ordered by given compare function,
+ * which must never return 0 for two different objects (e.g. when keys are
+ * equal compare object addresses).
+ */
+
+#pragma once
+
+/*! Tree node */
+typedef struct _avl_node_
+{
+	struct _avl_node_ *left;
+	struct _avl_node_ *right;
+	int height;	/* height of subtree (leaf has height 1) */
+	void *object;	/* pointer to object start */
+}
+avl_node_t;
+
+/*! Tree header */
+typedef struct _avl_tree_
+{
+	avl_node_t *root;
+	avl_node_t *first;	/* cached leftmost (smallest) node */
+	int (*cmp) ( void *, void * );	/* <0 when first is smaller */
+}
+avl_tree_t;
+
+void avl_init ( avl_tree_t *tree, int (*cmp) ( void *, void * ) );
+void avl_insert ( avl_tree_t *tree, void *object, avl_node_t *node );
+void *avl_remove ( avl_tree_t *tree, avl_node_t *node );
+void *avl_first ( avl_tree_t *tree );
@@ -23,5 +23,6 @@ enum {
 	E_RETRY,
 	E_EMPTY,
 	E_TOO_BIG,
-	E_DEADLINE
+	E_DEADLINE,
+	E_NOT_SCHEDULABLE
 };
@@ -0,0 +1,142 @@
+/*! Binary min-heap (priority queue) */
+
+#include "heap.h"
+
+#include <lib/types.h>
+#include ASSERT_H
+
+#define PARENT(I)	( ( (I) - 1 ) / 2 )
+#define LEFT(I)		( 2 * (I) + 1 )
+
+static void heap_up ( heap_t *heap, int i );
+static void heap_down ( heap_t *heap, int i );
+
+void heap_init ( heap_t *heap, heap_node_t **array, int max,
+		 int (*cmp) ( void *, void * ) )
+{
+	ASSERT ( heap && array && max > 0 && cmp );
+
+	heap->node = array;
+	heap->size = 0;
+	heap->max = max;
+	heap->cmp = cmp;
+}
+
+/*! Move heap to new array of 'max' elements (old array can be released) */
+void heap_resize ( heap_t *heap, heap_node_t **array, int max )
+{
+	int i;
+
+	ASSERT ( heap && array && max >= heap->size && max > 0 );
+
+	for ( i = 0; i < heap->size; i++ )
+		array[i] = heap->node[i];
+
+	heap->node = array;
+	heap->max = max;
+}
+
+/*!
+ * Add object to heap; 'node' is heap node inside object
+ * \return 0 if added, -1 if heap is full
+ */
+int heap_insert ( heap_t *heap, void *object, heap_node_t *node )
+{
+	ASSERT ( heap && node && node->index < 0 );
+
+	if ( heap->size >= heap->max )
+		return -1;
+
+	node->object = object;
+	node->index = heap->size++;
+	heap->node[node->index] = node;
+
+	heap_up ( heap, node->index );
+
+	return 0;
+}
+
+/*! Remove object (given with its heap node) from heap */
+void *heap_remove ( heap_t *heap, heap_node_t *node )
+{
+	int i;
+
+	ASSERT ( heap && node && node->index >= 0 && node->index < heap->size &&
+		 heap->node[node->index] == node );
+
+	i = node->index;
+	node->index = -1;
+
+	if ( i != --heap->size )
+	{
+		/* move last element to freed place */
+		heap->node[i] = heap->node[heap->size];
+		heap->node[i]->index = i;
+		heap_update ( heap, heap->node[i] );
+	}
+
+	return node->object;
+}
+
+/*! Restore heap order after object key is changed */
+void heap_update ( heap_t *heap, heap_node_t *node )
+{
+	int i = node->index;
+
+	ASSERT ( heap && node && i >= 0 && i < heap->size );
+
+	heap_up ( heap, i );
+	if ( heap->node[i] == node )
+		heap_down ( heap, i );
+}
+
+/*! Get smallest object in heap (NULL if heap is empty) */
+void *heap_first ( heap_t *heap )
+{
+	ASSERT ( heap );
+
+	if ( heap->size )
+		return heap->node[0]->object;
+	else
+		return NULL;
+}
+
+static void heap_up ( heap_t *heap, int i )
+{
+	heap_node_t *node = heap->node[i];
+
+	while ( i > 0 &&
+		heap->cmp ( node->object, heap->node[PARENT(i)]->object ) < 0 )
+	{
+		heap->node[i] = heap->node[PARENT(i)];
+		heap->node[i]->index = i;
+		i = PARENT(i);
+	}
+
+	heap->node[i] = node;
+	node->index = i;
+}
+
+static void heap_down ( heap_t *heap, int i )
+{
+	heap_node_t *node = heap->node[i];
+	int child;
+
+	while ( ( child = LEFT(i) ) < heap->size )
+	{
+		if ( child + 1 < heap->size &&
+		     heap->cmp ( heap->node[child + 1]->object,
+				 heap->node[child]->object ) < 0 )
+			child++;
+
+		if ( heap->cmp ( heap->node[child]->object, node->object ) >= 0 )
+			break;
+
+		heap->node[i] = heap->node[child];
+		heap->node[i]->index = i;
+		i = child;
+	}
+
+	heap->node[i] = node;
+	node->index = i;
+}
@@ -0,0 +1,45 @@
+/*! Binary min-heap (priority queue)
+ *
+ * Heap node must be included in object that we want to put in heap (as with
+ * list elements, see list.h); node remembers its position in heap so any
+ * object can be removed or repositioned (after its key is changed) in
+ * O(log n). Array of node pointers is given by caller (and can be replaced
+ * with larger one with heap_resize).
+ */
+
+#pragma once
+
+/*! Heap node */
+typedef struct _heap_node_
+{
+	int index;	/* position in heap, -1 if not in heap */
+	void *object;	/* pointer to object start */
+}
+heap_node_t;
+
+/*! Heap header */
+typedef struct _heap_
+{
+	heap_node_t **node;	/* array of 'max' elements */
+	int size;
+	int max;
+	int (*cmp) ( void *, void * );	/* <0 when first is smaller */
+}
+heap_t;
+
+void heap_init ( heap_t *heap, heap_node_t **array, int max,
+		 int (*cmp) ( void *, void * ) );
+void heap_resize ( heap_t *heap, heap_node_t **array, int max );
+int heap_insert ( heap_t *heap, void *object, heap_node_t *node );
+void *heap_remove ( heap_t *heap, heap_node_t *node );
+void heap_update ( heap_t *heap, heap_node_t *node );
+void *heap_first ( heap_t *heap );
+
+static inline void heap_node_init ( heap_node_t *node )
+{
+	node->index = -1;
+}
+static inline int heap_node_in_heap ( heap_node_t *node )
+{
+	return node->index >= 0;
+}
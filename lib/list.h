@@ -64,6 +64,8 @@ list_t;
 void list_init ( list_t *list );
 void list_append ( list_t *list, void *object, list_h *hdr );
 void list_prepend ( list_t *list, void *object, list_h *hdr );
+void list_insert_after ( list_t *list, void *object, list_h *hdr,
+			 list_h *after );
 void list_sort_add ( list_t *list, void *object, list_h *hdr,
 				   int (*cmp) ( void *, void * ) );
 void *list_get ( list_t *list, unsigned int flags );
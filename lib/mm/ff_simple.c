@@ -143,6 +143,47 @@ int ffs_free ( ffs_mpool_t *mpool, void *chunk_to_be_freed )
 	return 0;
 }
 
+/*!
+ * Add memory segment to existing pool (e.g. when process is extended)
+ * - segment is separated from others with its own border chunks
+ * \param mpool Memory pool
+ * \param mem_segm Memory segment start address
+ * \param size Memory segment size
+ * \return 0 if successful, -1 if segment is too small
+ */
+int ffs_add_segment ( ffs_mpool_t *mpool, void *mem_segm, size_t size )
+{
+	size_t start, end;
+	ffs_hdr_t *chunk, *border;
+
+	ASSERT ( mpool && mem_segm );
+
+	start = (size_t) mem_segm;
+	end = start + size;
+	ALIGN_FW ( start );
+	ALIGN ( end );
+
+	if ( end <= start || end - start < 2 * sizeof (size_t) + HEADER_SIZE )
+		return -1;
+
+	border = (ffs_hdr_t *) start;
+	border->size = sizeof (size_t);
+	MARK_USED ( border );
+
+	chunk = GET_AFTER ( border );
+	chunk->size = end - start - 2 * sizeof(size_t);
+	MARK_FREE ( chunk );
+	CLONE_SIZE_TO_TAIL ( chunk );
+
+	border = GET_AFTER ( chunk );
+	border->size = sizeof (size_t);
+	MARK_USED ( border );
+
+	ffs_insert_chunk ( mpool, chunk );
+
+	return 0;
+}
+
 /*!
  * Routine that removes an chunk from 'free' list (free_list)
  * \param mpool Memory pool to be used
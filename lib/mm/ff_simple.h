@@ -22,6 +22,7 @@ typedef void ffs_mpool_t;
 void *ffs_init ( void *mem_segm, size_t size );
 void *ffs_alloc ( ffs_mpool_t *mpool, size_t size );
 int ffs_free ( ffs_mpool_t *mpool, void *chunk_to_be_freed );
+int ffs_add_segment ( ffs_mpool_t *mpool, void *mem_segm, size_t size );
 
 /*! rest is only for first_fit.c */
 #else /* _FF_SIMPLE_C_ */
@@ -76,6 +77,7 @@ ffs_mpool_t;
 void *ffs_init ( void *mem_segm, size_t size );
 void *ffs_alloc ( ffs_mpool_t *mpool, size_t size );
 int ffs_free ( ffs_mpool_t *mpool, void *chunk_to_be_freed );
+int ffs_add_segment ( ffs_mpool_t *mpool, void *mem_segm, size_t size );
 
 static void ffs_remove_chunk ( ffs_mpool_t *mpool, ffs_hdr_t *chunk );
 static void ffs_insert_chunk ( ffs_mpool_t *mpool, ffs_hdr_t *chunk );
@@ -79,6 +79,49 @@ gma_t *gma_init ( void *memory_segment, size_t size, size_t min_chunk_size,
 	return mpool;
 }
 
+/*!
+ * Add memory segment to existing pool (e.g. when process is extended)
+ * - segment is separated from others with border chunks; if it is larger than
+ *   largest chunk pool can hold (set in gma_init), it is split in more parts
+ * \param mpool Memory pool pointer, or NULL (for default)
+ * \param memory_segment Memory segment start address
+ * \param size Memory segment size
+ * \return 0 if successful, -1 if segment is too small
+ */
+int gma_add_segment ( gma_t *mpool, void *memory_segment, size_t size )
+{
+	size_t addr, end, part, max_part, min_part;
+	void *chunk;
+
+	ASSERT ( memory_segment );
+
+	if ( mpool == NULL )
+		mpool = &pool;
+
+	addr = CHUNK_ALIGN_FW ( memory_segment );
+	end = CHUNK_ALIGN ( memory_segment + size );
+
+	max_part = CHUNK_ALIGN ( (size_t) 1 << mpool->fl_max );
+	min_part = 2 * BORDER_CHUNK_SIZE + mpool->min_chunk_size;
+
+	if ( end <= addr || end - addr <= min_part )
+		return -1;
+
+	while ( end - addr > min_part )
+	{
+		part = end - addr;
+		if ( part > max_part )
+			part = max_part;
+
+		chunk = make_first_chunk ( (void *) addr, part );
+		gma_free ( mpool, chunk );
+
+		addr += part;
+	}
+
+	return 0;
+}
+
 /*!
  * Memory allocation for chunk of size 'size'
  * \param mpool Memory pool pointer, or NULL (for default)
@@ -189,6 +189,7 @@ gma_t *gma_init ( void *memory_segment, size_t size, size_t min_chunk_size,
 		    uint flags );
 void *gma_alloc ( gma_t *mpool, size_t size );
 int gma_free ( gma_t *mpool, void *address );
+int gma_add_segment ( gma_t *mpool, void *memory_segment, size_t size );
 
 #else /* _GMA_C_ */
 
@@ -467,6 +468,7 @@ gma_t *gma_init ( void *memory_segment, size_t size, size_t min_chunk_size,
 		  uint flags );
 void *gma_alloc ( gma_t *mpool, size_t size );
 int gma_free ( gma_t *mpool, void *address );
+int gma_add_segment ( gma_t *mpool, void *memory_segment, size_t size );
 
 static int get_indexes(gma_t *mpool,size_t size,size_t *fl,size_t *sl,int ins);
 static inline void set_list_have_chunks ( gma_t *mpool, size_t fl, size_t sl );
@@ -478,7 +480,6 @@ static mchunk_t *remove_first_chunk_from_free_list ( gma_t *mpool, size_t fl,
 						     size_t sl );
 
 /* ToDo:
-   int extend_mpool ( gma_t *mpool, size_t size_to_add_to_the_end_of_mpool );
    int shrink_mpool ( gma_t *mpool, size_t size_at_end_of_mpool_to_release );
 */
 #endif /* _GMA_C_ */
@@ -22,10 +22,12 @@ typedef void ffs_mpool_t;
 void *ffs_init ( void *mem_segm, size_t size );
 void *ffs_alloc ( ffs_mpool_t *mpool, size_t size );
 int ffs_free ( ffs_mpool_t *mpool, void *chunk_to_be_freed );
+int ffs_add_segment ( ffs_mpool_t *mpool, void *mem_segm, size_t size );
 
 #define	MEM_INIT(ADDR, SIZE)		ffs_init ( ADDR, SIZE )
 #define MEM_ALLOC(MP, SIZE)		ffs_alloc ( MP, SIZE )
 #define MEM_FREE(MP, ADDR)		ffs_free ( MP, ADDR )
+#define MEM_ADD(MP, ADDR, SIZE)		ffs_add_segment ( MP, ADDR, SIZE )
 
 #elif defined ( GMA )
 
@@ -35,10 +37,12 @@ gma_t *gma_init ( void *memory_segment, size_t size, size_t min_chunk_size,
 		    uint flags );
 void *gma_alloc ( gma_t *mpool, size_t size );
 int gma_free ( gma_t *mpool, void *address );
+int gma_add_segment ( gma_t *mpool, void *memory_segment, size_t size );
 
 #define	MEM_INIT(ADDR, SIZE)		gma_init ( ADDR, SIZE, 32, 0 )
 #define MEM_ALLOC(MP, SIZE)		gma_alloc ( MP, SIZE )
 #define MEM_FREE(MP, ADDR)		gma_free ( MP, ADDR )
+#define MEM_ADD(MP, ADDR, SIZE)		gma_add_segment ( MP, ADDR, SIZE )
 
 #endif
 
@@ -59,7 +63,7 @@ int main ()
 		unsigned int size;
 	}
 	m[requests];
-	void *pool, *mpool;
+	void *pool, *mpool, *pool2, *ptr;
 	struct timespec t1, t2;
 
 	if ( ( pool = malloc ( pool_size ) ) == NULL )
@@ -182,5 +186,34 @@ int main ()
 
 	printf ( "End of tests (i=%d, fail=%d, inuse=%d)!\n", i, fail, inuse );
 
+	/* extend pool with new segment; when pool is full, rest of requests
+	   must be served from new segment */
+	if ( ( pool2 = malloc ( pool_size ) ) == NULL )
+	{
+		printf ( "Malloc return NULL\n" );
+		return 1;
+	}
+
+	if ( MEM_ADD ( mpool, pool2, pool_size ) )
+	{
+		printf ( "Adding segment failed!\n" );
+		return 1;
+	}
+
+	for ( k = 0; ( ptr = MEM_ALLOC ( mpool, max_block_size ) ) != NULL; )
+	{
+		memset ( ptr, 7, max_block_size );
+		if ( ptr >= pool2 && ptr < pool2 + pool_size )
+			k++;
+	}
+
+	printf ( "Added segment: %d blocks allocated from it\n", k );
+
+	if ( k < pool_size / ( max_block_size + 64 ) )
+	{
+		printf ( "Added segment not used!\n" );
+		return 1;
+	}
+
 	return 0;
 }
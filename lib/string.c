@@ -287,7 +287,7 @@ void itoa ( char *buf, int base, int d )
 {
 	char *p = buf;
 	char *p1, *p2, firsthexchar;
-	unsigned long ud = d;
+	unsigned int ud = d; /* 32 bits, also when built for 64-bit host */
 	int divisor = 10;
 	int digits = 0;
 
@@ -296,7 +296,7 @@ void itoa ( char *buf, int base, int d )
 	{
 		*p++ = '-';
 		buf++;
-		ud = -d;
+		ud = -ud;
 	}
 	else if ( base == 'x' || base == 'X' )
 	{
@@ -0,0 +1,147 @@
+/*! Host tests and benchmarks for lib/: test driver and libc wrappers
+ *
+ * Usage: libtest [bench] [suite ...]
+ *   without "bench" correctness tests are run, with it only benchmarks;
+ *   suites: string bits list mm print (all if none given)
+ */
+
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+int test_failed;
+
+static struct {
+	char *name;
+	void (*test) ();
+	void (*bench) ();
+}
+suite[] = {
+	{ "string",	test_string,	bench_string },
+	{ "bits",	test_bits,	bench_bits },
+	{ "list",	test_list,	bench_list },
+	{ "mm",		test_mm,	bench_mm },
+	{ "print",	test_print,	bench_print },
+	{ NULL,		NULL,		NULL }
+};
+
+int main ( int argc, char *argv[] )
+{
+	int bench = 0, first = 1, i, j, failed;
+
+	if ( argc > 1 && !strcmp ( argv[1], "bench" ) )
+	{
+		bench = 1;
+		first = 2;
+	}
+
+	srand48 ( 12345 ); /* same sequence on every run */
+
+	for ( i = 0; suite[i].name; i++ )
+	{
+		if ( argc > first )
+		{
+			for ( j = first; j < argc; j++ )
+				if ( !strcmp ( argv[j], suite[i].name ) )
+					break;
+			if ( j == argc )
+				continue;
+		}
+
+		if ( bench )
+		{
+			suite[i].bench ();
+			continue;
+		}
+
+		failed = test_failed;
+		suite[i].test ();
+		printf ( "%s: %s\n", suite[i].name,
+			 failed == test_failed ? "OK" : "FAILED" );
+	}
+
+	if ( !bench )
+		printf ( "%s\n", test_failed ? "FAILED" : "All tests passed" );
+
+	return test_failed != 0;
+}
+
+void bench_report ( char *name, long n, unsigned long long ns )
+{
+	printf ( "B %s %ld %.2f ns\n", name, n, (double) ns / n );
+}
+
+unsigned long long test_time_ns ()
+{
+	struct timespec t;
+
+	clock_gettime ( CLOCK_MONOTONIC, &t );
+
+	return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+unsigned int test_rand ()
+{
+	return lrand48 ();
+}
+
+void *test_malloc ( size_t size )
+{
+	return malloc ( size );
+}
+
+void test_free ( void *ptr )
+{
+	free ( ptr );
+}
+
+/* libc reference functions */
+void *ref_memset ( void *s, int c, size_t n )
+{
+	return memset ( s, c, n );
+}
+void *ref_memcpy ( void *dest, const void *src, size_t n )
+{
+	return memcpy ( dest, src, n );
+}
+void *ref_memmove ( void *dest, const void *src, size_t n )
+{
+	return memmove ( dest, src, n );
+}
+int ref_memcmp ( const void *m1, const void *m2, size_t n )
+{
+	return memcmp ( m1, m2, n );
+}
+size_t ref_strlen ( const char *s )
+{
+	return strlen ( s );
+}
+int ref_strcmp ( const char *s1, const char *s2 )
+{
+	return strcmp ( s1, s2 );
+}
+int ref_strncmp ( const char *s1, const char *s2, size_t n )
+{
+	return strncmp ( s1, s2, n );
+}
+char *ref_strchr ( const char *s, int c )
+{
+	return strchr ( s, c );
+}
+char *ref_strstr ( const char *s1, const char *s2 )
+{
+	return strstr ( s1, s2 );
+}
+
+/* lib/ itoa format: hexadecimal with "0x" and 8 digits */
+void ref_itoa ( char *buf, int base, int d )
+{
+	switch ( base ) {
+	case 'd': sprintf ( buf, "%d", d ); break;
+	case 'u': sprintf ( buf, "%u", (unsigned int) d ); break;
+	case 'x': sprintf ( buf, "0x%08x", (unsigned int) d ); break;
+	case 'X': sprintf ( buf, "0x%08X", (unsigned int) d ); break;
+	}
+}
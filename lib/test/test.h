@@ -0,0 +1,78 @@
+/*! Host (native) tests and benchmarks for lib/ (see Makefile)
+ *
+ * Used as ASSERT_H when lib/ sources are compiled for host. Only <stddef.h>
+ * and <stdio.h> are included here: other libc headers (e.g. <stdlib.h>,
+ * <time.h>) define types with same names as lib/types.h (time_t), so all
+ * libc services are wrapped in test.c (which does not include lib/ headers).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+
+#undef NULL	/* lib/types.h defines it (same value) */
+
+extern void exit ( int status );
+
+#define ASSERT(expr)					\
+do if ( !( expr ) )					\
+{							\
+	printf ( "[BUG:%s:%d]\n", __FILE__, __LINE__);	\
+	exit (1);					\
+} while(0)
+
+#define LOG(level, format, ...)	\
+printf ( "[" #level ":%s:%d]" format "\n", __FILE__, __LINE__, ##__VA_ARGS__)
+
+/*! Tests: failed check is reported and counted, test continues */
+extern int test_failed;
+
+#define CHECK(expr)						\
+do if ( !( expr ) )						\
+{								\
+	printf ( "[FAIL:%s:%d] %s\n", __FILE__, __LINE__, #expr );	\
+	test_failed++;						\
+} while(0)
+
+/*! Benchmarks: run 'BODY' 'N' times, print "B <name> <N> <ns/op> ns" */
+#define BENCH(NAME, N, BODY)					\
+do {								\
+	unsigned long long start_ = test_time_ns ();		\
+	long iter_;						\
+	for ( iter_ = 0; iter_ < (N); iter_++ )			\
+	{ BODY; }						\
+	bench_report ( NAME, N, test_time_ns () - start_ );	\
+} while(0)
+
+void bench_report ( char *name, long n, unsigned long long ns );
+
+/*! libc services (test.c) */
+unsigned long long test_time_ns ();
+unsigned int test_rand ();
+void *test_malloc ( size_t size );
+void test_free ( void *ptr );
+
+/*! libc reference implementations for differential tests (test.c) */
+void *ref_memset ( void *s, int c, size_t n );
+void *ref_memcpy ( void *dest, const void *src, size_t n );
+void *ref_memmove ( void *dest, const void *src, size_t n );
+int ref_memcmp ( const void *m1, const void *m2, size_t n );
+size_t ref_strlen ( const char *s );
+int ref_strcmp ( const char *s1, const char *s2 );
+int ref_strncmp ( const char *s1, const char *s2, size_t n );
+char *ref_strchr ( const char *s, int c );
+char *ref_strstr ( const char *s1, const char *s2 );
+void ref_itoa ( char *buf, int base, int d );
+
+/*! Test suites */
+void test_string ();
+void bench_string ();
+void test_bits ();
+void bench_bits ();
+void test_list ();
+void bench_list ();
+void test_mm ();
+void bench_mm ();
+void test_print ();
+void bench_print ();
@@ -0,0 +1,113 @@
+/*! Tests for lib/bits.h (arch versions) and lib/bits_generic.h */
+
+#include "test.h"
+
+#include <lib/bits.h>
+
+/* generic versions are used only when arch layer lacks them; test anyway */
+#ifndef REQUIRE_BITS_GENERIC
+#define REQUIRE_BITS_GENERIC
+#include <lib/bits_generic.h>
+#endif
+
+#define RANDOM_TESTS	1000000
+
+static int ref_msb ( unsigned long long num )
+{
+	int i;
+
+	for ( i = 63; i > 0 && !( num >> i ); i-- )
+		;
+	return i;
+}
+
+static int ref_lsb ( unsigned long long num )
+{
+	int i;
+
+	for ( i = 0; i < 63 && !( ( num >> i ) & 1 ); i++ )
+		;
+	return i;
+}
+
+static unsigned long long random64 ()
+{
+	unsigned long long r;
+
+	r = ( (unsigned long long) test_rand () << 33 ) ^
+	    ( (unsigned long long) test_rand () << 11 ) ^ test_rand ();
+
+	/* variable magnitude */
+	r >>= test_rand () % 64;
+
+	return r ? r : 1;
+}
+
+void test_bits ()
+{
+	unsigned long long n64, prod;
+	uint32 n, a, b, c;
+	uint seed = 1;
+	int i;
+
+	for ( i = 0; i < 64; i++ )
+	{
+		n64 = 1ULL << i;
+		CHECK ( msb_index_64 ( n64 ) == i );
+		CHECK ( msb_index_int_n ( n64 | ( n64 >> 1 ) ) == i );
+		if ( i < 32 )
+		{
+			CHECK ( msb_index ( (uint32) n64 ) == i );
+			CHECK ( lsb_index ( (uint32) n64 ) == i );
+			CHECK ( msb_index_32 ( (uint32) n64 ) == i );
+			CHECK ( msb_index_generic ( (uint32) n64 ) == i );
+		}
+	}
+
+	for ( i = 0; i < RANDOM_TESTS; i++ )
+	{
+		n64 = random64 ();
+		n = (uint32) n64 ? (uint32) n64 : 1;
+
+		CHECK ( msb_index_64 ( n64 ) == ref_msb ( n64 ) );
+		CHECK ( msb_index_int_n ( n64 ) == ref_msb ( n64 ) );
+		CHECK ( msb_index ( n ) == ref_msb ( n ) );
+		CHECK ( lsb_index ( n ) == ref_lsb ( n ) );
+		CHECK ( msb_index_32 ( n ) == ref_msb ( n ) );
+		CHECK ( msb_index_generic ( n ) == ref_msb ( n ) );
+
+		/* a*b/c; quotient must fit in 32 bits */
+		a = (uint32) random64 ();
+		b = (uint32) random64 ();
+		c = (uint32) random64 ();
+		if ( !c )
+			c = 1;
+		prod = (unsigned long long) a * b;
+		if ( prod / c <= 0xffffffffULL )
+			CHECK ( mul_div_32 ( a, b, c ) == prod / c );
+	}
+
+	/* pseudo random generator: range and period not trivially short */
+	n = rand ( &seed );
+	for ( i = 0; i < 1000; i++ )
+	{
+		a = rand ( &seed );
+		CHECK ( a <= RAND_MAX );
+	}
+	CHECK ( a != n || rand ( &seed ) != rand ( &seed ) );
+}
+
+void bench_bits ()
+{
+	volatile uint32 sink;
+
+	BENCH ( "msb_index", 10000000, sink = msb_index ( iter_ | 1 ) );
+	BENCH ( "lsb_index", 10000000, sink = lsb_index ( iter_ | 1 ) );
+	BENCH ( "msb_index_32", 10000000, sink = msb_index_32 ( iter_ | 1 ) );
+	BENCH ( "msb_index_generic", 10000000,
+		sink = msb_index_generic ( iter_ | 1 ) );
+	BENCH ( "mul_div_32", 10000000,
+		sink = mul_div_32 ( iter_, 1000000, 4096 ) );
+
+	(void) sink;
+}
@@ -0,0 +1,418 @@
+/*! Tests for lib/list.c, lib/heap.c and lib/avl.c: random operations
+ *  compared with simple reference model (array of keys)
+ */
+
+#include "test.h"
+
+#include <lib/list.h>
+#include <lib/heap.h>
+#include <lib/avl.h>
+#include <lib/types.h>
+
+#define ELEMS		1000
+#define RANDOM_TESTS	200000
+
+typedef struct _elem_
+{
+	int key;
+	int in;		/* in tested structure? */
+
+	list_h list;
+	heap_node_t heap;
+	avl_node_t avl;
+}
+elem_t;
+
+static elem_t elem[ELEMS];
+
+static int elem_cmp ( void *a, void *b )
+{
+	elem_t *x = a, *y = b;
+
+	return x->key - y->key;
+}
+
+/* smallest key among elements in structure (reference) */
+static int ref_min ()
+{
+	int i, min = -1;
+
+	for ( i = 0; i < ELEMS; i++ )
+		if ( elem[i].in && ( min < 0 || elem[i].key < elem[min].key ) )
+			min = i;
+
+	return min;
+}
+
+static void reset ()
+{
+	int i;
+
+	for ( i = 0; i < ELEMS; i++ )
+	{
+		elem[i].key = test_rand () % ( ELEMS * 4 );
+		elem[i].in = 0;
+		heap_node_init ( &elem[i].heap );
+	}
+}
+
+/* walk whole list checking links and count; for sorted lists also order */
+static int list_check ( list_t *list, int sorted )
+{
+	list_h *iter, *prev = NULL;
+	int n = 0;
+
+	for ( iter = list->first; iter; prev = iter, iter = iter->next )
+	{
+		CHECK ( iter->prev == prev );
+		CHECK ( ( (elem_t *) iter->object )->in );
+		if ( sorted && prev )
+			CHECK ( elem_cmp ( prev->object, iter->object ) <= 0 );
+		n++;
+	}
+	CHECK ( list->last == prev );
+
+	return n;
+}
+
+static void test_list_ops ()
+{
+	list_t list;
+	elem_t *e;
+	int i, j, n = 0, sorted;
+
+	for ( sorted = 0; sorted < 2; sorted++ )
+	{
+		reset ();
+		list_init ( &list );
+		n = 0;
+
+		for ( i = 0; i < RANDOM_TESTS; i++ )
+		{
+			j = test_rand () % ELEMS;
+			e = &elem[j];
+
+			if ( !e->in )
+			{
+				if ( sorted )
+					list_sort_add ( &list, e, &e->list,
+							elem_cmp );
+				else if ( i % 4 == 0 )
+					list_append ( &list, e, &e->list );
+				else if ( i % 4 == 1 )
+					list_prepend ( &list, e, &e->list );
+				else if ( i % 4 == 2 )
+					list_insert_after ( &list, e, &e->list,
+							    list.last );
+				else /* in middle, or first if < 2 elements */
+					list_insert_after ( &list, e, &e->list,
+						list.last ? list.last->prev : NULL );
+				e->in = 1;
+				n++;
+			}
+			else if ( i % 3 == 0 )
+			{
+				CHECK ( list_find_and_remove ( &list, &e->list )
+					== e );
+				e->in = 0;
+				n--;
+			}
+			else if ( i % 3 == 1 )
+			{
+				CHECK ( list_remove ( &list, 0, &e->list ) == e );
+				e->in = 0;
+				n--;
+			}
+			else {
+				e = list_remove ( &list, i % 2 ? LAST : FIRST,
+						  NULL );
+				CHECK ( e != NULL );
+				if ( e )
+					e->in = 0;
+				n--;
+			}
+
+			if ( sorted && n )
+				CHECK ( ( (elem_t *) list_get ( &list, FIRST ) )
+					->key == elem[ref_min ()].key );
+
+			if ( i % 1000 == 0 )
+				CHECK ( list_check ( &list, sorted ) == n );
+		}
+		CHECK ( list_check ( &list, sorted ) == n );
+	}
+}
+
+static void test_heap_ops ()
+{
+	heap_node_t *array[ELEMS];
+	heap_t heap;
+	elem_t *e;
+	int i, j, min, n = 0;
+
+	reset ();
+	heap_init ( &heap, array, ELEMS, elem_cmp );
+
+	CHECK ( heap_first ( &heap ) == NULL );
+
+	for ( i = 0; i < RANDOM_TESTS; i++ )
+	{
+		j = test_rand () % ELEMS;
+		e = &elem[j];
+
+		if ( !e->in )
+		{
+			CHECK ( heap_insert ( &heap, e, &e->heap ) == 0 );
+			e->in = 1;
+			n++;
+		}
+		else if ( i % 2 )
+		{
+			/* change key */
+			e->key = test_rand () % ( ELEMS * 4 );
+			heap_update ( &heap, &e->heap );
+		}
+		else {
+			CHECK ( heap_remove ( &heap, &e->heap ) == e );
+			CHECK ( !heap_node_in_heap ( &e->heap ) );
+			e->in = 0;
+			n--;
+		}
+
+		CHECK ( heap.size == n );
+		min = ref_min ();
+		if ( min >= 0 )
+			CHECK ( ( (elem_t *) heap_first ( &heap ) )->key ==
+				elem[min].key );
+		else
+			CHECK ( heap_first ( &heap ) == NULL );
+	}
+
+	/* full heap */
+	for ( i = 0; i < ELEMS; i++ )
+		if ( !elem[i].in )
+			heap_insert ( &heap, &elem[i], &elem[i].heap );
+	CHECK ( heap.size == ELEMS );
+	heap_node_init ( &elem[0].heap );
+	CHECK ( heap_insert ( &heap, &elem[0], &elem[0].heap ) == -1 );
+}
+
+/* start with small array, move heap to larger one whenever it is full */
+static void test_heap_resize ()
+{
+	heap_node_t **array, **old;
+	heap_t heap;
+	elem_t *e;
+	int i, max = 4, key = -1;
+
+	reset ();
+	array = test_malloc ( max * sizeof (heap_node_t *) );
+	heap_init ( &heap, array, max, elem_cmp );
+
+	for ( i = 0; i < ELEMS; i++ )
+	{
+		if ( heap_insert ( &heap, &elem[i], &elem[i].heap ) )
+		{
+			CHECK ( heap.size == max );
+			old = array;
+			max *= 2;
+			array = test_malloc ( max * sizeof (heap_node_t *) );
+			heap_resize ( &heap, array, max );
+			test_free ( old );
+
+			CHECK ( heap_insert ( &heap, &elem[i], &elem[i].heap )
+				== 0 );
+		}
+		elem[i].in = 1;
+	}
+	CHECK ( heap.size == ELEMS );
+
+	/* all elements must come out in order */
+	for ( i = 0; i < ELEMS; i++ )
+	{
+		e = heap_first ( &heap );
+		CHECK ( e && e->key >= key && e->key == elem[ref_min ()].key );
+		key = e->key;
+		CHECK ( heap_remove ( &heap, &e->heap ) == e );
+		e->in = 0;
+	}
+	CHECK ( heap_first ( &heap ) == NULL );
+
+	test_free ( array );
+}
+
+/* check AVL properties; return height */
+static int avl_check ( avl_node_t *node, int *count )
+{
+	int l, r;
+
+	if ( !node )
+		return 0;
+
+	(*count)++;
+
+	if ( node->left )
+		CHECK ( elem_cmp ( node->left->object, node->object ) <= 0 );
+	if ( node->right )
+		CHECK ( elem_cmp ( node->object, node->right->object ) <= 0 );
+
+	l = avl_check ( node->left, count );
+	r = avl_check ( node->right, count );
+
+	CHECK ( l - r >= -1 && l - r <= 1 );
+	CHECK ( node->height == ( l > r ? l : r ) + 1 );
+
+	return ( l > r ? l : r ) + 1;
+}
+
+static void test_avl_ops ()
+{
+	avl_tree_t tree;
+	elem_t *e;
+	int i, j, min, n = 0, count;
+
+	reset ();
+	avl_init ( &tree, elem_cmp );
+
+	CHECK ( avl_first ( &tree ) == NULL );
+
+	for ( i = 0; i < RANDOM_TESTS; i++ )
+	{
+		j = test_rand () % ELEMS;
+		e = &elem[j];
+
+		if ( !e->in )
+		{
+			avl_insert ( &tree, e, &e->avl );
+			e->in = 1;
+			n++;
+		}
+		else {
+			CHECK ( avl_remove ( &tree, &e->avl ) == e );
+			e->in = 0;
+			n--;
+		}
+
+		min = ref_min ();
+		if ( min >= 0 )
+			CHECK ( ( (elem_t *) avl_first ( &tree ) )->key ==
+				elem[min].key );
+		else
+			CHECK ( avl_first ( &tree ) == NULL );
+
+		if ( i % 1000 == 0 )
+		{
+			count = 0;
+			avl_check ( tree.root, &count );
+			CHECK ( count == n );
+		}
+	}
+}
+
+/* is 'node' in (sub)tree? (searched by address, not by key) */
+static int avl_contains ( avl_node_t *root, avl_node_t *node )
+{
+	if ( !root )
+		return 0;
+
+	return root == node || avl_contains ( root->left, node ) ||
+		avl_contains ( root->right, node );
+}
+
+/* many equal keys: removal must unlink given node, not any with same key */
+static void test_avl_dups ()
+{
+	avl_tree_t tree;
+	int i, j, n = 0, count;
+
+	for ( i = 0; i < ELEMS; i++ )
+	{
+		elem[i].key = i % 3;
+		elem[i].in = 0;
+	}
+
+	avl_init ( &tree, elem_cmp );
+
+	for ( i = 0; i < ELEMS; i++ )
+	{
+		avl_insert ( &tree, &elem[i], &elem[i].avl );
+		elem[i].in = 1;
+		n++;
+	}
+
+	/* remove in "random" order (7 is coprime with ELEMS) */
+	for ( i = 0, j = 0; i < ELEMS; i++, j = ( j + 7 ) % ELEMS )
+	{
+		CHECK ( avl_remove ( &tree, &elem[j].avl ) == &elem[j] );
+		elem[j].in = 0;
+		n--;
+
+		CHECK ( !avl_contains ( tree.root, &elem[j].avl ) );
+
+		count = 0;
+		avl_check ( tree.root, &count );
+		CHECK ( count == n );
+
+		if ( n )
+			CHECK ( ( (elem_t *) avl_first ( &tree ) )->key ==
+				elem[ref_min ()].key );
+		else
+			CHECK ( avl_first ( &tree ) == NULL );
+	}
+}
+
+void test_list ()
+{
+	test_list_ops ();
+	test_heap_ops ();
+	test_heap_resize ();
+	test_avl_ops ();
+	test_avl_dups ();
+}
+
+void bench_list ()
+{
+	heap_node_t *array[ELEMS];
+	list_t list;
+	heap_t heap;
+	avl_tree_t tree;
+	int i;
+
+	reset ();
+
+	/* list: append + remove first (FIFO queue) */
+	list_init ( &list );
+	for ( i = 0; i < ELEMS / 2; i++ )
+		list_append ( &list, &elem[i], &elem[i].list );
+	BENCH ( "list_append_remove", 10000000,
+		elem_t *e = list_remove ( &list, FIRST, NULL );
+		list_append ( &list, e, &e->list ) );
+
+	/* sorted list with ELEMS/2 elements: remove first, insert by key */
+	list_init ( &list );
+	for ( i = 0; i < ELEMS / 2; i++ )
+		list_sort_add ( &list, &elem[i], &elem[i].list, elem_cmp );
+	BENCH ( "list_sort_add_500", 100000,
+		elem_t *e = list_remove ( &list, FIRST, NULL );
+		e->key = test_rand () % ( ELEMS * 4 );
+		list_sort_add ( &list, e, &e->list, elem_cmp ) );
+
+	/* heap and AVL tree with ELEMS/2 elements: same operation */
+	heap_init ( &heap, array, ELEMS, elem_cmp );
+	for ( i = 0; i < ELEMS / 2; i++ )
+		heap_insert ( &heap, &elem[i], &elem[i].heap );
+	BENCH ( "heap_remove_insert_500", 1000000,
+		elem_t *e = heap_first ( &heap );
+		heap_remove ( &heap, &e->heap );
+		e->key = test_rand () % ( ELEMS * 4 );
+		heap_insert ( &heap, e, &e->heap ) );
+
+	avl_init ( &tree, elem_cmp );
+	for ( i = 0; i < ELEMS / 2; i++ )
+		avl_insert ( &tree, &elem[i], &elem[i].avl );
+	BENCH ( "avl_remove_insert_500", 1000000,
+		elem_t *e = avl_first ( &tree );
+		avl_remove ( &tree, &e->avl );
+		e->key = test_rand () % ( ELEMS * 4 );
+		avl_insert ( &tree, e, &e->avl ) );
+}
@@ -0,0 +1,201 @@
+/*! Tests for lib/mm allocators (first fit and GMA): random allocations and
+ *  frees checked against model of used blocks (no overlap, inside pool,
+ *  aligned, contents preserved); pool must be whole again at the end
+ */
+
+#include "test.h"
+
+#include <lib/mm/ff_simple.h>
+#include <lib/mm/gma.h>
+#include <lib/types.h>
+
+#define POOL_SIZE	( 1 << 20 )
+#define BLOCKS		1000
+#define MAX_BLOCK	1500
+#define RANDOM_TESTS	200000
+
+typedef struct _allocator_
+{
+	char *name;
+	void *(*init) ( void *addr, size_t size );
+	void *(*alloc) ( void *mpool, size_t size );
+	int (*free) ( void *mpool, void *ptr );
+	int (*add) ( void *mpool, void *addr, size_t size );
+}
+allocator_t;
+
+static void *gma_init_test ( void *addr, size_t size )
+{
+	return gma_init ( addr, size, 32, 0 );
+}
+
+static allocator_t allocator[] = {
+	{ "ff",  ffs_init, ffs_alloc, ffs_free, ffs_add_segment },
+	{ "gma", gma_init_test, gma_alloc, gma_free, gma_add_segment },
+	{ NULL, NULL, NULL, NULL, NULL }
+};
+
+static struct {
+	unsigned char *ptr;
+	size_t size;
+	unsigned char fill;
+}
+block[BLOCKS];
+
+static int block_valid ( int i )
+{
+	size_t j;
+
+	for ( j = 0; j < block[i].size; j++ )
+		if ( block[i].ptr[j] != block[i].fill )
+			return 0;
+	return 1;
+}
+
+static int overlaps ( int i )
+{
+	int j;
+
+	for ( j = 0; j < BLOCKS; j++ )
+		if ( j != i && block[j].ptr &&
+		     block[i].ptr < block[j].ptr + block[j].size &&
+		     block[j].ptr < block[i].ptr + block[i].size )
+			return 1;
+	return 0;
+}
+
+static void test_allocator ( allocator_t *a )
+{
+	unsigned char *pool, *pool2, *p;
+	void *mpool;
+	int i, j, used = 0, fails = 0, from2;
+
+	pool = test_malloc ( POOL_SIZE );
+	pool2 = test_malloc ( POOL_SIZE );
+	mpool = a->init ( pool, POOL_SIZE );
+	CHECK ( mpool != NULL );
+
+	for ( i = 0; i < BLOCKS; i++ )
+		block[i].ptr = NULL;
+
+	for ( i = 0; i < RANDOM_TESTS; i++ )
+	{
+		j = test_rand () % BLOCKS;
+
+		if ( !block[j].ptr )
+		{
+			/* mostly small, sometimes large blocks */
+			block[j].size = test_rand () % ( i % 16 ?
+					MAX_BLOCK / 8 : MAX_BLOCK ) + 1;
+			block[j].ptr = a->alloc ( mpool, block[j].size );
+			if ( !block[j].ptr )
+			{
+				fails++;
+				continue;
+			}
+			used++;
+
+			CHECK ( block[j].ptr >= pool &&
+				block[j].ptr + block[j].size <=
+				pool + POOL_SIZE );
+			CHECK ( ( (size_t) block[j].ptr ) %
+				sizeof (size_t) == 0 );
+			if ( i % 16 == 0 )
+				CHECK ( !overlaps ( j ) );
+
+			block[j].fill = test_rand ();
+			ref_memset ( block[j].ptr, block[j].fill,
+				     block[j].size );
+		}
+		else {
+			CHECK ( block_valid ( j ) );
+			CHECK ( a->free ( mpool, block[j].ptr ) == 0 );
+			block[j].ptr = NULL;
+			used--;
+		}
+	}
+
+	/* pool is not too small for test to be useful */
+	CHECK ( fails < RANDOM_TESTS / 100 );
+
+	for ( i = 0; i < BLOCKS; i++ )
+	{
+		if ( block[i].ptr )
+		{
+			CHECK ( block_valid ( i ) );
+			a->free ( mpool, block[i].ptr );
+			block[i].ptr = NULL;
+		}
+	}
+
+	/* all freed chunks must be joined again */
+	p = a->alloc ( mpool, POOL_SIZE - POOL_SIZE / 16 );
+	CHECK ( p != NULL );
+	if ( p )
+		a->free ( mpool, p );
+
+	/* when first segment is full, second one must be used */
+	CHECK ( a->add ( mpool, pool2, POOL_SIZE ) == 0 );
+	for ( from2 = 0; ( p = a->alloc ( mpool, MAX_BLOCK ) ) != NULL; )
+		if ( p >= pool2 && p < pool2 + POOL_SIZE )
+			from2++;
+	CHECK ( from2 > POOL_SIZE / ( MAX_BLOCK + 64 ) );
+
+	test_free ( pool );
+	test_free ( pool2 );
+}
+
+void test_mm ()
+{
+	int i;
+
+	for ( i = 0; allocator[i].name; i++ )
+		test_allocator ( &allocator[i] );
+}
+
+void bench_mm ()
+{
+	unsigned char *pool;
+	void *mpool, *ptr[BLOCKS];
+	char name[40];
+	int i, j;
+
+	pool = test_malloc ( POOL_SIZE );
+
+	for ( i = 0; allocator[i].name; i++ )
+	{
+		allocator_t *a = &allocator[i];
+
+		mpool = a->init ( pool, POOL_SIZE );
+
+		/* empty pool, same size */
+		sprintf ( name, "%s_alloc_free_64", a->name );
+		BENCH ( name, 1000000,
+			a->free ( mpool, a->alloc ( mpool, 64 ) ) );
+
+		/* fragmented pool: half of blocks used, random sizes */
+		for ( j = 0; j < BLOCKS; j++ )
+			ptr[j] = a->alloc ( mpool, test_rand () % 512 + 1 );
+		for ( j = 0; j < BLOCKS; j += 2 )
+		{
+			a->free ( mpool, ptr[j] );
+			ptr[j] = NULL;
+		}
+
+		sprintf ( name, "%s_alloc_free_fragmented", a->name );
+		BENCH ( name, 1000000,
+			j = test_rand () % BLOCKS;
+			if ( ptr[j] )
+			{
+				a->free ( mpool, ptr[j] );
+				ptr[j] = NULL;
+			}
+			else {
+				ptr[j] = a->alloc ( mpool,
+						    test_rand () % 512 + 1 );
+			}
+		);
+	}
+
+	test_free ( pool );
+}
@@ -0,0 +1,72 @@
+/*! Tests for lib/print.h (formatted print)
+ *
+ * print.h walks arguments on stack (i386 calling convention), so it can be
+ * tested only when harness is built for 32-bit host (make M32=1); in
+ * native 64-bit build tests are skipped.
+ */
+
+#include "test.h"
+
+#include <lib/string.h>
+#include <lib/types.h>
+
+#if defined ( __i386__ )
+
+static char out[1024];
+static int out_len;
+
+static void out_append ( char *text )
+{
+	while ( *text && out_len < sizeof (out) - 1 )
+		out[out_len++] = *text++;
+	out[out_len] = 0;
+}
+
+#define PRINT_FUNCTION_NAME	test_printf
+#define PRINT_ATTRIBUT		0
+#define DEVICE_SEND(TEXT,SZ)	out_append ( (TEXT).text )
+
+#include <lib/print.h>
+
+#define CHECK_PRINT(EXPECTED, FORMAT, ...)			\
+do {								\
+	out_len = 0;						\
+	test_printf ( FORMAT, ##__VA_ARGS__ );			\
+	CHECK ( !strcmp ( out, EXPECTED ) );			\
+} while(0)
+
+void test_print ()
+{
+	char long_str[200];
+
+	CHECK_PRINT ( "", "" );
+	CHECK_PRINT ( "abc", "abc" );
+	CHECK_PRINT ( "-12 34", "%d %u", -12, 34 );
+	CHECK_PRINT ( "0x0000abcd 0x0000ABCD", "%x %X", 0xabcd, 0xabcd );
+	CHECK_PRINT ( "[str] (null) c", "[%s] %s %c", "str", NULL, 'c' );
+
+	/* longer than internal buffer (TEXTSZ) */
+	memset ( long_str, 'x', sizeof (long_str) - 1 );
+	long_str[sizeof (long_str) - 1] = 0;
+	CHECK_PRINT ( long_str, "%s", long_str );
+}
+
+void bench_print ()
+{
+	BENCH ( "print_format", 1000000,
+		out_len = 0;
+		test_printf ( "%d %x %s\n", iter_, iter_, "text" ) );
+}
+
+#else /* !__i386__ */
+
+void test_print ()
+{
+	printf ( "print: skipped (needs 32-bit build: make M32=1)\n" );
+}
+
+void bench_print ()
+{
+}
+
+#endif /* __i386__ */
@@ -0,0 +1,197 @@
+/*! Tests for lib/string.c: differential tests against libc
+ *
+ * Compiled with lib/ names renamed (memset -> lib_memset, ...; see Makefile),
+ * so here libc functions are accessible only through ref_* wrappers.
+ */
+
+#include "test.h"
+
+#include <lib/string.h>
+#include <lib/types.h>
+
+int memcmp ( const void *m1, const void *m2, size_t size ); /* not in header */
+
+#define BUF_SIZE	4096
+#define RANDOM_TESTS	20000
+
+static char a[BUF_SIZE + 64], b[BUF_SIZE + 64], c[BUF_SIZE + 64];
+
+static int sign ( int x )
+{
+	return ( x > 0 ) - ( x < 0 );
+}
+
+/* random string of printable characters (lib/ compares 'char', signed) */
+static void random_string ( char *s, int len, int alphabet )
+{
+	int i;
+
+	for ( i = 0; i < len; i++ )
+		s[i] = 'a' + test_rand () % alphabet;
+	s[len] = 0;
+}
+
+static void fill_random ( char *buf, int size )
+{
+	int i;
+
+	for ( i = 0; i < size; i++ )
+		buf[i] = test_rand ();
+}
+
+static void test_mem ()
+{
+	int i, off, off2, len, v;
+
+	for ( i = 0; i < RANDOM_TESTS; i++ )
+	{
+		off = test_rand () % 32;
+		off2 = test_rand () % 32;
+		len = test_rand () % ( i % 8 ? 64 : BUF_SIZE );
+		v = test_rand ();
+
+		/* memset */
+		fill_random ( a, sizeof (a) );
+		ref_memcpy ( b, a, sizeof (a) );
+		CHECK ( memset ( a + off, v, len ) == a + off );
+		ref_memset ( b + off, v, len );
+		CHECK ( !ref_memcmp ( a, b, sizeof (a) ) );
+
+		/* memcpy */
+		fill_random ( c, sizeof (c) );
+		CHECK ( memcpy ( a + off, c + off2, len ) == a + off );
+		ref_memcpy ( b + off, c + off2, len );
+		CHECK ( !ref_memcmp ( a, b, sizeof (a) ) );
+
+		/* memmove, overlapping in both directions */
+		CHECK ( memmove ( a + off, a + off2, len ) == a + off );
+		ref_memmove ( b + off, b + off2, len );
+		CHECK ( !ref_memcmp ( a, b, sizeof (a) ) );
+
+		/* memcmp */
+		ref_memcpy ( c, a, sizeof (a) );
+		if ( len && i % 2 )
+			c[off + test_rand () % len] ^= 1 << test_rand () % 7;
+		CHECK ( sign ( memcmp ( a + off, c + off, len ) ) ==
+			sign ( ref_memcmp ( a + off, c + off, len ) ) );
+	}
+
+	/* 16-bit variants */
+	ref_memset ( b, 0, 16 );
+	memsetw ( a, 0xa5a5, 8 );
+	CHECK ( !ref_memcmp ( a, ref_memset ( b, 0xa5, 16 ), 16 ) );
+
+	for ( i = 0; i < 16; i++ )
+		a[i] = b[i] = i;
+	memmovew ( a + 2, a, 6 );
+	ref_memmove ( b + 2, b, 12 );
+	CHECK ( !ref_memcmp ( a, b, 16 ) );
+	memmovew ( a, a + 4, 6 );
+	ref_memmove ( b, b + 4, 12 );
+	CHECK ( !ref_memcmp ( a, b, 16 ) );
+}
+
+static void test_str ()
+{
+	int i, n, len1, len2;
+	char ch;
+
+	CHECK ( strlen ( "" ) == 0 );
+	CHECK ( strstr ( "abc", "" ) != NULL );
+	CHECK ( strstr ( "", "a" ) == NULL );
+
+	for ( i = 0; i < RANDOM_TESTS; i++ )
+	{
+		/* small alphabet - many equal prefixes and matches */
+		len1 = test_rand () % 40;
+		len2 = test_rand () % 6;
+		random_string ( a, len1, 1 + i % 4 );
+		if ( i % 3 )
+			random_string ( b, len2, 1 + i % 4 );
+		else
+			ref_memcpy ( b, a, len1 + 1 );
+
+		CHECK ( strlen ( a ) == ref_strlen ( a ) );
+		CHECK ( sign ( strcmp ( a, b ) ) ==
+			sign ( ref_strcmp ( a, b ) ) );
+
+		n = test_rand () % 10;
+		CHECK ( sign ( strncmp ( a, b, n ) ) ==
+			sign ( ref_strncmp ( a, b, n ) ) );
+
+		ch = 'a' + test_rand () % 5;
+		CHECK ( strchr ( a, ch ) == ref_strchr ( a, ch ) );
+		CHECK ( strstr ( a, b ) == ref_strstr ( a, b ) );
+
+		CHECK ( strcpy ( c, a ) == c );
+		CHECK ( !ref_strcmp ( c, a ) );
+		CHECK ( strcat ( c, b ) == c );
+		CHECK ( ref_strlen ( c ) == len1 + ref_strlen ( b ) );
+		CHECK ( !ref_strcmp ( c + len1, b ) );
+	}
+}
+
+static void test_itoa ()
+{
+	int values[] = { 0, 1, -1, 9, 10, 255, -256, 65535, 0x7fffffff,
+			 -0x7fffffff - 1, 0x12abcdef, -123456789 };
+	char bases[] = { 'd', 'u', 'x', 'X' };
+	char buf[40], ref[40];
+	int i, j, v;
+
+	for ( i = 0; i < sizeof (values) / sizeof (int) + RANDOM_TESTS; i++ )
+	{
+		if ( i < sizeof (values) / sizeof (int) )
+			v = values[i];
+		else
+			v = test_rand () ^ ( test_rand () << 16 );
+
+		for ( j = 0; j < 4; j++ )
+		{
+			itoa ( buf, bases[j], v );
+			ref_itoa ( ref, bases[j], v );
+			CHECK ( !ref_strcmp ( buf, ref ) );
+		}
+	}
+}
+
+void test_string ()
+{
+	test_mem ();
+	test_str ();
+	test_itoa ();
+}
+
+void bench_string ()
+{
+	char buf[16];
+	int sizes[] = { 16, 256, BUF_SIZE }, i;
+	char name[40];
+
+	for ( i = 0; i < 3; i++ )
+	{
+		sprintf ( name, "memset_%d", sizes[i] );
+		BENCH ( name, 100000, memset ( a, iter_, sizes[i] ) );
+		sprintf ( name, "libc_memset_%d", sizes[i] );
+		BENCH ( name, 100000, ref_memset ( a, iter_, sizes[i] ) );
+
+		sprintf ( name, "memcpy_%d", sizes[i] );
+		BENCH ( name, 100000, memcpy ( a, b, sizes[i] ) );
+		sprintf ( name, "libc_memcpy_%d", sizes[i] );
+		BENCH ( name, 100000, ref_memcpy ( a, b, sizes[i] ) );
+
+		sprintf ( name, "memmove_%d", sizes[i] );
+		BENCH ( name, 100000, memmove ( a + 1, a, sizes[i] ) );
+		sprintf ( name, "libc_memmove_%d", sizes[i] );
+		BENCH ( name, 100000, ref_memmove ( a + 1, a, sizes[i] ) );
+	}
+
+	random_string ( a, 255, 26 );
+	ref_memcpy ( b, a, 256 );
+	BENCH ( "strlen_255", 1000000, strlen ( a ) );
+	BENCH ( "libc_strlen_255", 1000000, ref_strlen ( a ) );
+	BENCH ( "strcmp_255", 1000000, strcmp ( a, b ) );
+	BENCH ( "libc_strcmp_255", 1000000, ref_strcmp ( a, b ) );
+	BENCH ( "itoa_d", 1000000, itoa ( buf, 'd', iter_ ) );
+	BENCH ( "itoa_x", 1000000, itoa ( buf, 'x', iter_ ) );
+}
@@ -93,16 +93,20 @@ alarm_t;
 /*! Thread ------------------------------------------------------------------ */
 typedef struct _thread_t_
 {
-	void *thread;
-	int thr_id;
+	void *thread;	/* kernel descriptor (informative, not used by kernel) */
+	int thr_id;	/* thread id (handle) */
 }
 thread_t;
 
+/* order in which blocked threads are released (semaphores, monitors) */
+#define THRQ_FIFO	0	/* by arrival (first come, first served) */
+#define THRQ_PRIO	1	/* by thread priority (FIFO within same prio) */
+
 
 /*! Semaphore --------------------------------------------------------------- */
 typedef struct _sem_t_
 {
-	void *ptr;
+	uint id;	/* kernel handle */
 }
 sem_t;
 
@@ -110,17 +114,36 @@ sem_t;
 /*! Monitor and monitor queue (conditional variable) ------------------------ */
 typedef struct _monitor_t_
 {
-	void *ptr;
+	uint id;	/* kernel handle */
 }
 monitor_t;
 
 typedef struct _monitor_q_
 {
-	void *ptr;
+	uint id;	/* kernel handle */
 }
 monitor_q;
 
 
+/*! Reader-writer lock ------------------------------------------------------ */
+typedef struct _rwlock_t_
+{
+	uint id;	/* kernel handle */
+}
+rwlock_t;
+
+
+/*! Barrier ----------------------------------------------------------------- */
+typedef struct _barrier_t_
+{
+	uint id;	/* kernel handle */
+}
+barrier_t;
+
+/* value returned to single (last arrived) thread from barrier_wait */
+#define BARRIER_SERIAL_THREAD	1
+
+
 /*! Messages ---------------------------------------------------------------- */
 typedef struct _msg_t_
 {
@@ -132,8 +155,7 @@ msg_t;
 /* message queue */
 typedef struct _msg_q_
 {
-	void *handle;	/* pointer to queue (or thread descriptor) */
-	uint id;	/* queue unique identifier */
+	uint id;	/* queue handle */
 }
 msg_q;
 
@@ -218,6 +240,8 @@ enum {
 	SCHED_FIFO = 0,
 	SCHED_RR,
 	SCHED_EDF,
+	SCHED_FAIR,
+	SCHED_RM,
 
 	SCHED_NUM
 };
@@ -246,18 +270,92 @@ sched_rr_t;
 #define EDF_TERMINATE	(1<<3)
 #define EDF_CONTINUE	(1<<4)
 #define EDF_SKIP	(1<<5)
+#define EDF_CBS		(1<<6)	/* with EDF_SET: join constant bandwidth server
+				   'server' with 'budget' every 'period' */
+
+#define EDF_SERVERS	8	/* number of constant bandwidth servers */
+
+/*
+ * With EDF_SET, 'budget' (if not zero) is worst case execution time of each
+ * job: task is admitted only if all admitted tasks remain schedulable and its
+ * jobs are stopped (EDF_TERMINATE/SKIP) when they exceed it; task without
+ * budget is not admitted and is refused while any task or server is admitted
+ */
 
 typedef struct _sched_edf_t_
 {
 	time_t deadline;
 	time_t period;
+	time_t budget;
+	int server;
 	int flags;
 }
 sched_edf_t;
 
+/*!
+ * Fair share scheduler: per thread 'nice' (-20 to 19, lower gets more CPU);
+ * scheduler wide 'latency' (period in which each ready thread should run once)
+ * and 'min_granularity' (shortest slice), zero values are left unchanged
+ */
+#define FAIR_NICE_MIN	(-20)
+#define FAIR_NICE_MAX	19
+
+typedef struct _sched_fair_t_
+{
+	int nice;
+	time_t latency;
+	time_t min_granularity;
+}
+sched_fair_t;
+
+/*!
+ * Rate (deadline) monotonic scheduler: periodic thread gets fixed priority from
+ * band reserved for it, higher for shorter min(deadline, period); 'wcet' is its
+ * worst case execution time, used in response time admission test
+ * (wcet <= deadline <= period is required)
+ */
+#define PRIO_RM_BAND	( PRIO_LEVELS / 2 ) /* lowest priority in band; other
+					       threads get priorities below */
+#define RM_SET		(1<<0)
+#define RM_WAIT		(1<<1)
+#define RM_EXIT		(1<<2)
+
+typedef struct _sched_rm_t_
+{
+	time_t period;
+	time_t deadline;
+	time_t wcet;
+	int flags;
+}
+sched_rm_t;
+
 typedef union _sched_t_
 {
 	sched_rr_t rr;
 	sched_edf_t edf;
+	sched_fair_t fair;
+	sched_rm_t rm;
 }
 sched_t;
+
+/*! Thread (or process) accounting snapshot, see 'thread_stats' */
+#define STATS_THREADS	0	/* one entry per thread */
+#define STATS_PROCESSES	1	/* one entry per process */
+
+#define STATS_NAME_LEN	16
+
+typedef struct _thread_stats_t_
+{
+	int id;			/* thread id (0 for process) */
+	int threads;		/* number of threads (1 for thread) */
+	char name[STATS_NAME_LEN]; /* program name */
+	int prio;
+	int state;
+	int sched_policy;
+	time_t run_time;	/* using processor */
+	time_t ready_time;	/* ready, waiting for processor */
+	time_t wait_time;	/* blocked */
+	uint vol_switches;	/* left processor by blocking (or exiting) */
+	uint invol_switches;	/* preempted */
+}
+thread_stats_t;
@@ -0,0 +1,24 @@
+/*! Barriers (thread synchronization) */
+
+#include "barrier.h"
+#include <api/syscall.h>
+#include <api/stdio.h>
+#include <api/errno.h>
+
+int barrier_init ( barrier_t *barrier, uint count )
+{
+	ASSERT_ERRNO_AND_RETURN ( barrier && count, E_INVALID_ARGUMENT );
+	return syscall ( BARRIER_INIT, barrier, count );
+}
+
+int barrier_destroy ( barrier_t *barrier )
+{
+	ASSERT_ERRNO_AND_RETURN ( barrier, E_INVALID_ARGUMENT );
+	return syscall ( BARRIER_DESTROY, barrier );
+}
+
+int barrier_wait ( barrier_t *barrier )
+{
+	ASSERT_ERRNO_AND_RETURN ( barrier, E_INVALID_ARGUMENT );
+	return syscall ( BARRIER_WAIT, barrier );
+}
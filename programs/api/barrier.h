@@ -0,0 +1,10 @@
+/*! Barriers (thread synchronization) */
+
+#pragma once
+
+#include <lib/types.h>
+
+int barrier_init ( barrier_t *barrier, uint count );
+int barrier_destroy ( barrier_t *barrier );
+
+int barrier_wait ( barrier_t *barrier );
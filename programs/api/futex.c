@@ -0,0 +1,144 @@
+/*! Futex based synchronization (kernel is called only on contention) */
+
+#include "futex.h"
+#include <api/syscall.h>
+#include <api/stdio.h>
+#include <api/errno.h>
+#include <arch/atomic.h>
+
+/*! Futex primitives -------------------------------------------------------- */
+
+/*! Block calling thread if '*addr' == val (until released with futex_wake) */
+int futex_wait ( volatile int *addr, int val )
+{
+	ASSERT_ERRNO_AND_RETURN ( addr, E_INVALID_ARGUMENT );
+	return syscall ( FUTEX_WAIT, addr, val );
+}
+
+/*! Release up to 'count' threads blocked on 'addr' */
+int futex_wake ( volatile int *addr, int count )
+{
+	ASSERT_ERRNO_AND_RETURN ( addr, E_INVALID_ARGUMENT );
+	return syscall ( FUTEX_WAKE, addr, count );
+}
+
+/*! Mutex ------------------------------------------------------------------- */
+
+int fmutex_init ( fmutex_t *mutex )
+{
+	ASSERT_ERRNO_AND_RETURN ( mutex, E_INVALID_ARGUMENT );
+
+	mutex->lock = 0;
+
+	return 0;
+}
+
+int fmutex_lock ( fmutex_t *mutex )
+{
+	int c;
+
+	ASSERT_ERRNO_AND_RETURN ( mutex, E_INVALID_ARGUMENT );
+
+	/* fast path: unlocked -> locked */
+	c = arch_atomic_cmpxchg ( &mutex->lock, 0, 1 );
+	if ( !c )
+		return 0;
+
+	/* contention: mark that there are waiters and block */
+	if ( c != 2 )
+		c = arch_atomic_xchg ( &mutex->lock, 2 );
+
+	while ( c )
+	{
+		futex_wait ( &mutex->lock, 2 );
+		c = arch_atomic_xchg ( &mutex->lock, 2 );
+	}
+
+	return 0;
+}
+
+int fmutex_trylock ( fmutex_t *mutex )
+{
+	ASSERT_ERRNO_AND_RETURN ( mutex, E_INVALID_ARGUMENT );
+
+	if ( arch_atomic_cmpxchg ( &mutex->lock, 0, 1 ) )
+		return -E_RETRY;
+
+	return 0;
+}
+
+int fmutex_unlock ( fmutex_t *mutex )
+{
+	ASSERT_ERRNO_AND_RETURN ( mutex, E_INVALID_ARGUMENT );
+
+	/* fast path: locked without waiters -> unlocked */
+	if ( arch_atomic_add ( &mutex->lock, -1 ) != 1 )
+	{
+		mutex->lock = 0;
+		futex_wake ( &mutex->lock, 1 );
+	}
+
+	return 0;
+}
+
+/*! Semaphore --------------------------------------------------------------- */
+
+int fsem_init ( fsem_t *sem, int initial_value )
+{
+	ASSERT_ERRNO_AND_RETURN ( sem && initial_value >= 0,
+				  E_INVALID_ARGUMENT );
+
+	sem->value = initial_value;
+	sem->waiters = 0;
+
+	return 0;
+}
+
+int fsem_wait ( fsem_t *sem )
+{
+	int v;
+
+	ASSERT_ERRNO_AND_RETURN ( sem, E_INVALID_ARGUMENT );
+
+	while (1)
+	{
+		v = sem->value;
+		if ( v > 0 )
+		{
+			if ( arch_atomic_cmpxchg ( &sem->value, v, v - 1 ) == v )
+				return 0;
+			continue;
+		}
+
+		/* value is 0: block until 'fsem_post' changes it;
+		   if it is changed meanwhile kernel will return immediately */
+		arch_atomic_add ( &sem->waiters, 1 );
+		futex_wait ( &sem->value, 0 );
+		arch_atomic_add ( &sem->waiters, -1 );
+	}
+}
+
+int fsem_trywait ( fsem_t *sem )
+{
+	int v;
+
+	ASSERT_ERRNO_AND_RETURN ( sem, E_INVALID_ARGUMENT );
+
+	while ( ( v = sem->value ) > 0 )
+		if ( arch_atomic_cmpxchg ( &sem->value, v, v - 1 ) == v )
+			return 0;
+
+	return -E_RETRY;
+}
+
+int fsem_post ( fsem_t *sem )
+{
+	ASSERT_ERRNO_AND_RETURN ( sem, E_INVALID_ARGUMENT );
+
+	arch_atomic_add ( &sem->value, 1 );
+
+	if ( sem->waiters > 0 )
+		futex_wake ( &sem->value, 1 );
+
+	return 0;
+}
@@ -0,0 +1,33 @@
+/*! Futex based synchronization (kernel is called only on contention) */
+
+#pragma once
+
+#include <lib/types.h>
+
+/*! Mutex: 0 - unlocked, 1 - locked, 2 - locked and some thread is blocked */
+typedef struct _fmutex_t_
+{
+	volatile int lock;
+}
+fmutex_t;
+
+/*! Semaphore: value and number of threads that are (or will be) blocked */
+typedef struct _fsem_t_
+{
+	volatile int value;
+	volatile int waiters;
+}
+fsem_t;
+
+int futex_wait ( volatile int *addr, int val );
+int futex_wake ( volatile int *addr, int count );
+
+int fmutex_init ( fmutex_t *mutex );
+int fmutex_lock ( fmutex_t *mutex );
+int fmutex_trylock ( fmutex_t *mutex );
+int fmutex_unlock ( fmutex_t *mutex );
+
+int fsem_init ( fsem_t *sem, int initial_value );
+int fsem_wait ( fsem_t *sem );
+int fsem_trywait ( fsem_t *sem );
+int fsem_post ( fsem_t *sem );
@@ -0,0 +1,207 @@
+/*! Dynamic memory allocator (thread safe, with per-thread caches) */
+
+#include "malloc.h"
+#include <api/syscall.h>
+#include <api/futex.h>
+
+/* each object has header with its size class (or MALLOC_LARGE) */
+#define MALLOC_LARGE		MALLOC_CLASSES
+#define MALLOC_HDR		sizeof (size_t)
+
+#define OBJ_CLASS(PTR)		( *( (size_t *) ( (void *) (PTR) - MALLOC_HDR ) ) )
+#define CLASS_SIZE(C)		( MALLOC_MIN_CLASS << (C) )
+
+/*! free object (in cache) - first word is pointer to next */
+struct _mobj_t_
+{
+	struct _mobj_t_ *next;
+};
+
+/*! cache for small objects */
+struct _mcache_t_
+{
+	fmutex_t lock;
+	struct {
+		struct _mobj_t_ *first;
+		int count;
+	} bin[MALLOC_CLASSES];
+};
+
+static struct _mcache_t_ cache[MALLOC_CACHES];
+
+/*! lock for heap (shared by all threads) */
+static fmutex_t heap_lock;
+
+static void *heap_alloc ( size_t size );
+static void cache_refill ( struct _mcache_t_ *c, int class );
+static void cache_drain ( struct _mcache_t_ *c, int class, int count );
+
+/*!
+ * Allocate memory; small objects from thread cache, others from heap
+ */
+void *malloc ( size_t size )
+{
+	struct _mcache_t_ *c;
+	struct _mobj_t_ *obj;
+	void *ptr;
+	int class;
+
+	for ( class = 0; class < MALLOC_CLASSES && CLASS_SIZE(class) < size;
+	      class++ )
+		;
+
+	if ( class == MALLOC_CLASSES )
+	{
+		fmutex_lock ( &heap_lock );
+		ptr = heap_alloc ( size + MALLOC_HDR );
+		fmutex_unlock ( &heap_lock );
+
+		if ( !ptr )
+			return NULL;
+
+		*( (size_t *) ptr ) = MALLOC_LARGE;
+
+		return ptr + MALLOC_HDR;
+	}
+
+	c = &cache[ pi.thread_id % MALLOC_CACHES ];
+
+	fmutex_lock ( &c->lock );
+
+	if ( !c->bin[class].first )
+		cache_refill ( c, class );
+
+	obj = c->bin[class].first;
+	if ( obj )
+	{
+		c->bin[class].first = obj->next;
+		c->bin[class].count--;
+	}
+
+	fmutex_unlock ( &c->lock );
+
+	return obj;
+}
+
+/*! Release memory; small objects are returned to thread cache */
+void free ( void *ptr )
+{
+	struct _mcache_t_ *c;
+	struct _mobj_t_ *obj = ptr;
+	int class;
+
+	if ( !ptr )
+		return;
+
+	class = OBJ_CLASS ( ptr );
+
+	if ( class == MALLOC_LARGE )
+	{
+		fmutex_lock ( &heap_lock );
+		mem_free ( ptr - MALLOC_HDR );
+		fmutex_unlock ( &heap_lock );
+		return;
+	}
+
+	c = &cache[ pi.thread_id % MALLOC_CACHES ];
+
+	fmutex_lock ( &c->lock );
+
+	obj->next = c->bin[class].first;
+	c->bin[class].first = obj;
+	c->bin[class].count++;
+
+	if ( c->bin[class].count > MALLOC_CACHE_MAX )
+		cache_drain ( c, class, MALLOC_CACHE_MAX / 2 );
+
+	fmutex_unlock ( &c->lock );
+}
+
+/*! Get MALLOC_BATCH objects of given class from heap (cache is locked) */
+static void cache_refill ( struct _mcache_t_ *c, int class )
+{
+	struct _mobj_t_ *obj;
+	void *ptr;
+	int i;
+
+	fmutex_lock ( &heap_lock );
+
+	for ( i = 0; i < MALLOC_BATCH; i++ )
+	{
+		ptr = heap_alloc ( CLASS_SIZE(class) + MALLOC_HDR );
+		if ( !ptr )
+			break;
+
+		*( (size_t *) ptr ) = class;
+
+		obj = ptr + MALLOC_HDR;
+		obj->next = c->bin[class].first;
+		c->bin[class].first = obj;
+		c->bin[class].count++;
+	}
+
+	fmutex_unlock ( &heap_lock );
+}
+
+/*! Return 'count' objects of given class to heap (cache is locked) */
+static void cache_drain ( struct _mcache_t_ *c, int class, int count )
+{
+	struct _mobj_t_ *obj;
+
+	fmutex_lock ( &heap_lock );
+
+	while ( count-- > 0 && ( obj = c->bin[class].first ) )
+	{
+		c->bin[class].first = obj->next;
+		c->bin[class].count--;
+
+		mem_free ( ( (void *) obj ) - MALLOC_HDR );
+	}
+
+	fmutex_unlock ( &heap_lock );
+}
+
+/*!
+ * Allocate memory from heap; if heap is full, extend process and add new
+ * memory to heap ('heap_lock' must be held)
+ */
+static void *heap_alloc ( size_t size )
+{
+	void *ptr, *segm;
+	size_t extend;
+
+	ptr = mem_alloc ( size );
+	if ( ptr )
+		return ptr;
+
+	/* add space for allocator headers and borders */
+	extend = size + 64;
+	if ( extend < HEAP_EXTEND_SIZE )
+		extend = HEAP_EXTEND_SIZE;
+
+	segm = process_extend ( extend );
+	if ( !segm )
+		return NULL;
+
+	mem_add ( segm, extend );
+
+	return mem_alloc ( size );
+}
+
+/*!
+ * Extend process address space (new memory is added at the process end)
+ * \param size Number of bytes to add
+ * \return Start of added memory, NULL if process can't be extended
+ */
+void *process_extend ( size_t size )
+{
+	void *start = NULL;
+
+	if ( !size )
+		return NULL;
+
+	if ( syscall ( PROCESS_EXTEND, size, &start ) )
+		return NULL;
+
+	return start;
+}
@@ -13,21 +13,43 @@ extern prog_info_t pi;
 #define MEM_ALLOC_T ffs_mpool_t
 
 #define	mem_init(segment, size)		ffs_init ( segment, size )
-#define	malloc(size)			ffs_alloc ( pi.mpool, size )
-#define	free(addr)			ffs_free ( pi.mpool, addr )
+#define	mem_alloc(size)			ffs_alloc ( pi.mpool, size )
+#define	mem_add(segment, size)		ffs_add_segment ( pi.mpool, segment, size)
+#define	mem_free(addr)			ffs_free ( pi.mpool, addr )
 
 #elif MEM_ALLOCATOR_FOR_USER == GMA
 
 #define MEM_ALLOC_T gma_t
 
 #define	mem_init(segment, size)		gma_init ( segment, size, 32, 0 )
-#define	malloc(size)			gma_alloc ( pi.mpool, size )
-#define	free(addr)			gma_free ( pi.mpool, addr )
+#define	mem_alloc(size)			gma_alloc ( pi.mpool, size )
+#define	mem_add(segment, size)		gma_add_segment ( pi.mpool, segment, size)
+#define	mem_free(addr)			gma_free ( pi.mpool, addr )
 
 #else /* memory allocator not selected! */
 
 #define	mem_init			k_mem_init_Not_Implemented
-#define	malloc				k_mem_alloc_Not_Implemented
-#define	free				k_mem_free_Not_Implemented
+#define	mem_alloc			k_mem_alloc_Not_Implemented
+#define	mem_add				k_mem_add_Not_Implemented
+#define	mem_free			k_mem_free_Not_Implemented
 
 #endif
+
+/* when heap is full, process is extended by (at least) this much */
+#define HEAP_EXTEND_SIZE	0x4000
+
+/*
+ * Small objects are kept in per-thread caches (selected by thread id; threads
+ * with same id modulo MALLOC_CACHES share cache). Each cache has list of free
+ * objects per size class; empty list is refilled from heap with MALLOC_BATCH
+ * objects, full list returns half of its objects to heap.
+ */
+#define MALLOC_CACHES		8	/* number of caches */
+#define MALLOC_CLASSES		5	/* size classes: 16, 32, 64, 128, 256 */
+#define MALLOC_MIN_CLASS	16	/* smallest class size */
+#define MALLOC_BATCH		16	/* objects taken from heap at once */
+#define MALLOC_CACHE_MAX	64	/* max free objects per class in cache */
+
+void *malloc ( size_t size );
+void free ( void *ptr );
+void *process_extend ( size_t size );
@@ -5,10 +5,10 @@
 #include <api/stdio.h>
 #include <api/errno.h>
 
-int monitor_init ( monitor_t *monitor )
+int monitor_init ( monitor_t *monitor, uint flags )
 {
 	ASSERT_ERRNO_AND_RETURN ( monitor, E_INVALID_ARGUMENT );
-	return syscall ( MONITOR_INIT, monitor );
+	return syscall ( MONITOR_INIT, monitor, flags );
 }
 
 int monitor_destroy ( monitor_t *monitor )
@@ -17,10 +17,10 @@ int monitor_destroy ( monitor_t *monitor )
 	return syscall ( MONITOR_DESTROY, monitor );
 }
 
-int monitor_queue_init ( monitor_q *queue )
+int monitor_queue_init ( monitor_q *queue, uint flags )
 {
 	ASSERT_ERRNO_AND_RETURN ( queue, E_INVALID_ARGUMENT );
-	return syscall ( MONITOR_QUEUE_INIT, queue );
+	return syscall ( MONITOR_QUEUE_INIT, queue, flags );
 }
 
 int monitor_queue_destroy ( monitor_q *queue )
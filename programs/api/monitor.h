@@ -4,9 +4,9 @@
 
 #include <lib/types.h>
 
-int monitor_init ( monitor_t *monitor );
+int monitor_init ( monitor_t *monitor, uint flags );
 int monitor_destroy ( monitor_t *monitor );
-int monitor_queue_init ( monitor_q *queue );
+int monitor_queue_init ( monitor_q *queue, uint flags );
 int monitor_queue_destroy ( monitor_q *queue );
 
 int monitor_lock ( monitor_t *monitor );
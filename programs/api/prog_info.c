@@ -32,7 +32,9 @@ prog_info_t pi =
 
 	.mpool =	NULL,
 	.stdin =	NULL,
-	.stdout =	NULL
+	.stdout =	NULL,
+
+	.thread_id =	0
 };
 
 /*! Initialize process environment */
@@ -29,6 +29,8 @@ typedef struct _prog_info_t_
 	void *mpool;
 	void *stdin;
 	void *stdout;
+
+	uint thread_id;	/* id of active thread (updated by kernel) */
 }
 prog_info_t;
 
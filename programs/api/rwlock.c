@@ -0,0 +1,36 @@
+/*! Reader-writer locks (thread synchronization) */
+
+#include "rwlock.h"
+#include <api/syscall.h>
+#include <api/stdio.h>
+#include <api/errno.h>
+
+int rwlock_init ( rwlock_t *rwlock, uint flags )
+{
+	ASSERT_ERRNO_AND_RETURN ( rwlock, E_INVALID_ARGUMENT );
+	return syscall ( RWLOCK_INIT, rwlock, flags );
+}
+
+int rwlock_destroy ( rwlock_t *rwlock )
+{
+	ASSERT_ERRNO_AND_RETURN ( rwlock, E_INVALID_ARGUMENT );
+	return syscall ( RWLOCK_DESTROY, rwlock );
+}
+
+int rwlock_rdlock ( rwlock_t *rwlock )
+{
+	ASSERT_ERRNO_AND_RETURN ( rwlock, E_INVALID_ARGUMENT );
+	return syscall ( RWLOCK_RDLOCK, rwlock );
+}
+
+int rwlock_wrlock ( rwlock_t *rwlock )
+{
+	ASSERT_ERRNO_AND_RETURN ( rwlock, E_INVALID_ARGUMENT );
+	return syscall ( RWLOCK_WRLOCK, rwlock );
+}
+
+int rwlock_unlock ( rwlock_t *rwlock )
+{
+	ASSERT_ERRNO_AND_RETURN ( rwlock, E_INVALID_ARGUMENT );
+	return syscall ( RWLOCK_UNLOCK, rwlock );
+}
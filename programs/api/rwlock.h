@@ -0,0 +1,12 @@
+/*! Reader-writer locks (thread synchronization) */
+
+#pragma once
+
+#include <lib/types.h>
+
+int rwlock_init ( rwlock_t *rwlock, uint flags );
+int rwlock_destroy ( rwlock_t *rwlock );
+
+int rwlock_rdlock ( rwlock_t *rwlock );
+int rwlock_wrlock ( rwlock_t *rwlock );
+int rwlock_unlock ( rwlock_t *rwlock );
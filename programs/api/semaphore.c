@@ -5,10 +5,10 @@
 #include <api/stdio.h>
 #include <api/errno.h>
 
-int sem_init ( sem_t *sem, int initial_value )
+int sem_init ( sem_t *sem, int initial_value, uint flags )
 {
 	ASSERT_ERRNO_AND_RETURN ( sem, E_INVALID_ARGUMENT );
-	return syscall ( SEM_INIT, sem, initial_value );
+	return syscall ( SEM_INIT, sem, initial_value, flags );
 }
 
 int sem_destroy ( sem_t *sem )
@@ -4,7 +4,7 @@
 
 #include <lib/types.h>
 
-int sem_init ( sem_t *sem, int initial_value );
+int sem_init ( sem_t *sem, int initial_value, uint flags );
 int sem_destroy ( sem_t *sem );
 
 int sem_post ( sem_t *sem );
@@ -3,11 +3,101 @@
 #include "stdio.h"
 #include <api/syscall.h>
 #include <api/prog_info.h>
+#include <api/futex.h>
+#include <api/errno.h>
 #include <lib/string.h>
 #include <lib/types.h>
 
 extern prog_info_t pi; /* defined in api/prog_info.c */
 
+/*! Standard output buffer (shared by all process threads) */
+static struct _stdout_buf_
+{
+	fmutex_t lock;		/* protects rest of the structure */
+	int mode;		/* STDOUT_*_BUFFERED */
+	int len;		/* number of characters in buffer */
+	struct {
+		int attr;
+		char text[STDOUT_BUFSZ];
+	} buf;			/* format expected by PRINTSTRING */
+}
+out = {
+	.lock =	{ 0 },
+	.mode =	STDOUT_LINE_BUFFERED,
+	.len =	0,
+	.buf =	{ USER_FONT, { 0 } }
+};
+
+/*! Send buffered characters to stdout device; 'out.lock' must be held */
+static int stdout_send ()
+{
+	int retval = 0;
+
+	if ( out.len > 0 )
+	{
+		out.buf.text[out.len] = 0;
+		retval = syscall ( DEVICE_SEND, &out.buf, out.len + 1,
+				   PRINTSTRING, pi.stdout );
+		out.len = 0;
+	}
+
+	return retval;
+}
+
+/*! Add string to stdout buffer, send it if required by buffering mode */
+static void stdout_write ( char *text )
+{
+	int new_line = FALSE;
+
+	fmutex_lock ( &out.lock );
+
+	while ( *text )
+	{
+		if ( *text == '\n' )
+			new_line = TRUE;
+
+		out.buf.text[out.len++] = *text++;
+
+		if ( out.len == STDOUT_BUFSZ - 1 )
+			stdout_send ();
+	}
+
+	/* on new line send once, after whole string is buffered */
+	if ( out.mode == STDOUT_UNBUFFERED ||
+	     ( out.mode == STDOUT_LINE_BUFFERED && new_line ) )
+		stdout_send ();
+
+	fmutex_unlock ( &out.lock );
+}
+
+/*! Send all buffered output to stdout device */
+int flush ()
+{
+	int retval;
+
+	fmutex_lock ( &out.lock );
+	retval = stdout_send ();
+	fmutex_unlock ( &out.lock );
+
+	return retval;
+}
+
+/*! Set stdout buffering mode (STDOUT_*_BUFFERED) */
+int set_stdout_buffering ( int mode )
+{
+	ASSERT_ERRNO_AND_RETURN ( mode == STDOUT_UNBUFFERED ||
+				  mode == STDOUT_LINE_BUFFERED ||
+				  mode == STDOUT_FULL_BUFFERED,
+				  E_INVALID_ARGUMENT );
+
+	fmutex_lock ( &out.lock );
+	stdout_send ();
+	out.mode = mode;
+	fmutex_unlock ( &out.lock );
+
+	return 0;
+}
+
 /*! Change standard input device */
 int change_stdin ( char *new_stdin )
 {
@@ -30,6 +120,8 @@ int change_stdout ( char *new_stdout )
 {
 	void *new_dev;
 
+	flush ();
+
 	syscall ( DEVICE_OPEN, new_stdout, &new_dev );
 
 	if ( new_dev )
@@ -64,6 +156,8 @@ int change_default_stdout ( char *new_stdout )
 {
 	void *new_dev;
 
+	flush ();
+
 	syscall ( SET_DEFAULT_STDOUT, new_stdout, &new_dev );
 
 	if ( new_dev )
@@ -81,6 +175,8 @@ inline int get_char ()
 {
 	int c = 0;
 
+	flush (); /* show prompt (or echo) before waiting for input */
+
 	syscall ( DEVICE_RECV, (void *) &c, 1, ONLY_ASCII, pi.stdin );
 
 	return c;
@@ -89,6 +185,8 @@ inline int get_char ()
 /*! Erase screen (if supported by stdout device) */
 inline int clear_screen ()
 {
+	flush ();
+
 	return syscall ( DEVICE_SEND, NULL, 0, CLEAR, pi.stdout );
 }
 
@@ -100,15 +198,17 @@ inline int goto_xy ( int x, int y )
 	p[0] = x;
 	p[1] = y;
 
+	flush ();
+
 	return syscall ( DEVICE_SEND, &p, 2 * sizeof (int), GOTOXY, pi.stdout );
 }
 
 /*!
  * Formated output to console (lightweight version of 'printf')
  * int print ( char *format, ... ) - defined in lib/print.h
+ * (text is collected in stdout buffer, not sent directly to device)
  */
 #define PRINT_FUNCTION_NAME	print
 #define PRINT_ATTRIBUT		USER_FONT
-#define DEVICE_SEND(TEXT,SZ)	syscall ( DEVICE_SEND, &TEXT, SZ,	\
-					  PRINTSTRING, pi.stdout );
+#define DEVICE_SEND(TEXT,SZ)	stdout_write ( TEXT.text );
 #include <lib/print.h>
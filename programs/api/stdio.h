@@ -2,11 +2,21 @@
 
 #pragma once
 
+/*! Standard output buffering modes */
+#define STDOUT_UNBUFFERED	0	/* send every 'print' immediately */
+#define STDOUT_LINE_BUFFERED	1	/* send when new line is printed */
+#define STDOUT_FULL_BUFFERED	2	/* send only when buffer gets full */
+
+#define STDOUT_BUFSZ		256	/* output buffer size (with '\0') */
+
 extern inline int get_char ();
 extern inline int clear_screen ();
 extern inline int goto_xy ( int x, int y );
 int print ( char *format, ... );
 
+int flush ();
+int set_stdout_buffering ( int mode );
+
 int change_stdin ( char *new_stdin );
 int change_stdout ( char *new_stdout );
 int change_default_stdin ( char *new_stdin );
@@ -18,6 +18,8 @@ int create_thread ( void *start_func, void *param, int sched, int prio,
 
 void thread_exit ( int status )
 {
+	flush (); /* don't lose buffered output */
+
 	syscall ( THREAD_EXIT, status );
 }
 
@@ -55,6 +57,25 @@ int start_program ( char *prog_name, thread_t *handle, void *param,
 	return syscall ( START_PROGRAM, prog_name, handle, param, sched, prio );
 }
 
+/*!
+ * Get accounting snapshot: processor time, time ready and blocked, switches
+ * \param flags STATS_THREADS (element per thread) or STATS_PROCESSES
+ * \param buf Array for snapshot
+ * \param max Number of elements in 'buf'
+ * \return number of elements filled
+ */
+int thread_stats ( int flags, thread_stats_t *buf, int max )
+{
+	ASSERT_ERRNO_AND_RETURN ( buf && max > 0, E_INVALID_ARGUMENT );
+	return syscall ( THREAD_STATS, flags, buf, max );
+}
+
+/*! Move calling thread behind other ready threads with same priority */
+int thread_yield ()
+{
+	return syscall ( THREAD_YIELD );
+}
+
 /*! Set thread scheduling parameters */
 int set_sched_params ( int sched_policy, sched_t *params )
 {
@@ -89,6 +110,27 @@ int edf_set ( time_t deadline, time_t period, int flags, int ctrl_flags )
 
 	param.edf.deadline = deadline;
 	param.edf.period = period;
+	param.edf.budget.sec = param.edf.budget.nsec = 0;
+	param.edf.flags = EDF_SET | ctrl_flags;
+	thread_self ( &thread );
+
+	return set_thread_sched_params ( &thread, SCHED_EDF, 0, &param );
+}
+
+/*!
+ * Same as edf_set, but with worst case execution time of each job: thread
+ * becomes EDF task only if it passes admission control (otherwise returns
+ * -E_NOT_SCHEDULABLE); job running longer than 'wcet' is handled as
+ * selected with 'ctrl_flags' (EDF_TERMINATE, EDF_SKIP or EDF_CONTINUE)
+ */
+int edf_set_wcet ( time_t deadline, time_t period, time_t wcet, int ctrl_flags )
+{
+	sched_t param;
+	thread_t thread;
+
+	param.edf.deadline = deadline;
+	param.edf.period = period;
+	param.edf.budget = wcet;
 	param.edf.flags = EDF_SET | ctrl_flags;
 	thread_self ( &thread );
 
@@ -116,3 +158,63 @@ int edf_exit ()
 
 	return set_thread_sched_params ( &thread, SCHED_EDF, 0, &param );
 }
+
+/*!
+ * Run calling thread within constant bandwidth server 'server' (shared with
+ * other threads that join it); 'budget' and 'period' are used if server is
+ * not already created. Leave server with edf_exit.
+ */
+int edf_cbs ( int server, time_t budget, time_t period )
+{
+	sched_t param;
+	thread_t thread;
+
+	param.edf.server = server;
+	param.edf.budget = budget;
+	param.edf.period = period;
+	param.edf.flags = EDF_SET | EDF_CBS;
+	thread_self ( &thread );
+
+	return set_thread_sched_params ( &thread, SCHED_EDF, 0, &param );
+}
+
+/*!
+ * Make calling thread periodic, with fixed priority by rate (deadline)
+ * monotonic order; 'wcet' is used in admission test (-E_NOT_SCHEDULABLE if
+ * not admitted); first job starts now, each next with rm_wait
+ */
+int rm_set ( time_t period, time_t deadline, time_t wcet )
+{
+	sched_t param;
+	thread_t thread;
+
+	param.rm.period = period;
+	param.rm.deadline = deadline;
+	param.rm.wcet = wcet;
+	param.rm.flags = RM_SET;
+	thread_self ( &thread );
+
+	return set_thread_sched_params ( &thread, SCHED_RM, 0, &param );
+}
+
+int rm_wait ()
+{
+	sched_t param;
+	thread_t thread;
+
+	param.rm.flags = RM_WAIT;
+	thread_self ( &thread );
+
+	return set_thread_sched_params ( &thread, SCHED_RM, 0, &param );
+}
+
+int rm_exit ()
+{
+	sched_t param;
+	thread_t thread;
+
+	param.rm.flags = RM_EXIT;
+	thread_self ( &thread );
+
+	return set_thread_sched_params ( &thread, SCHED_RM, 0, &param );
+}
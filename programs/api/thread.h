@@ -13,6 +13,8 @@ int thread_self ( thread_t *thr );
 
 int start_program ( char *prog_name, thread_t *handle, void *param,
 		    int sched, int prio );
+int thread_stats ( int flags, thread_stats_t *buf, int max );
+int thread_yield ();
 
 int set_sched_params ( int sched_policy, sched_t *params );
 int get_sched_params ( int *sched_policy, sched_t *params );
@@ -23,5 +25,11 @@ int get_thread_sched_params ( thread_t *thread, int *sched_policy, int *prio,
 			      sched_t *params );
 
 int edf_set ( time_t deadline, time_t period, int flags, int ctrl_flags );
+int edf_set_wcet ( time_t deadline, time_t period, time_t wcet, int ctrl_flags );
 int edf_wait ();
 int edf_exit ();
+int edf_cbs ( int server, time_t budget, time_t period );
+
+int rm_set ( time_t period, time_t deadline, time_t wcet );
+int rm_wait ();
+int rm_exit ();
@@ -0,0 +1,133 @@
+/*! Context switch benchmark: message ping-pong between two threads of same
+ *  process and between threads of two different processes
+ *  (each round trip = two context switches) */
+
+#include <api/stdio.h>
+#include <api/thread.h>
+#include <api/time.h>
+#include <api/messages.h>
+#include <lib/string.h>
+#include <lib/types.h>
+
+char PROG_HELP[] = "Measure intra and inter process context switch time.";
+
+#define ROUNDS		10000
+
+static thread_t peer;	/* thread on other side */
+
+/* parse hexadecimal number (as printed with itoa), e.g. "0x0012abcd" */
+static uint parse_hex ( char *s )
+{
+	uint n = 0;
+
+	if ( s[0] == '0' && s[1] == 'x' )
+		s += 2;
+
+	for ( ; *s; s++ )
+	{
+		if ( *s >= '0' && *s <= '9' )
+			n = n * 16 + *s - '0';
+		else if ( *s >= 'a' && *s <= 'f' )
+			n = n * 16 + *s - 'a' + 10;
+		else
+			break;
+	}
+
+	return n;
+}
+
+/* reply to every received message */
+static void echo ( thread_t *to )
+{
+	uint8 msg_buf[sizeof (msg_t) + 1];
+	msg_t *msg = (msg_t *) msg_buf;
+	thread_t self;
+	int i;
+
+	thread_self ( &self );
+
+	for ( i = 0; i < ROUNDS; i++ )
+	{
+		receive_message ( MSG_THREAD, &self, msg, 0, 1, IPC_WAIT );
+		send_message ( MSG_THREAD, to, msg, 0 );
+	}
+}
+
+/* echo thread in same process */
+static void echo_thread ( void *param )
+{
+	echo ( param );
+}
+
+/* send message to 'peer' and wait for reply, ROUNDS times;
+   return time of single switch in nanoseconds */
+static int ping_pong ()
+{
+	uint8 msg_buf[sizeof (msg_t) + 1];
+	msg_t *msg = (msg_t *) msg_buf;
+	thread_t self;
+	time_t start, end;
+	int i;
+
+	thread_self ( &self );
+
+	msg->type = 1;
+	msg->size = 1;
+	msg->data[0] = 0;
+
+	time_get ( &start );
+
+	for ( i = 0; i < ROUNDS; i++ )
+	{
+		send_message ( MSG_THREAD, &peer, msg, 0 );
+		receive_message ( MSG_THREAD, &self, msg, 0, 1, IPC_WAIT );
+	}
+
+	time_get ( &end );
+	time_sub ( &end, &start );
+
+	return ( end.sec * 1000000 + end.nsec / 1000 ) / ( 2 * ROUNDS / 1000 );
+}
+
+int ctxsw_bench ( char *args[] )
+{
+	char thr_str[16], id_str[16];
+	char *child_args[] = { "ctxsw_bench", "child", thr_str, id_str, NULL };
+	thread_t self;
+	int intra, inter;
+
+	/* started as other process - echo to thread given in arguments */
+	if ( args && args[1] && !strcmp ( args[1], "child" ) )
+	{
+		peer.thread = (void *) parse_hex ( args[2] );
+		peer.thr_id = parse_hex ( args[3] );
+		echo ( &peer );
+		return 0;
+	}
+
+	thread_self ( &self );
+
+	/* intra process: echo thread in this process */
+	create_thread ( echo_thread, &self, 0, THR_DEFAULT_PRIO, &peer );
+	intra = ping_pong ();
+	wait_for_thread ( &peer, IPC_WAIT );
+
+	/* inter process: same program started as new process */
+	itoa ( thr_str, 'x', (int) self.thread );
+	itoa ( id_str, 'x', self.thr_id );
+	if ( start_program ( "ctxsw_bench", &peer, child_args, 0,
+			     THR_DEFAULT_PRIO ) )
+	{
+		print ( "Can not start 'ctxsw_bench' as new process\n" );
+		return -1;
+	}
+	inter = ping_pong ();
+	wait_for_thread ( &peer, IPC_WAIT );
+
+	print ( "Context switch benchmark (%d round trips)\n", ROUNDS );
+	print ( "switch ns/switch\n" );
+	print ( "intra_process %d\n", intra );
+	print ( "inter_process %d\n", inter );
+
+	return 0;
+}
@@ -0,0 +1,62 @@
+/*! Fair share scheduling example: threads with different nice values share
+ *  processor proportionally to their weights */
+
+#include <api/stdio.h>
+#include <api/thread.h>
+#include <api/time.h>
+#include <arch/processor.h>
+
+char PROG_HELP[] = "Fair share scheduler example: threads with different nice "
+		   "values perform same iterations; print how much each did.";
+
+#define THR_NUM	4
+#define INNER_LOOP_COUNT 100000
+#define TEST_DURATION	10 /* seconds */
+
+static int nice[THR_NUM] = { -5, 0, 0, 5 };
+static int iters[THR_NUM];
+
+static void fair_thread ( void *param )
+{
+	int j, thr_no = (int) param;
+
+	for ( ; ; )
+	{
+		for ( j = 0; j < INNER_LOOP_COUNT; j++ )
+			memory_barrier ();
+
+		iters[thr_no]++;
+	}
+}
+
+int fair_share ( char *args[] )
+{
+	thread_t thread[THR_NUM];
+	sched_t param;
+	time_t sleep;
+	int i;
+
+	for ( i = 0; i < THR_NUM; i++ )
+	{
+		iters[i] = 0;
+		create_thread ( fair_thread, (void *) i,
+				SCHED_FAIR, THR_DEFAULT_PRIO - 1, &thread[i] );
+
+		param.fair.nice = nice[i];
+		set_thread_sched_params ( &thread[i], SCHED_FAIR, 0, &param );
+	}
+
+	print ( "Threads created, giving them %d seconds\n", TEST_DURATION );
+	sleep.sec = TEST_DURATION;
+	sleep.nsec = 0;
+	delay ( &sleep );
+
+	for ( i = 0; i < THR_NUM; i++ )
+		cancel_thread ( &thread[i] );
+	for ( i = 0; i < THR_NUM; i++ )
+		wait_for_thread ( &thread[i], IPC_WAIT );
+	for ( i = 0; i < THR_NUM; i++ )
+		print ( "Thread %d, nice=%d, count=%d\n", i, nice[i], iters[i] );
+
+	return 0;
+}
@@ -0,0 +1,305 @@
+/*! Wakeup latency benchmark (cyclictest like): periodic threads sleep until
+ *  absolute time (delay_until or edf_wait) and record how late they woke up;
+ *  optional background load (processor hogs, message flood, console spam) */
+
+#include <api/stdio.h>
+#include <api/thread.h>
+#include <api/time.h>
+#include <api/messages.h>
+#include <arch/processor.h>
+#include <lib/string.h>
+#include <lib/types.h>
+
+char PROG_HELP[] = "Wakeup latency: latency_bench [threads=N] [interval=us] "
+		   "[loops=N] [prio=P] [policy=fifo|rr|edf] [step=us] "
+		   "[load=cpu,msg,con]";
+
+#define MAX_THREADS_B	8	/* measuring threads */
+#define HIST_SIZE	32	/* histogram buckets (last for all larger) */
+#define HOGS		2	/* processor hogs (load=cpu) */
+
+/* parameters (defaults) */
+static int threads = 4;
+static int interval = 1000;	/* period of first thread [us] */
+static int loops = 1000;
+static int prio = THR_DEFAULT_PRIO + MAX_THREADS_B;
+static int policy = SCHED_FIFO;
+static int step = 10;		/* histogram bucket width [us] */
+static int load_cpu, load_msg, load_con;
+
+/* results, per thread */
+static struct {
+	int min, max, overruns, samples;
+	uint sum;
+	int hist[HIST_SIZE];
+}
+res[MAX_THREADS_B];
+
+/* parse decimal number */
+static int parse_int ( char *s )
+{
+	int n = 0;
+
+	for ( ; *s >= '0' && *s <= '9'; s++ )
+		n = n * 10 + *s - '0';
+
+	return n;
+}
+
+/* store one sample [us] */
+static void record ( int thr_no, int lat )
+{
+	int b = lat / step;
+
+	if ( lat < res[thr_no].min )
+		res[thr_no].min = lat;
+	if ( lat > res[thr_no].max )
+		res[thr_no].max = lat;
+
+	res[thr_no].sum += lat;
+	res[thr_no].samples++;
+	res[thr_no].hist[b < HIST_SIZE ? b : HIST_SIZE - 1]++;
+}
+
+/* difference a - b in microseconds */
+static int diff_us ( time_t *a, time_t *b )
+{
+	return ( a->sec - b->sec ) * 1000000 + ( a->nsec - b->nsec ) / 1000;
+}
+
+/* measuring thread; thread i has period interval * (i + 1) */
+static void measure_thread ( void *param )
+{
+	int thr_no = (int) param, i;
+	time_t period, next, now;
+
+	period.sec = interval * ( thr_no + 1 ) / 1000000;
+	period.nsec = ( interval * ( thr_no + 1 ) % 1000000 ) * 1000;
+
+	res[thr_no].min = 0x7fffffff;
+
+	time_get ( &next );
+
+	if ( policy == SCHED_EDF )
+	{
+		/* first job is released immediately, next ones every period */
+		edf_set ( period, period, EDF_SET, EDF_CONTINUE );
+		edf_wait ();
+	}
+
+	for ( i = 0; i < loops; i++ )
+	{
+		time_add ( &next, &period );
+
+		if ( policy == SCHED_EDF )
+		{
+			if ( edf_wait () )
+			{
+				/* late: job released without waiting */
+				res[thr_no].overruns++;
+				continue;
+			}
+		}
+		else {
+			delay_until ( &next );
+		}
+
+		time_get ( &now );
+		if ( time_cmp ( &now, &next ) < 0 )
+			record ( thr_no, 0 ); /* timer rounding */
+		else
+			record ( thr_no, diff_us ( &now, &next ) );
+	}
+
+	if ( policy == SCHED_EDF )
+		edf_exit ();
+}
+
+/* background load ---------------------------------------------------------- */
+
+static void hog_thread ( void *param )
+{
+	for ( ; ; )
+		memory_barrier ();
+}
+
+/* two threads sending messages to each other (as fast as they can) */
+static thread_t flood[2];
+
+static void flood_thread ( void *param )
+{
+	uint8 msg_buf[sizeof (msg_t) + 1];
+	msg_t *msg = (msg_t *) msg_buf;
+	int i = (int) param;
+	thread_t self;
+
+	thread_self ( &self );
+
+	msg->type = 1;
+	msg->size = 1;
+	msg->data[0] = 0;
+
+	if ( i )
+		send_message ( MSG_THREAD, &flood[0], msg, 0 );
+
+	for ( ; ; )
+	{
+		receive_message ( MSG_THREAD, &self, msg, 0, 1, IPC_WAIT );
+		send_message ( MSG_THREAD, &flood[1 - i], msg, 0 );
+	}
+}
+
+static void spam_thread ( void *param )
+{
+	int i;
+
+	for ( i = 0; ; i++ )
+		print ( "latency_bench console load %d\n", i );
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void parse_args ( char *args[] )
+{
+	int i;
+
+	for ( i = 1; args && args[i]; i++ )
+	{
+		if ( !strncmp ( args[i], "threads=", 8 ) )
+			threads = parse_int ( args[i] + 8 );
+		else if ( !strncmp ( args[i], "interval=", 9 ) )
+			interval = parse_int ( args[i] + 9 );
+		else if ( !strncmp ( args[i], "loops=", 6 ) )
+			loops = parse_int ( args[i] + 6 );
+		else if ( !strncmp ( args[i], "prio=", 5 ) )
+			prio = parse_int ( args[i] + 5 );
+		else if ( !strncmp ( args[i], "step=", 5 ) )
+			step = parse_int ( args[i] + 5 );
+		else if ( !strcmp ( args[i], "policy=rr" ) )
+			policy = SCHED_RR;
+		else if ( !strcmp ( args[i], "policy=edf" ) )
+			policy = SCHED_EDF;
+		else if ( !strcmp ( args[i], "policy=fifo" ) )
+			policy = SCHED_FIFO;
+		else if ( !strncmp ( args[i], "load=", 5 ) )
+		{
+			load_cpu = strstr ( args[i], "cpu" ) != NULL;
+			load_msg = strstr ( args[i], "msg" ) != NULL;
+			load_con = strstr ( args[i], "con" ) != NULL;
+		}
+		else {
+			print ( "Unknown argument: %s\n%s\n", args[i],
+				PROG_HELP );
+		}
+	}
+
+	if ( threads < 1 )
+		threads = 1;
+	if ( threads > MAX_THREADS_B )
+		threads = MAX_THREADS_B;
+	if ( interval < 100 )
+		interval = 100;
+	if ( step < 1 )
+		step = 1;
+	if ( prio - threads < 2 )
+		prio = threads + 2; /* load runs at prio - threads - 1 > 0 */
+	if ( prio > PRIO_RM_BAND - 2 )
+		prio = PRIO_RM_BAND - 2; /* control thread runs at prio + 1 */
+}
+
+static void report ()
+{
+	int i, j;
+
+	print ( "# latency_bench threads=%d interval=%d loops=%d prio=%d "
+		"policy=%d load=%s%s%s\n", threads, interval, loops, prio,
+		policy, load_cpu ? "cpu," : "", load_msg ? "msg," : "",
+		load_con ? "con" : "" );
+
+	print ( "# thread period_us samples min_us avg_us max_us overruns\n" );
+	for ( i = 0; i < threads; i++ )
+		print ( "T %d %d %d %d %d %d %d\n", i, interval * ( i + 1 ),
+			res[i].samples, res[i].samples ? res[i].min : 0,
+			res[i].samples ? res[i].sum / res[i].samples : 0,
+			res[i].max, res[i].overruns );
+
+	/* histogram: bucket start [us] and count per thread */
+	print ( "# histogram step_us=%d (last bucket: all larger)\n", step );
+	for ( j = 0; j < HIST_SIZE; j++ )
+	{
+		print ( "H %d", j * step );
+		for ( i = 0; i < threads; i++ )
+			print ( " %d", res[i].hist[j] );
+		print ( "\n" );
+	}
+}
+
+/* creates all other threads and collects results; runs above all of them
+ * (mostly blocked) so that load can not prevent it from finishing test */
+static void control_thread ( void *param )
+{
+	thread_t thread[MAX_THREADS_B], hog[HOGS], spam;
+	int i;
+
+	/* load runs below measuring threads */
+	if ( load_cpu )
+		for ( i = 0; i < HOGS; i++ )
+			create_thread ( hog_thread, NULL, SCHED_RR,
+					prio - threads - 1, &hog[i] );
+	if ( load_msg )
+	{
+		create_thread ( flood_thread, (void *) 0, SCHED_FIFO,
+				prio - threads - 1, &flood[0] );
+		create_thread ( flood_thread, (void *) 1, SCHED_FIFO,
+				prio - threads - 1, &flood[1] );
+	}
+	if ( load_con )
+		create_thread ( spam_thread, NULL, SCHED_FIFO,
+				prio - threads - 1, &spam );
+
+	/* shortest period gets highest priority */
+	for ( i = 0; i < threads; i++ )
+		create_thread ( measure_thread, (void *) i, policy, prio - i,
+				&thread[i] );
+
+	for ( i = 0; i < threads; i++ )
+		wait_for_thread ( &thread[i], IPC_WAIT );
+
+	if ( load_cpu )
+		for ( i = 0; i < HOGS; i++ )
+		{
+			cancel_thread ( &hog[i] );
+			wait_for_thread ( &hog[i], IPC_WAIT );
+		}
+	if ( load_msg )
+		for ( i = 0; i < 2; i++ )
+		{
+			cancel_thread ( &flood[i] );
+			wait_for_thread ( &flood[i], IPC_WAIT );
+		}
+	if ( load_con )
+	{
+		cancel_thread ( &spam );
+		wait_for_thread ( &spam, IPC_WAIT );
+	}
+
+	flush ();
+	report ();
+}
+
+int latency_bench ( char *args[] )
+{
+	thread_t control;
+
+	parse_args ( args );
+
+	memset ( res, 0, sizeof (res) );
+
+	/* results are reported over serial port */
+	change_stdout ( "COM1" );
+
+	create_thread ( control_thread, NULL, SCHED_FIFO, prio + 1, &control );
+	wait_for_thread ( &control, IPC_WAIT );
+
+	return 0;
+}
@@ -0,0 +1,375 @@
+/*! Microbenchmarks of kernel primitives (lmbench like): cost of single
+ *  operation for system calls, threads, synchronization, messages, alarms,
+ *  program start and device output
+ *
+ *  Output lines (one per measurement, for scripts):
+ *  "B <name> <iterations> <result> <unit>"
+ */
+
+#include <api/stdio.h>
+#include <api/thread.h>
+#include <api/time.h>
+#include <api/errno.h>
+#include <api/semaphore.h>
+#include <api/monitor.h>
+#include <api/messages.h>
+#include <api/syscall.h>
+#include <lib/bits.h>
+#include <lib/string.h>
+#include <lib/types.h>
+
+char PROG_HELP[] = "Kernel primitives microbenchmarks: lmbench [name ...] "
+		   "(syscall thread sem monitor handoff msg alarm program "
+		   "device; all if none given)";
+
+#define N_SYSCALL	100000
+#define N_THREAD	1000
+#define N_SEM		10000
+#define N_MONITOR	100000
+#define N_HANDOFF	10000
+#define N_MSG		10000
+#define N_ALARM		10000
+#define N_PROGRAM	100
+#define N_DEVICE	200
+
+#define MSG_MAX		1024	/* largest message size tested */
+#define DEV_MAX		512	/* largest device send tested */
+#define BENCH_DEVICE	"VGA_TXT" /* not stdout (results) */
+
+static time_t start;
+
+static void bench_start ()
+{
+	time_get ( &start );
+}
+
+/* print result as time per operation [ns] */
+static void bench_end ( char *name, int size, int n, int ops_per_iter )
+{
+	time_t end;
+	char full_name[32];
+	uint us;
+
+	time_get ( &end );
+	time_sub ( &end, &start );
+	us = end.sec * 1000000 + end.nsec / 1000;
+
+	strcpy ( full_name, name );
+	if ( size )
+	{
+		strcat ( full_name, "_" );
+		itoa ( full_name + strlen ( full_name ), 'd', size );
+	}
+
+	print ( "B %s %d %d ns\n", full_name, n,
+		mul_div_32 ( us, 1000, n * ops_per_iter ) );
+}
+
+/* null system call -------------------------------------------------------- */
+static void bench_syscall ()
+{
+	int i;
+
+	bench_start ();
+	for ( i = 0; i < N_SYSCALL; i++ )
+		get_errno ();
+	bench_end ( "null_syscall", 0, N_SYSCALL, 1 );
+}
+
+/* thread creation and join ------------------------------------------------ */
+static void empty_thread ( void *param )
+{
+}
+
+static void bench_thread ()
+{
+	thread_t thr;
+	int i;
+
+	bench_start ();
+	for ( i = 0; i < N_THREAD; i++ )
+	{
+		create_thread ( empty_thread, NULL, 0, THR_DEFAULT_PRIO, &thr );
+		wait_for_thread ( &thr, IPC_WAIT );
+	}
+	bench_end ( "thread_create_join", 0, N_THREAD, 1 );
+}
+
+/* semaphore ping-pong (result per post-wait handoff) ---------------------- */
+static sem_t sem_ping, sem_pong;
+
+static void sem_peer ( void *param )
+{
+	int i;
+
+	for ( i = 0; i < N_SEM; i++ )
+	{
+		sem_wait ( &sem_ping );
+		sem_post ( &sem_pong );
+	}
+}
+
+static void bench_sem ()
+{
+	thread_t thr;
+	int i;
+
+	sem_init ( &sem_ping, 0, 0 );
+	sem_init ( &sem_pong, 0, 0 );
+	create_thread ( sem_peer, NULL, 0, THR_DEFAULT_PRIO, &thr );
+
+	bench_start ();
+	for ( i = 0; i < N_SEM; i++ )
+	{
+		sem_post ( &sem_ping );
+		sem_wait ( &sem_pong );
+	}
+	bench_end ( "sem_pingpong", 0, N_SEM, 2 );
+
+	wait_for_thread ( &thr, IPC_WAIT );
+	sem_destroy ( &sem_ping );
+	sem_destroy ( &sem_pong );
+}
+
+/* uncontended monitor lock + unlock --------------------------------------- */
+static void bench_monitor ()
+{
+	monitor_t monitor;
+	int i;
+
+	monitor_init ( &monitor, 0 );
+
+	bench_start ();
+	for ( i = 0; i < N_MONITOR; i++ )
+	{
+		monitor_lock ( &monitor );
+		monitor_unlock ( &monitor );
+	}
+	bench_end ( "monitor_lock_unlock", 0, N_MONITOR, 1 );
+
+	monitor_destroy ( &monitor );
+}
+
+/* monitor signal/wait handoff between two threads ------------------------- */
+static monitor_t handoff_mon;
+static monitor_q handoff_q;
+static int turn;
+
+static void handoff ( int me )
+{
+	int i;
+
+	for ( i = 0; i < N_HANDOFF; i++ )
+	{
+		monitor_lock ( &handoff_mon );
+		while ( turn != me )
+			monitor_wait ( &handoff_mon, &handoff_q );
+		turn = 1 - me;
+		monitor_signal ( &handoff_q );
+		monitor_unlock ( &handoff_mon );
+	}
+}
+
+static void handoff_peer ( void *param )
+{
+	handoff ( 1 );
+}
+
+static void bench_handoff ()
+{
+	thread_t thr;
+
+	monitor_init ( &handoff_mon, 0 );
+	monitor_queue_init ( &handoff_q, 0 );
+	turn = 0;
+
+	create_thread ( handoff_peer, NULL, 0, THR_DEFAULT_PRIO, &thr );
+
+	bench_start ();
+	handoff ( 0 );
+	wait_for_thread ( &thr, IPC_WAIT );
+	bench_end ( "monitor_handoff", 0, N_HANDOFF, 2 );
+
+	monitor_queue_destroy ( &handoff_q );
+	monitor_destroy ( &handoff_mon );
+}
+
+/* message ping-pong for few message sizes (result per one way) ------------ */
+static uint8 msg_buf[sizeof (msg_t) + MSG_MAX];
+static uint8 echo_buf[sizeof (msg_t) + MSG_MAX];
+
+static void msg_echo ( void *param )
+{
+	msg_t *msg = (msg_t *) echo_buf;
+	thread_t self;
+	int i;
+
+	thread_self ( &self );
+
+	for ( i = 0; i < N_MSG; i++ )
+	{
+		receive_message ( MSG_THREAD, &self, msg, 0, MSG_MAX,
+				  IPC_WAIT );
+		send_message ( MSG_THREAD, param, msg, 0 );
+	}
+}
+
+static void bench_msg ()
+{
+	int sizes[] = { 4, 64, 1024 }, s, i;
+	msg_t *msg = (msg_t *) msg_buf;
+	thread_t self, thr;
+
+	thread_self ( &self );
+
+	for ( s = 0; s < sizeof (sizes) / sizeof (int); s++ )
+	{
+		msg->type = 1;
+		msg->size = sizes[s];
+		memset ( msg->data, 0, sizes[s] );
+
+		create_thread ( msg_echo, &self, 0, THR_DEFAULT_PRIO, &thr );
+
+		bench_start ();
+		for ( i = 0; i < N_MSG; i++ )
+		{
+			send_message ( MSG_THREAD, &thr, msg, 0 );
+			receive_message ( MSG_THREAD, &self, msg, 0, MSG_MAX,
+					  IPC_WAIT );
+		}
+		bench_end ( "msg_pingpong", sizes[s], N_MSG, 2 );
+
+		wait_for_thread ( &thr, IPC_WAIT );
+	}
+}
+
+/* alarm set + remove (alarm never expires) -------------------------------- */
+static void bench_alarm ()
+{
+	time_t t;
+	void *alarm;
+	int i;
+
+	bench_start ();
+	for ( i = 0; i < N_ALARM; i++ )
+	{
+		time_get ( &t );
+		t.sec += 1000;
+		alarm = alarm_set ( NULL, &t, NULL, NULL, NULL, 0 );
+		alarm_remove ( alarm );
+	}
+	bench_end ( "alarm_set_remove", 0, N_ALARM, 1 );
+}
+
+/* start program (this one, which exits immediately) and wait for it ------- */
+static void bench_program ()
+{
+	char *child_args[] = { "lmbench", "child", NULL };
+	thread_t thr;
+	int i;
+
+	bench_start ();
+	for ( i = 0; i < N_PROGRAM; i++ )
+	{
+		if ( start_program ( "lmbench", &thr, child_args, 0,
+				     THR_DEFAULT_PRIO ) )
+		{
+			print ( "# program: can not start 'lmbench'\n" );
+			return;
+		}
+		wait_for_thread ( &thr, IPC_WAIT );
+	}
+	bench_end ( "program_start", 0, N_PROGRAM, 1 );
+}
+
+/* device output throughput, in format used for stdout ---------------------- */
+static struct {
+	int attr;
+	char text[DEV_MAX + 1];
+}
+dev_buf;
+
+static void bench_device ()
+{
+	int sizes[] = { 16, 128, DEV_MAX }, s, i;
+	time_t end;
+	void *dev;
+	uint us;
+
+	if ( syscall ( DEVICE_OPEN, BENCH_DEVICE, &dev ) )
+	{
+		print ( "# device: can not open '%s'\n", BENCH_DEVICE );
+		return;
+	}
+
+	dev_buf.attr = USER_FONT;
+	memset ( dev_buf.text, '.', DEV_MAX );
+
+	for ( s = 0; s < sizeof (sizes) / sizeof (int); s++ )
+	{
+		dev_buf.text[sizes[s]] = 0;
+
+		bench_start ();
+		for ( i = 0; i < N_DEVICE; i++ )
+			syscall ( DEVICE_SEND, &dev_buf, sizes[s] + 1,
+				  PRINTSTRING, dev );
+		bench_end ( "device_send", sizes[s], N_DEVICE, 1 );
+
+		/* throughput (bytes per millisecond = kB/s) */
+		time_get ( &end );
+		time_sub ( &end, &start );
+		us = end.sec * 1000000 + end.nsec / 1000;
+		print ( "B device_send_rate_%d %d %d kB/s\n", sizes[s],
+			N_DEVICE, us ? mul_div_32 ( sizes[s] * N_DEVICE, 1000,
+						    us ) : 0 );
+
+		dev_buf.text[sizes[s]] = '.';
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+static struct {
+	char *name;
+	void (*func) ();
+}
+bench[] = {
+	{ "syscall",	bench_syscall },
+	{ "thread",	bench_thread },
+	{ "sem",	bench_sem },
+	{ "monitor",	bench_monitor },
+	{ "handoff",	bench_handoff },
+	{ "msg",	bench_msg },
+	{ "alarm",	bench_alarm },
+	{ "program",	bench_program },
+	{ "device",	bench_device },
+	{ NULL,		NULL }
+};
+
+int lmbench ( char *args[] )
+{
+	int i, j;
+
+	/* started by bench_program */
+	if ( args && args[1] && !strcmp ( args[1], "child" ) )
+		return 0;
+
+	print ( "# lmbench: B <name> <iterations> <result> <unit>\n" );
+
+	for ( i = 0; bench[i].name; i++ )
+	{
+		if ( args && args[1] )
+		{
+			for ( j = 1; args[j]; j++ )
+				if ( !strcmp ( args[j], bench[i].name ) )
+					break;
+			if ( !args[j] )
+				continue;
+		}
+
+		bench[i].func ();
+	}
+
+	print ( "# lmbench: done\n" );
+
+	return 0;
+}
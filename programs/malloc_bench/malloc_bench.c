@@ -0,0 +1,145 @@
+/*! Memory allocation benchmark: thread safe malloc (with per-thread caches)
+ *  versus heap protected with monitor, with multiple threads */
+
+#include <api/stdio.h>
+#include <api/thread.h>
+#include <api/time.h>
+#include <api/monitor.h>
+#include <api/malloc.h>
+#include <lib/types.h>
+
+char PROG_HELP[] = "Compare cached malloc with monitor protected heap.";
+
+#define MAX_THREADS_BENCH	4
+#define ITERATIONS		20000
+#define SLOTS			32	/* objects held by each thread */
+#define MAX_OBJ_SIZE		256
+
+enum { B_MALLOC = 0, B_MONITOR, B_NUM };
+
+static char *bench_name[B_NUM] = { "malloc", "monitor" };
+
+static monitor_t monitor;
+
+static volatile int errors;
+
+static void *bench_alloc ( int type, size_t size )
+{
+	void *ptr;
+
+	if ( type == B_MALLOC )
+		return malloc ( size );
+
+	monitor_lock ( &monitor );
+	ptr = mem_alloc ( size );
+	monitor_unlock ( &monitor );
+
+	return ptr;
+}
+
+static void bench_free ( int type, void *ptr )
+{
+	if ( type == B_MALLOC )
+	{
+		free ( ptr );
+		return;
+	}
+
+	monitor_lock ( &monitor );
+	mem_free ( ptr );
+	monitor_unlock ( &monitor );
+}
+
+/* each thread allocates and releases objects of random sizes; object content
+   is checked before release (detects corruption by other threads) */
+static void bench_thread ( void *param )
+{
+	int i, j, type = (int) param;
+	struct {
+		unsigned char *ptr;
+		size_t size;
+	} obj[SLOTS];
+	unsigned int seed = (unsigned int) obj;
+
+	for ( i = 0; i < SLOTS; i++ )
+		obj[i].ptr = NULL;
+
+	for ( i = 0; i < ITERATIONS + SLOTS; i++ )
+	{
+		j = i % SLOTS;
+
+		if ( obj[j].ptr )
+		{
+			if ( obj[j].ptr[0] != (unsigned char) j ||
+			     obj[j].ptr[obj[j].size - 1] != (unsigned char) j )
+				errors++;
+
+			bench_free ( type, obj[j].ptr );
+			obj[j].ptr = NULL;
+		}
+
+		if ( i >= ITERATIONS )
+			continue;
+
+		seed = seed * 1103515245 + 12345;
+		obj[j].size = ( seed >> 16 ) % MAX_OBJ_SIZE + 1;
+
+		obj[j].ptr = bench_alloc ( type, obj[j].size );
+		if ( !obj[j].ptr )
+		{
+			errors++;
+			continue;
+		}
+		obj[j].ptr[0] = obj[j].ptr[obj[j].size - 1] = (unsigned char) j;
+	}
+}
+
+/* run 'thr_num' threads (round robin); return duration in microseconds */
+static int run_bench ( int type, int thr_num )
+{
+	thread_t thread[MAX_THREADS_BENCH];
+	time_t start, end;
+	int i;
+
+	time_get ( &start );
+
+	for ( i = 0; i < thr_num; i++ )
+		create_thread ( bench_thread, (void *) type, SCHED_RR,
+				THR_DEFAULT_PRIO - 1, &thread[i] );
+	for ( i = 0; i < thr_num; i++ )
+		wait_for_thread ( &thread[i], IPC_WAIT );
+
+	time_get ( &end );
+	time_sub ( &end, &start );
+
+	return end.sec * 1000000 + end.nsec / 1000;
+}
+
+int malloc_bench ( char *args[] )
+{
+	int type, thr_num, us;
+
+	monitor_init ( &monitor, THRQ_FIFO );
+
+	print ( "Memory allocation benchmark (%d alloc+free per thread)\n",
+		ITERATIONS );
+	print ( "allocator threads time[us] ns/op\n" );
+
+	for ( thr_num = 1; thr_num <= MAX_THREADS_BENCH; thr_num++ )
+	{
+		for ( type = 0; type < B_NUM; type++ )
+		{
+			errors = 0;
+			us = run_bench ( type, thr_num );
+			print ( "%s %d %d %d\n", bench_name[type], thr_num, us,
+				us / ( thr_num * ITERATIONS / 1000 ) );
+			if ( errors )
+				print ( "ERROR: %s: %d failed checks\n",
+					bench_name[type], errors );
+		}
+	}
+
+	monitor_destroy ( &monitor );
+
+	return 0;
+}
@@ -72,13 +72,13 @@ int monitors ( char *args[] )
 
 	terminate_simulation = 0;
 
-	monitor_init ( &m );
+	monitor_init ( &m, THRQ_FIFO );
 
 	for ( i = 0; i < PHNUM; i++ )
 	{
 		stick[i] = 0;
 		phs[i] = 'O';
-		monitor_queue_init ( &q[i] );
+		monitor_queue_init ( &q[i], THRQ_FIFO );
 	}
 
 	for ( i = 0; i < PHNUM; i++ )
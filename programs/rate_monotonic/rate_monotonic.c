@@ -0,0 +1,84 @@
+/*! Rate monotonic scheduling example: periodic threads without alarms */
+
+#include <api/stdio.h>
+#include <api/thread.h>
+#include <api/time.h>
+#include <arch/processor.h>
+#include <lib/types.h>
+
+char PROG_HELP[] = "Rate monotonic scheduler example: periodic threads get "
+		   "priorities by their periods; last one is not admitted.";
+
+#define THR_NUM	4
+#define TEST_DURATION	10 /* seconds */
+#define INNER_LOOP_COUNT 100000
+
+/* period, wcet [ms] (last one exceeds available processor time) */
+static int period[THR_NUM] = { 100, 200, 500, 300 };
+static int wcet[THR_NUM] = { 20, 40, 100, 150 };
+static int jobs[THR_NUM], missed[THR_NUM];
+
+static void rm_thread ( void *param )
+{
+	int thr_no = (int) param, j;
+	thread_t self;
+	time_t t, c;
+	int prio;
+
+	t.sec = period[thr_no] / 1000;
+	t.nsec = ( period[thr_no] % 1000 ) * 1000000;
+	c.sec = wcet[thr_no] / 1000;
+	c.nsec = ( wcet[thr_no] % 1000 ) * 1000000;
+
+	if ( rm_set ( t, t, c ) )
+	{
+		print ( "Thread %d (T=%d ms, C=%d ms) not admitted\n",
+			thr_no, period[thr_no], wcet[thr_no] );
+		return;
+	}
+
+	thread_self ( &self );
+	get_thread_sched_params ( &self, NULL, &prio, NULL );
+	print ( "Thread %d (T=%d ms, C=%d ms) admitted, priority %d\n",
+		thr_no, period[thr_no], wcet[thr_no], prio );
+
+	for ( ; ; )
+	{
+		/* short job, much shorter than declared wcet */
+		for ( j = 0; j < INNER_LOOP_COUNT; j++ )
+			memory_barrier ();
+
+		jobs[thr_no]++;
+		if ( rm_wait () )
+			missed[thr_no]++;
+	}
+}
+
+int rate_monotonic ( char *args[] )
+{
+	thread_t thread[THR_NUM];
+	time_t sleep;
+	int i;
+
+	for ( i = 0; i < THR_NUM; i++ )
+	{
+		jobs[i] = missed[i] = 0;
+		create_thread ( rm_thread, (void *) i, SCHED_RM,
+				THR_DEFAULT_PRIO - 1, &thread[i] );
+	}
+
+	print ( "Threads created, giving them %d seconds\n", TEST_DURATION );
+	sleep.sec = TEST_DURATION;
+	sleep.nsec = 0;
+	delay ( &sleep );
+
+	for ( i = 0; i < THR_NUM; i++ )
+		cancel_thread ( &thread[i] );
+	for ( i = 0; i < THR_NUM; i++ )
+		wait_for_thread ( &thread[i], IPC_WAIT );
+	for ( i = 0; i < THR_NUM; i++ )
+		print ( "Thread %d, period=%d ms, jobs=%d, missed=%d\n",
+			i, period[i], jobs[i], missed[i] );
+
+	return 0;
+}
@@ -13,6 +13,7 @@ char PROG_HELP[] = "Thread demonstration example: create several threads that "
 #define TEST_DURATION	10 /* seconds */
 
 static int iters[THR_NUM];
+static int quantum[THR_NUM] = { 20, 40, 60 }; /* ms */
 
 /* example threads */
 static void rr_thread ( void *param )
@@ -35,6 +36,7 @@ static void rr_thread ( void *param )
 int round_robin ( char *args[] )
 {
 	thread_t thread[THR_NUM];
+	sched_t param;
 	int i;
 	time_t sleep;
 
@@ -43,6 +45,11 @@ int round_robin ( char *args[] )
 		iters[i] = 0;
 		create_thread ( rr_thread, (void *) i,
 				SCHED_RR, THR_DEFAULT_PRIO - 1, &thread[i] );
+
+		/* each thread with its own quantum */
+		param.rr.time_slice.sec = 0;
+		param.rr.time_slice.nsec = quantum[i] * 1000000;
+		set_thread_sched_params ( &thread[i], SCHED_RR, 0, &param );
 	}
 
 	print ( "Threads created, giving them %d seconds\n", TEST_DURATION );
@@ -56,7 +63,8 @@ int round_robin ( char *args[] )
 	for ( i = 0; i < THR_NUM; i++ )
 		wait_for_thread ( &thread[i], IPC_WAIT );
 	for ( i = 0; i < THR_NUM; i++ )
-		print ( "Thread %d, count=%d\n", i, iters[i] );
+		print ( "Thread %d, quantum=%d ms, count=%d\n",
+			i, quantum[i], iters[i] );
 
 	return 0;
 }
@@ -0,0 +1,148 @@
+/*! Reader scaling benchmark: shared table protected with reader-writer lock
+ *  versus same table protected with monitor */
+
+#include <api/stdio.h>
+#include <api/thread.h>
+#include <api/time.h>
+#include <api/monitor.h>
+#include <api/rwlock.h>
+#include <api/barrier.h>
+#include <lib/types.h>
+
+char PROG_HELP[] = "Compare reader scaling of rwlock and monitor.";
+
+#define MAX_READERS	4
+#define ITERATIONS	5000
+#define TABLE_SIZE	64
+#define WRITE_EVERY	100	/* first reader updates table every N reads */
+
+enum { B_MONITOR = 0, B_RWLOCK, B_NUM };
+
+static char *bench_name[B_NUM] = { "monitor", "rwlock" };
+
+static monitor_t monitor;
+static rwlock_t rwlock;
+static barrier_t start_barrier;
+
+static volatile int table[TABLE_SIZE];
+
+/* read whole table (simulate lookup) */
+static int table_read ()
+{
+	int i, sum = 0;
+
+	for ( i = 0; i < TABLE_SIZE; i++ )
+		sum += table[i];
+
+	return sum;
+}
+
+/* update whole table (values remain equal, so sum is constant) */
+static void table_write ( int val )
+{
+	int i;
+
+	for ( i = 0; i < TABLE_SIZE; i++ )
+		table[i] = val;
+}
+
+static void reader ( void *param )
+{
+	int i, type, thr_no, sum;
+
+	type = ( (int) param ) & 0xff;
+	thr_no = ( (int) param ) >> 8;
+
+	barrier_wait ( &start_barrier );
+
+	for ( i = 1; i <= ITERATIONS; i++ )
+	{
+		if ( thr_no == 0 && i % WRITE_EVERY == 0 )
+		{
+			if ( type == B_MONITOR )
+				monitor_lock ( &monitor );
+			else
+				rwlock_wrlock ( &rwlock );
+
+			table_write ( i );
+
+			if ( type == B_MONITOR )
+				monitor_unlock ( &monitor );
+			else
+				rwlock_unlock ( &rwlock );
+
+			continue;
+		}
+
+		if ( type == B_MONITOR )
+			monitor_lock ( &monitor );
+		else
+			rwlock_rdlock ( &rwlock );
+
+		sum = table_read ();
+
+		if ( type == B_MONITOR )
+			monitor_unlock ( &monitor );
+		else
+			rwlock_unlock ( &rwlock );
+
+		if ( sum % TABLE_SIZE )
+			print ( "ERROR: %s: inconsistent table read (%d)\n",
+				bench_name[type], sum );
+	}
+}
+
+/* run 'thr_num' readers (round robin); return duration in microseconds */
+static int run_bench ( int type, int thr_num )
+{
+	thread_t thread[MAX_READERS];
+	time_t start, end;
+	int i;
+
+	table_write ( 0 );
+	barrier_init ( &start_barrier, thr_num + 1 );
+
+	for ( i = 0; i < thr_num; i++ )
+		create_thread ( reader, (void *) ( type | ( i << 8 ) ), SCHED_RR,
+				THR_DEFAULT_PRIO - 1, &thread[i] );
+
+	time_get ( &start );
+	barrier_wait ( &start_barrier );
+
+	for ( i = 0; i < thr_num; i++ )
+		wait_for_thread ( &thread[i], IPC_WAIT );
+
+	time_get ( &end );
+	time_sub ( &end, &start );
+
+	barrier_destroy ( &start_barrier );
+
+	return end.sec * 1000000 + end.nsec / 1000;
+}
+
+int rwlock_bench ( char *args[] )
+{
+	int type, thr_num, us;
+
+	monitor_init ( &monitor, THRQ_FIFO );
+	rwlock_init ( &rwlock, THRQ_PRIO );
+
+	print ( "Reader scaling benchmark (%d iterations per thread, "
+		"write every %d)\n", ITERATIONS, WRITE_EVERY );
+	print ( "lock readers time[us] reads/ms\n" );
+
+	for ( thr_num = 1; thr_num <= MAX_READERS; thr_num++ )
+	{
+		for ( type = 0; type < B_NUM; type++ )
+		{
+			us = run_bench ( type, thr_num );
+			print ( "%s %d %d %d\n", bench_name[type], thr_num, us,
+				us ? thr_num * ITERATIONS * 1000 / us : 0 );
+		}
+	}
+
+	monitor_destroy ( &monitor );
+	rwlock_destroy ( &rwlock );
+
+	return 0;
+}
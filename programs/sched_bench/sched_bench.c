@@ -0,0 +1,207 @@
+/*! Scheduler benchmark
+ *
+ * ring:  token is passed around a ring of threads (each pass is one context
+ *	  switch); only one thread is ready at a time, but with many threads
+ *	  descriptors no longer fit in processor cache, so their layout affects
+ *	  switch time
+ * ready: N threads are ready at the same time, spread over several priority
+ *	  levels; threads on highest level yield to each other (each yield is
+ *	  one switch), others only populate ready list
+ *
+ * Usage: sched_bench [ring] [ready] (both if none given)
+ */
+
+#include <api/stdio.h>
+#include <api/thread.h>
+#include <api/time.h>
+#include <api/semaphore.h>
+#include <lib/types.h>
+#include <lib/string.h>
+
+char PROG_HELP[] = "Measure context switch time over large sets of threads.";
+
+#define MAX_RING	200
+#define PASSES		20000	/* total number of token passes per test */
+
+#define MAX_READY	200
+#define YIELDS		20000	/* total number of yields per test */
+#define CTRL_PRIO	( THR_DEFAULT_PRIO + 10 )
+
+static sem_t sem[MAX_RING];
+static int ring_size;
+static volatile int passes;
+
+/* wait for token, pass it to next thread in ring */
+static void ring_thread ( void *param )
+{
+	int i = (int) param;
+
+	while (1)
+	{
+		sem_wait ( &sem[i] );
+
+		if ( passes >= PASSES )
+			break;
+
+		passes++;
+		sem_post ( &sem[ ( i + 1 ) % ring_size ] );
+	}
+
+	/* test over: release next thread so it can also exit */
+	sem_post ( &sem[ ( i + 1 ) % ring_size ] );
+}
+
+/* return average time for single pass (context switch) in nanoseconds */
+static int run_ring ( int size )
+{
+	thread_t thread[MAX_RING];
+	time_t start, end;
+	int i;
+
+	ring_size = size;
+	passes = 0;
+
+	for ( i = 0; i < size; i++ )
+		sem_init ( &sem[i], 0, THRQ_FIFO );
+
+	/* all threads are created and then blocked on their semaphores */
+	for ( i = 0; i < size; i++ )
+		create_thread ( ring_thread, (void *) i, 0, THR_DEFAULT_PRIO + 1,
+				&thread[i] );
+
+	time_get ( &start );
+
+	sem_post ( &sem[0] );
+
+	for ( i = 0; i < size; i++ )
+		wait_for_thread ( &thread[i], IPC_WAIT );
+
+	time_get ( &end );
+	time_sub ( &end, &start );
+
+	for ( i = 0; i < size; i++ )
+		sem_destroy ( &sem[i] );
+
+	return ( end.sec * 1000000 + end.nsec / 1000 ) / ( PASSES / 1000 );
+}
+
+/* yield until own share of YIELDS is done */
+static void yield_thread ( void *param )
+{
+	int i, n = (int) param;
+
+	for ( i = 0; i < n; i++ )
+		thread_yield ();
+}
+
+/* only populate ready list (never runs: cancelled when test is over) */
+static void filler_thread ( void *param )
+{
+	while (1)
+		thread_yield ();
+}
+
+/*
+ * Create 'size' ready threads on 'levels' priority levels below control
+ * thread: 2 (or size / levels) threads on highest level yield, others fill
+ * lower levels; return average time for single yield in nanoseconds
+ */
+static int run_ready ( int size, int levels )
+{
+	thread_t thread[MAX_READY];
+	time_t start, end;
+	int i, yielders, prio;
+
+	yielders = size / levels;
+	if ( yielders < 2 )
+		yielders = 2;
+
+	/* control thread has highest priority: all created threads stay ready
+	   until it blocks (waiting for yielders) */
+	for ( i = 0; i < size; i++ )
+	{
+		if ( i < yielders )
+		{
+			prio = THR_DEFAULT_PRIO + levels;
+			create_thread ( yield_thread, (void *) ( YIELDS / yielders ),
+					0, prio, &thread[i] );
+		}
+		else {
+			prio = THR_DEFAULT_PRIO + 1 + i % ( levels - 1 );
+			create_thread ( filler_thread, NULL, 0, prio, &thread[i] );
+		}
+	}
+
+	time_get ( &start );
+
+	for ( i = 0; i < yielders; i++ )
+		wait_for_thread ( &thread[i], IPC_WAIT );
+
+	time_get ( &end );
+	time_sub ( &end, &start );
+
+	for ( ; i < size; i++ )
+		cancel_thread ( &thread[i] );
+
+	return ( end.sec * 1000000 + end.nsec / 1000 ) /
+		( yielders * ( YIELDS / yielders ) / 1000 );
+}
+
+static int ready_sizes[] = { 2, 8, 32, 64, 128, MAX_READY, 0 };
+static int ready_levels[] = { 1, 4, 8, 0 }; /* below CTRL_PRIO */
+
+/* ready test is run from control thread with priority above all others */
+static void ready_control ( void *param )
+{
+	int i, j;
+
+	print ( "Yield benchmark (%d yields per test)\n", YIELDS );
+	print ( "ready_<threads>_<levels> ns/switch\n" );
+
+	for ( j = 0; ready_levels[j]; j++ )
+		for ( i = 0; ready_sizes[i]; i++ )
+			if ( ready_sizes[i] >= ready_levels[j] )
+				print ( "ready_%d_%d %d\n", ready_sizes[i],
+					ready_levels[j],
+					run_ready ( ready_sizes[i],
+						    ready_levels[j] ) );
+}
+
+static int selected ( char *args[], char *name )
+{
+	int i;
+
+	if ( !args || !args[1] )
+		return 1;
+
+	for ( i = 1; args[i]; i++ )
+		if ( !strcmp ( args[i], name ) )
+			return 1;
+
+	return 0;
+}
+
+int sched_bench ( char *args[] )
+{
+	int sizes[] = { 2, 8, 32, 64, 128, MAX_RING, 0 };
+	thread_t control;
+	int i;
+
+	if ( selected ( args, "ring" ) )
+	{
+		print ( "Context switch benchmark (%d passes per ring)\n",
+			PASSES );
+		print ( "threads ns/switch\n" );
+
+		for ( i = 0; sizes[i]; i++ )
+			print ( "%d %d\n", sizes[i], run_ring ( sizes[i] ) );
+	}
+
+	if ( selected ( args, "ready" ) )
+	{
+		create_thread ( ready_control, NULL, 0, CTRL_PRIO, &control );
+		wait_for_thread ( &control, IPC_WAIT );
+	}
+
+	return 0;
+}
@@ -101,10 +101,10 @@ int semaphores ( char *args[] )
 	sleep.sec = 1;
 	sleep.nsec = 0;
 
-	sem_init ( &filled, 0 );
-	sem_init ( &empty, BUFF_SIZE );
-	sem_init ( &crit1, 1 );
-	sem_init ( &crit2, 1 );
+	sem_init ( &filled, 0, THRQ_FIFO );
+	sem_init ( &empty, BUFF_SIZE, THRQ_FIFO );
+	sem_init ( &crit1, 1, THRQ_FIFO );
+	sem_init ( &crit2, 1, THRQ_FIFO );
 	in = out = 0;
 	end_msgs = 0;
 
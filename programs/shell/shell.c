@@ -21,6 +21,7 @@ cmd_t;
 #define MAXARGS		10
 #define PROG_LIST_SIZE	1000
 #define INFO_SIZE	1000
+#define PS_SIZE		32
 
 static char s_stdout[MAXCMDLEN];
 static char s_stdin[MAXCMDLEN];
@@ -28,6 +29,7 @@ static char s_stdin[MAXCMDLEN];
 static int help ();
 static int clear ();
 static int sysinfo ( char *args[] );
+static int ps ( char *args[] );
 static int set ( char *args[] );
 
 static cmd_t sh_cmd[] =
@@ -35,6 +37,8 @@ static cmd_t sh_cmd[] =
 	{ help, "help", "help - list available commands" },
 	{ clear, "clear", "clear - clear screen" },
 	{ sysinfo, "sysinfo", "system information; usage: sysinfo [options]" },
+	{ ps, "ps", "processor usage per thread (or process with -p); "
+		"usage: ps [-p]" },
 	{ set, "set", "change shell settings; "
 		"usage: set stdin|stdout [device]" },
 	{ NULL, "" }
@@ -182,6 +186,33 @@ static int sysinfo ( char *args[] )
 	return 0;
 }
 
+/* time in milliseconds */
+#define MS(T)	( (T).sec * 1000 + (T).nsec / 1000000 )
+
+static int ps ( char *args[] )
+{
+	static thread_stats_t st[PS_SIZE];
+	int i, n, flags = STATS_THREADS;
+
+	if ( args[1] && !strcmp ( args[1], "-p" ) )
+		flags = STATS_PROCESSES;
+
+	n = thread_stats ( flags, st, PS_SIZE );
+
+	print ( "%s\tprog\tprio\tstate\tsched\trun[ms]\tready\twait\t"
+		"vol\tinvol\n", flags == STATS_THREADS ? "id" : "threads" );
+
+	for ( i = 0; i < n; i++ )
+		print ( "%d\t%s\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n",
+			flags == STATS_THREADS ? st[i].id : st[i].threads,
+			st[i].name, st[i].prio, st[i].state,
+			st[i].sched_policy, MS ( st[i].run_time ),
+			MS ( st[i].ready_time ), MS ( st[i].wait_time ),
+			st[i].vol_switches, st[i].invol_switches );
+
+	return 0;
+}
+
 static int set ( char *args[] )
 {
 	if ( args[1] == NULL ||
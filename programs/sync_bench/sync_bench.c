@@ -0,0 +1,116 @@
+/*! Synchronization benchmark: kernel objects (monitor, semaphore) versus
+ *  futex based ones (fmutex, fsem), without and with contention */
+
+#include <api/stdio.h>
+#include <api/thread.h>
+#include <api/time.h>
+#include <api/monitor.h>
+#include <api/semaphore.h>
+#include <api/futex.h>
+#include <lib/types.h>
+
+char PROG_HELP[] = "Compare kernel and futex based mutex/semaphore costs.";
+
+#define MAX_THREADS_BENCH	4
+#define ITERATIONS		20000
+
+enum { B_MONITOR = 0, B_FMUTEX, B_SEM, B_FSEM, B_NUM };
+
+static char *bench_name[B_NUM] = { "monitor", "fmutex", "sem", "fsem" };
+
+static monitor_t monitor;
+static fmutex_t fmutex;
+static sem_t sem;
+static fsem_t fsem;
+
+static volatile int counter;
+
+/* each thread increments shared counter in critical section */
+static void bench_thread ( void *param )
+{
+	int i, type = (int) param;
+
+	for ( i = 0; i < ITERATIONS; i++ )
+	{
+		switch ( type )
+		{
+		case B_MONITOR:
+			monitor_lock ( &monitor );
+			counter++;
+			monitor_unlock ( &monitor );
+			break;
+		case B_FMUTEX:
+			fmutex_lock ( &fmutex );
+			counter++;
+			fmutex_unlock ( &fmutex );
+			break;
+		case B_SEM:
+			sem_wait ( &sem );
+			counter++;
+			sem_post ( &sem );
+			break;
+		case B_FSEM:
+			fsem_wait ( &fsem );
+			counter++;
+			fsem_post ( &fsem );
+			break;
+		}
+	}
+}
+
+/* run 'thr_num' threads (round robin, so they are interrupted inside critical
+   section); return duration in microseconds */
+static int run_bench ( int type, int thr_num )
+{
+	thread_t thread[MAX_THREADS_BENCH];
+	time_t start, end;
+	int i;
+
+	counter = 0;
+
+	time_get ( &start );
+
+	for ( i = 0; i < thr_num; i++ )
+		create_thread ( bench_thread, (void *) type, SCHED_RR,
+				THR_DEFAULT_PRIO - 1, &thread[i] );
+	for ( i = 0; i < thr_num; i++ )
+		wait_for_thread ( &thread[i], IPC_WAIT );
+
+	time_get ( &end );
+	time_sub ( &end, &start );
+
+	if ( counter != thr_num * ITERATIONS )
+		print ( "ERROR: %s: counter=%d, expected=%d\n",
+			bench_name[type], counter, thr_num * ITERATIONS );
+
+	return end.sec * 1000000 + end.nsec / 1000;
+}
+
+int sync_bench ( char *args[] )
+{
+	int type, thr_num, us;
+
+	monitor_init ( &monitor, THRQ_FIFO );
+	sem_init ( &sem, 1, THRQ_FIFO );
+	fmutex_init ( &fmutex );
+	fsem_init ( &fsem, 1 );
+
+	print ( "Synchronization benchmark (%d iterations per thread)\n",
+		ITERATIONS );
+	print ( "object threads time[us] ns/op\n" );
+
+	for ( thr_num = 1; thr_num <= MAX_THREADS_BENCH; thr_num++ )
+	{
+		for ( type = 0; type < B_NUM; type++ )
+		{
+			us = run_bench ( type, thr_num );
+			print ( "%s %d %d %d\n", bench_name[type], thr_num, us,
+				us / ( thr_num * ITERATIONS / 1000 ) );
+		}
+	}
+
+	monitor_destroy ( &monitor );
+	sem_destroy ( &sem );
+
+	return 0;
+}